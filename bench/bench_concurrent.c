@@ -0,0 +1,300 @@
+/**
+ * @file bench_concurrent.c
+ *
+ * @brief Throughput of stacks shared between threads, as the thread count grows.
+ *
+ * Every thread runs the same loop of push/pop pairs against one shared stack, for
+ * 1, 2, 4, ... up to the requested number of threads. Each backend is checked
+ * afterwards: the values popped plus the values left on the stack must add up to
+ * the values pushed, so a lost or duplicated element fails the run.
+ *
+ * Build: cc -O2 -pthread -I. bench/bench_concurrent.c stack.c stack_lockfree.c
+ * Usage: bench_concurrent [max threads (64)] [push/pop pairs per thread (1000000)]
+ *                         [elimination width (8)] [elimination spins (128)]
+ *
+ * Prints one CSV row per backend and thread count.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "stack.h"
+#include "stack_lockfree.h"
+
+/**
+ * @struct backend
+ * @brief A shared stack under test, seen through push/pop callbacks.
+ */
+typedef struct backend
+{
+    const char *name;                        /**< Name printed in the report */
+    void *(*create)(void);                   /**< Creates an empty shared stack */
+    void (*destroy)(void *stack);            /**< Frees the stack */
+    StackStatus (*push)(void *stack, int data);
+    StackStatus (*tryPop)(void *stack, int *out);
+} Backend;
+
+/**
+ * @brief Ends the run with a message when setting up a benchmark fails.
+ * @param what What could not be done.
+ */
+static void fail(const char *what)
+{
+    fprintf(stderr, "bench_concurrent: %s\n", what);
+    exit(1);
+}
+
+/* ---------------------------------------------------------------------------
+ * Mutex-wrapped linked-list stack
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct mutexStack
+ * @brief The linked-list stack with every operation under one mutex.
+ * @details All threads share one node pool, which the mutex protects as well.
+ */
+typedef struct mutexStack
+{
+    pthread_mutex_t lock; /**< Serializes every push and pop */
+    NodePool pool;        /**< Pool shared by all threads */
+    Node *top;            /**< Top of the stack */
+} MutexStack;
+
+static void *mutexCreate(void)
+{
+    MutexStack *stack = malloc(sizeof(MutexStack));
+    if (stack == NULL || pthread_mutex_init(&stack->lock, NULL) != 0)
+    {
+        fail("cannot create the mutex stack");
+    }
+    initNodePool(&stack->pool);
+    stack->top = NULL;
+    return stack;
+}
+
+static void mutexDestroy(void *stack)
+{
+    MutexStack *s = stack;
+    drainNodePool(&s->pool);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+static StackStatus mutexPush(void *stack, int data)
+{
+    MutexStack *s = stack;
+    pthread_mutex_lock(&s->lock);
+    StackStatus status = listPushPooled(&s->pool, &s->top, data);
+    pthread_mutex_unlock(&s->lock);
+    return status;
+}
+
+static StackStatus mutexTryPop(void *stack, int *out)
+{
+    MutexStack *s = stack;
+    StackStatus status = STACK_EMPTY;
+    pthread_mutex_lock(&s->lock);
+    if (s->top != NULL)
+    {
+        *out = listPopPooled(&s->pool, &s->top);
+        status = STACK_OK;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Lock-free stack
+ * ------------------------------------------------------------------------- */
+
+static void *lockFreeCreate(void)
+{
+    LockFreeStack *stack = aligned_alloc(LOCKFREE_CACHE_LINE, sizeof(LockFreeStack));
+    if (stack == NULL || initLockFreeStack(stack) != STACK_OK)
+    {
+        fail("cannot create the lock-free stack");
+    }
+    return stack;
+}
+
+static void lockFreeDestroy(void *stack)
+{
+    destroyLockFreeStack(stack);
+    free(stack);
+}
+
+static StackStatus lockFreePushCb(void *stack, int data)
+{
+    return lockFreePush(stack, data);
+}
+
+static StackStatus lockFreeTryPopCb(void *stack, int *out)
+{
+    return lockFreeTryPop(stack, out);
+}
+
+/* ---------------------------------------------------------------------------
+ * Elimination-backoff stack
+ * ------------------------------------------------------------------------- */
+
+static unsigned eliminationWidth = ELIMINATION_DEFAULT_WIDTH;
+static unsigned eliminationSpins = ELIMINATION_DEFAULT_SPINS;
+
+static void *eliminationCreate(void)
+{
+    EliminationStack *stack = aligned_alloc(LOCKFREE_CACHE_LINE, sizeof(EliminationStack));
+    if (stack == NULL || initEliminationStack(stack, eliminationWidth, eliminationSpins) != STACK_OK)
+    {
+        fail("cannot create the elimination stack");
+    }
+    return stack;
+}
+
+static void eliminationDestroy(void *stack)
+{
+    destroyEliminationStack(stack);
+    free(stack);
+}
+
+static StackStatus eliminationPushCb(void *stack, int data)
+{
+    return eliminationPush(stack, data);
+}
+
+static StackStatus eliminationTryPopCb(void *stack, int *out)
+{
+    return eliminationTryPop(stack, out);
+}
+
+/* ---------------------------------------------------------------------------
+ * Driver
+ * ------------------------------------------------------------------------- */
+
+static const Backend backends[] = {
+    { "mutex", mutexCreate, mutexDestroy, mutexPush, mutexTryPop },
+    { "lockfree", lockFreeCreate, lockFreeDestroy, lockFreePushCb, lockFreeTryPopCb },
+    { "elimination", eliminationCreate, eliminationDestroy, eliminationPushCb, eliminationTryPopCb },
+};
+
+/**
+ * @struct worker
+ * @brief Arguments and results of one benchmark thread.
+ */
+typedef struct worker
+{
+    const Backend *backend;   /**< Backend under test */
+    void *stack;              /**< Shared stack */
+    long pairs;               /**< Number of push/pop pairs to run */
+    int id;                   /**< Thread number, used to make pushed values distinct */
+    long long pushedSum;      /**< Sum of the values this thread pushed */
+    long long poppedSum;      /**< Sum of the values this thread popped */
+    pthread_barrier_t *start; /**< Released once every thread is ready */
+} Worker;
+
+static void *runWorker(void *arg)
+{
+    Worker *w = arg;
+    int value;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->pairs; i++)
+    {
+        int data = w->id * 1000 + (int)(i % 1000);
+        if (w->backend->push(w->stack, data) == STACK_OK)
+        {
+            w->pushedSum += data;
+        }
+        if (w->backend->tryPop(w->stack, &value) == STACK_OK)
+        {
+            w->poppedSum += value;
+        }
+    }
+    return NULL;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Runs one backend with the given number of threads and prints its CSV row.
+ * @return 0 if the pushed and popped values add up, 1 otherwise.
+ */
+static int runBenchmark(const Backend *backend, int threads, long pairs)
+{
+    void *stack = backend->create();
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    Worker *workers = calloc(threads, sizeof(Worker));
+    pthread_barrier_t start;
+    if (ids == NULL || workers == NULL || pthread_barrier_init(&start, NULL, threads + 1) != 0)
+    {
+        fail("cannot set up the worker threads");
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i] = (Worker){ backend, stack, pairs, i, 0, 0, &start };
+        if (pthread_create(&ids[i], NULL, runWorker, &workers[i]) != 0)
+        {
+            fail("cannot start a worker thread");
+        }
+    }
+    double begin = now(); // Taken before the release: workers may run before this thread resumes
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(ids[i], NULL);
+    }
+    double seconds = now() - begin;
+
+    long long pushed = 0, popped = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        pushed += workers[i].pushedSum;
+        popped += workers[i].poppedSum;
+    }
+    int value;
+    while (backend->tryPop(stack, &value) == STACK_OK)
+    {
+        popped += value;
+    }
+
+    double ops = 2.0 * pairs * threads;
+    printf("%s,%d,%.0f,%.4f,%.2f,%s\n", backend->name, threads, ops, seconds,
+           ops / seconds / 1e6, pushed == popped ? "ok" : "MISMATCH");
+
+    pthread_barrier_destroy(&start);
+    free(workers);
+    free(ids);
+    backend->destroy(stack);
+    return pushed != popped;
+}
+
+int main(int argc, char *argv[])
+{
+    int maxThreads = argc > 1 ? atoi(argv[1]) : 64;
+    long pairs = argc > 2 ? atol(argv[2]) : 1000000;
+    if (argc > 3)
+    {
+        eliminationWidth = (unsigned)atoi(argv[3]);
+    }
+    if (argc > 4)
+    {
+        eliminationSpins = (unsigned)atoi(argv[4]);
+    }
+    int failures = 0;
+
+    printf("backend,threads,ops,seconds,mops_per_sec,check\n");
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++)
+    {
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            failures += runBenchmark(&backends[b], threads, pairs);
+        }
+    }
+    return failures != 0;
+}
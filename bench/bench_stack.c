@@ -0,0 +1,800 @@
+/**
+ * @file bench_stack.c
+ *
+ * @brief Single-threaded cost of each stack backend across workloads and sizes.
+ *
+ * Every backend runs every workload at sizes 10, 100, ... up to the maximum size:
+ *
+ * - push:         push `size` items onto an empty stack.
+ * - pop:          pop `size` items off a full stack.
+ * - push-heavy:   two pushes and one pop, repeated until the stack holds size/2 items.
+ * - pop-heavy:    one push and two pops, repeated until a full stack is down to size/2.
+ * - alternating:  `size` push/pop pairs on top of a stack holding `size` items.
+ * - burst:        four times, push `size` items onto an empty stack and pop them all.
+ * - reverse:      reverse a stack of `size` items four times (backends that support it).
+ *
+ * Only the workload itself is timed; filling the stack beforehand and emptying it
+ * afterwards are not. The timed operations are split into windows of at least 4096
+ * operations, and the percentiles are those of the per-window ns/op, so they show
+ * how steady a backend is (growth, page faults, slab refills) rather than the cost
+ * of a single call. Small stacks are run many at a time and every case is repeated
+ * until it has done the minimum number of operations. All backends are called
+ * through the same function pointers, so the call overhead is common to all.
+ *
+ * Each case runs in a child process, so the peak RSS reported is that case's own.
+ * On Linux the cache and branch misses of the timed part are read from hardware
+ * counters when perf_event_open() is allowed; otherwise they are left empty.
+ *
+ * Build: cc -O2 -I. bench/bench_stack.c stack.c stack_arena.c stack_compressed.c
+ * Usage: bench_stack [-f csv|json] [-b backend,...] [-w workload,...]
+ *                    [-s min size (10)] [-m max size (10000000)] [-o min ops per case (1000000)]
+ *
+ * Pass -m 100000000 for the full range; the linked list then needs a few GiB.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "stack.h"
+#include "stack_arena.h"
+#include "stack_compressed.h"
+
+#define SAMPLE_MIN_OPS 4096      /**< Fewest operations per timed window */
+#define ROUND_MAX_SAMPLES 1024   /**< Most windows per round of a large case */
+#define SMALL_CASE_ELEMENTS 4096 /**< Stacks smaller than this are run several at a time */
+#define TICK_ITERATIONS 256      /**< Loop iterations between two checks of the window */
+#define BURST_CYCLES 4           /**< Fill/drain cycles of the burst workload */
+#define REVERSE_PASSES 4         /**< Reversals of the reverse workload */
+
+/**
+ * @struct backend
+ * @brief A stack under test, seen through push/pop callbacks.
+ */
+typedef struct backend
+{
+    const char *name;                 /**< Name printed in the report */
+    void *(*create)(long size);       /**< Creates an empty stack that will hold at most `size` items */
+    void (*destroy)(void *stack);     /**< Frees the stack and everything on it */
+    StackStatus (*push)(void *stack, int data);
+    StackStatus (*tryPop)(void *stack, int *out);
+    void (*reverse)(void *stack);     /**< Reverses the stack in place, or NULL if unsupported */
+} Backend;
+
+/* ---------------------------------------------------------------------------
+ * Array stack
+ * ------------------------------------------------------------------------- */
+
+static void *arrayCreate(long size)
+{
+    (void)size; // Starts small so the push workloads pay for growth
+    return initializeGrowableStack(16, 2.0, 0);
+}
+
+static void arrayDestroy(void *stack)
+{
+    freeStack(stack);
+}
+
+static StackStatus arrayPush(void *stack, int data)
+{
+    return push(stack, data);
+}
+
+static StackStatus arrayTryPop(void *stack, int *out)
+{
+    return tryPop(stack, out);
+}
+
+static void arrayReverse(void *stack)
+{
+    reverseStack(stack);
+}
+
+/* ---------------------------------------------------------------------------
+ * Linked-list stack
+ * ------------------------------------------------------------------------- */
+
+static void *listCreate(long size)
+{
+    (void)size;
+    return calloc(1, sizeof(Node *));
+}
+
+static void listDestroy(void *stack)
+{
+    int value;
+    while (listTryPop(stack, &value) == STACK_OK)
+    {
+    }
+    free(stack);
+}
+
+static StackStatus listPushCb(void *stack, int data)
+{
+    return listPush(stack, data);
+}
+
+static StackStatus listTryPopCb(void *stack, int *out)
+{
+    return listTryPop(stack, out);
+}
+
+static void listReverseCb(void *stack)
+{
+    listReverse(stack);
+}
+
+/* ---------------------------------------------------------------------------
+ * Unrolled linked-list stack
+ * ------------------------------------------------------------------------- */
+
+static void *unrolledCreate(long size)
+{
+    (void)size;
+    return calloc(1, sizeof(UnrolledStack));
+}
+
+static void unrolledDestroy(void *stack)
+{
+    unrolledClear(stack);
+    free(stack);
+}
+
+static StackStatus unrolledPushCb(void *stack, int data)
+{
+    return unrolledPush(stack, data);
+}
+
+static StackStatus unrolledTryPopCb(void *stack, int *out)
+{
+    return unrolledTryPop(stack, out);
+}
+
+static void unrolledReverseCb(void *stack)
+{
+    unrolledReverse(stack);
+}
+
+/* ---------------------------------------------------------------------------
+ * Arena families: one stack of a twin pair, one stack of a k-stack pool
+ * ------------------------------------------------------------------------- */
+
+static void *twinCreate(long size)
+{
+    return createTwinStack((unsigned)size);
+}
+
+static void arenaDestroy(void *stack)
+{
+    free(stack);
+}
+
+static StackStatus twinPushCb(void *stack, int data)
+{
+    return twinPush(stack, 0, data);
+}
+
+static StackStatus twinTryPopCb(void *stack, int *out)
+{
+    return twinTryPop(stack, 0, out);
+}
+
+static void *multiCreate(long size)
+{
+    return createMultiStack(1, (unsigned)size);
+}
+
+static StackStatus multiPushCb(void *stack, int data)
+{
+    return multiPush(stack, 0, data);
+}
+
+static StackStatus multiTryPopCb(void *stack, int *out)
+{
+    return multiTryPop(stack, 0, out);
+}
+
+/* ---------------------------------------------------------------------------
+ * Compressed: bit-packed blocks below a plain top
+ * ------------------------------------------------------------------------- */
+
+static void *compressedCreate(long size)
+{
+    (void)size;
+    CompressedStack *stack = malloc(sizeof(CompressedStack));
+    if (stack != NULL && initCompressedStack(stack) != STACK_OK)
+    {
+        free(stack);
+        return NULL;
+    }
+    return stack;
+}
+
+static void compressedDestroy(void *stack)
+{
+    destroyCompressedStack(stack);
+    free(stack);
+}
+
+static StackStatus compressedPushCb(void *stack, int data)
+{
+    return compressedPush(stack, data);
+}
+
+static StackStatus compressedTryPopCb(void *stack, int *out)
+{
+    return compressedTryPop(stack, out);
+}
+
+static const Backend backends[] = {
+    { "array", arrayCreate, arrayDestroy, arrayPush, arrayTryPop, arrayReverse },
+    { "list", listCreate, listDestroy, listPushCb, listTryPopCb, listReverseCb },
+    { "unrolled", unrolledCreate, unrolledDestroy, unrolledPushCb, unrolledTryPopCb, unrolledReverseCb },
+    { "twin", twinCreate, arenaDestroy, twinPushCb, twinTryPopCb, NULL },
+    { "multi", multiCreate, arenaDestroy, multiPushCb, multiTryPopCb, NULL },
+    { "compressed", compressedCreate, compressedDestroy, compressedPushCb, compressedTryPopCb, NULL },
+};
+
+/* ---------------------------------------------------------------------------
+ * Hardware counters
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct counters
+ * @brief Hardware counters of the timed part of one case.
+ */
+typedef struct counters
+{
+    int fd[2];              /**< Group leader and member, -1 when unavailable */
+    long long cacheMisses;  /**< Last-level cache misses, or -1 */
+    long long branchMisses; /**< Mispredicted branches, or -1 */
+} Counters;
+
+#ifdef __linux__
+static int openCounter(uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+/**
+ * @brief Opens the counters, leaving them stopped; they stay unavailable if the kernel refuses.
+ */
+static void openCounters(Counters *counters)
+{
+    counters->fd[0] = counters->fd[1] = -1;
+    counters->cacheMisses = counters->branchMisses = -1;
+#ifdef __linux__
+    counters->fd[0] = openCounter(PERF_COUNT_HW_CACHE_MISSES, -1);
+    if (counters->fd[0] >= 0)
+    {
+        counters->fd[1] = openCounter(PERF_COUNT_HW_BRANCH_MISSES, counters->fd[0]);
+    }
+    if (counters->fd[1] < 0 && counters->fd[0] >= 0)
+    {
+        close(counters->fd[0]);
+        counters->fd[0] = -1;
+    }
+#endif
+}
+
+static void runCounters(Counters *counters, int on)
+{
+#ifdef __linux__
+    if (counters->fd[0] >= 0)
+    {
+        ioctl(counters->fd[0], on ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void)counters;
+    (void)on;
+#endif
+}
+
+/**
+ * @brief Reads the counters into `counters` and closes them.
+ */
+static void closeCounters(Counters *counters)
+{
+#ifdef __linux__
+    uint64_t values[3]; // Number of counters, then their values
+    if (counters->fd[0] >= 0 && read(counters->fd[0], values, sizeof(values)) == sizeof(values))
+    {
+        counters->cacheMisses = (long long)values[1];
+        counters->branchMisses = (long long)values[2];
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (counters->fd[i] >= 0)
+        {
+            close(counters->fd[i]);
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * Timing windows
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct sampler
+ * @brief Splits the timed operations of a case into windows and records each window's ns/op.
+ * @details A window may span several timed sections; the time between them is not counted.
+ */
+typedef struct sampler
+{
+    double *samples;   /**< ns/op of each finished window */
+    size_t count;      /**< Finished windows */
+    long long window;  /**< Operations per window */
+    long long pending; /**< Operations of the current window so far */
+    uint64_t partial;  /**< Nanoseconds of the current window spent in earlier sections */
+    uint64_t mark;     /**< Start of the current window within the current section */
+    uint64_t elapsed;  /**< Nanoseconds of all timed sections */
+    long long ops;     /**< Operations of all timed sections */
+    long long failed;  /**< Pushes that failed or pops that found the stack empty */
+    long long sink;    /**< Sum of the popped values, so the pops are not optimized away */
+    Counters counters; /**< Hardware counters of the timed sections */
+} Sampler;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void startTiming(Sampler *s)
+{
+    runCounters(&s->counters, 1);
+    s->mark = nowNs();
+}
+
+static void stopTiming(Sampler *s)
+{
+    uint64_t now = nowNs();
+    runCounters(&s->counters, 0);
+    s->partial += now - s->mark;
+    s->elapsed += now - s->mark;
+}
+
+/**
+ * @brief Counts `ops` operations towards the current window, closing it once it is long enough.
+ * @param s The sampler, or NULL when the operations are not timed.
+ */
+static void tick(Sampler *s, long long ops)
+{
+    if (s == NULL)
+    {
+        return;
+    }
+    s->pending += ops;
+    s->ops += ops;
+    if (s->pending >= s->window)
+    {
+        uint64_t now = nowNs();
+        s->samples[s->count++] = (double)(s->partial + now - s->mark) / (double)s->pending;
+        s->elapsed += now - s->mark;
+        s->partial = 0;
+        s->pending = 0;
+        s->mark = now;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Workloads
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Runs `groups` groups of `pushes` pushes followed by `pops` pops.
+ * @param s The sampler to count the operations on, or NULL when they are not timed.
+ */
+static void runMix(const Backend *b, void *stack, long groups, int pushes, int pops, Sampler *s, long long *failed,
+                   long long *sink)
+{
+    int value;
+    for (long i = 0; i < groups;)
+    {
+        long end = groups - i > TICK_ITERATIONS ? i + TICK_ITERATIONS : groups;
+        long long done = (long long)(end - i) * (pushes + pops);
+        for (; i < end; i++)
+        {
+            for (int p = 0; p < pushes; p++)
+            {
+                *failed += b->push(stack, (int)i) != STACK_OK;
+            }
+            for (int p = 0; p < pops; p++)
+            {
+                if (b->tryPop(stack, &value) == STACK_OK)
+                {
+                    *sink += value;
+                }
+                else
+                {
+                    (*failed)++;
+                }
+            }
+        }
+        tick(s, done);
+    }
+}
+
+/**
+ * @struct workload
+ * @brief An operation mix, split into an untimed setup and a timed body.
+ */
+typedef struct workload
+{
+    const char *name; /**< Name printed in the report */
+    int prefill;      /**< Non-zero to fill the stack with `size` items before timing */
+    int halves;       /**< Groups per cycle, in halves of the size */
+    int pushes;       /**< Pushes per group */
+    int pops;         /**< Pops per group */
+    int drain;        /**< Non-zero to pop the `size` items back off after every cycle */
+    int cycles;       /**< Times the body is run */
+    int reverse;      /**< Non-zero to time reversals instead of a push/pop mix */
+} Workload;
+
+static const Workload workloads[] = {
+    { "push", 0, 2, 1, 0, 0, 1, 0 },
+    { "pop", 1, 2, 0, 1, 0, 1, 0 },
+    { "push-heavy", 0, 1, 2, 1, 0, 1, 0 },
+    { "pop-heavy", 1, 1, 1, 2, 0, 1, 0 },
+    { "alternating", 1, 2, 1, 1, 0, 1, 0 },
+    { "burst", 0, 2, 1, 0, 1, BURST_CYCLES, 0 },
+    { "reverse", 1, 0, 0, 0, 0, REVERSE_PASSES, 1 },
+};
+
+/**
+ * @brief Returns the number of timed operations of one run of a workload on one stack.
+ */
+static long long workloadOps(const Workload *w, long size)
+{
+    if (w->reverse)
+    {
+        return (long long)w->cycles * size; // One operation per element moved
+    }
+    long long groups = (long long)size * w->halves / 2;
+    return w->cycles * (groups * (w->pushes + w->pops) + (w->drain ? size : 0));
+}
+
+/**
+ * @brief Runs the timed body of a workload on one stack.
+ */
+static void runBody(const Backend *b, const Workload *w, void *stack, long size, Sampler *s)
+{
+    for (int c = 0; c < w->cycles; c++)
+    {
+        if (w->reverse)
+        {
+            b->reverse(stack);
+            tick(s, size);
+            continue;
+        }
+        runMix(b, stack, size * w->halves / 2, w->pushes, w->pops, s, &s->failed, &s->sink);
+        if (w->drain)
+        {
+            runMix(b, stack, size, 0, 1, s, &s->failed, &s->sink);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Cases
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct result
+ * @brief Measurements of one case, sent from the child process that ran it.
+ */
+typedef struct result
+{
+    long long ops;          /**< Timed operations */
+    double nsPerOp;         /**< Mean over all timed operations */
+    double p50, p90, p99;   /**< Percentiles of the per-window ns/op */
+    double max;             /**< Slowest window */
+    long long cacheMisses;  /**< Cache misses of the timed part, or -1 */
+    long long branchMisses; /**< Branch misses of the timed part, or -1 */
+    int ok;                 /**< 0 if a stack could not be created or an operation failed */
+} Result;
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, size_t count, double q)
+{
+    return sorted[(size_t)(q * (double)(count - 1) + 0.5)];
+}
+
+/**
+ * @brief Runs one backend on one workload and size, repeating it until `minOps` operations were timed.
+ */
+static Result runCase(const Backend *b, const Workload *w, long size, long long minOps)
+{
+    Result result = { 0 };
+    long copies = size < SMALL_CASE_ELEMENTS ? (SMALL_CASE_ELEMENTS + size - 1) / size : 1;
+    long long roundOps = workloadOps(w, size) * copies;
+    long long rounds = roundOps > 0 ? (minOps + roundOps - 1) / roundOps : 1;
+    rounds = rounds > 0 ? rounds : 1;
+
+    Sampler s = { 0 };
+    s.window = roundOps / ROUND_MAX_SAMPLES > SAMPLE_MIN_OPS ? roundOps / ROUND_MAX_SAMPLES : SAMPLE_MIN_OPS;
+    s.samples = malloc((size_t)(rounds * roundOps / s.window + 2) * sizeof(double));
+    void **stacks = calloc((size_t)copies, sizeof(void *));
+    if (s.samples == NULL || stacks == NULL)
+    {
+        free(s.samples);
+        free(stacks);
+        return result;
+    }
+    openCounters(&s.counters);
+
+    result.ok = 1;
+    for (long long r = 0; r < rounds && result.ok; r++)
+    {
+        for (long c = 0; c < copies; c++)
+        {
+            stacks[c] = b->create(size + 1); // Alternating and pop-heavy push once onto a full stack
+            result.ok &= stacks[c] != NULL;
+        }
+        for (long c = 0; c < copies && result.ok; c++)
+        {
+            runMix(b, stacks[c], w->prefill ? size : 0, 1, 0, NULL, &s.failed, &s.sink);
+        }
+        if (result.ok)
+        {
+            startTiming(&s);
+            for (long c = 0; c < copies; c++)
+            {
+                runBody(b, w, stacks[c], size, &s);
+            }
+            stopTiming(&s);
+        }
+        for (long c = 0; c < copies; c++)
+        {
+            if (stacks[c] != NULL)
+            {
+                b->destroy(stacks[c]);
+            }
+        }
+    }
+    if (s.count == 0 && s.pending > 0)
+    {
+        s.samples[s.count++] = (double)s.partial / (double)s.pending;
+    }
+    closeCounters(&s.counters);
+
+    if (result.ok && s.count > 0)
+    {
+        qsort(s.samples, s.count, sizeof(double), compareDoubles);
+        result.ops = s.ops;
+        result.nsPerOp = (double)s.elapsed / (double)s.ops;
+        result.p50 = percentile(s.samples, s.count, 0.50);
+        result.p90 = percentile(s.samples, s.count, 0.90);
+        result.p99 = percentile(s.samples, s.count, 0.99);
+        result.max = s.samples[s.count - 1];
+        result.cacheMisses = s.counters.cacheMisses;
+        result.branchMisses = s.counters.branchMisses;
+    }
+    result.ok &= s.failed == 0 && s.count > 0;
+    free(stacks);
+    free(s.samples);
+    return result;
+}
+
+/**
+ * @brief Runs a case in a child process and collects its result and peak RSS.
+ * @return 0 on success, 1 if the child failed.
+ */
+static int forkCase(const Backend *b, const Workload *w, long size, long long minOps, Result *result,
+                    long *peakRssKb)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return 1;
+    }
+    fflush(stdout); // Otherwise the child would inherit, and repeat, buffered output
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return 1;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        Result r = runCase(b, w, size, minOps);
+        exit(write(fds[1], &r, sizeof(r)) == sizeof(r) ? 0 : 1); // exit(), not _exit(), so profiling data is written
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], result, sizeof(*result));
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        got != (ssize_t)sizeof(*result))
+    {
+        return 1;
+    }
+    *peakRssKb = usage.ru_maxrss; // Kilobytes on Linux
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Driver
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Checks whether `name` appears in a comma-separated list; a NULL list selects everything.
+ */
+static int selected(const char *list, const char *name)
+{
+    if (list == NULL)
+    {
+        return 1;
+    }
+    size_t length = strlen(name);
+    for (const char *p = list; *p != '\0';)
+    {
+        const char *end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == length && strncmp(p, name, n) == 0)
+        {
+            return 1;
+        }
+        p += end ? n + 1 : n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints a counter per operation, or an empty CSV field / JSON null when it is unavailable.
+ */
+static void printCounter(long long value, long long ops, int json)
+{
+    if (value < 0)
+    {
+        fputs(json ? "null" : "", stdout);
+    }
+    else
+    {
+        printf("%.4f", (double)value / (double)ops);
+    }
+}
+
+static void printRow(const Backend *b, const Workload *w, long size, const Result *r, long rssKb, int json,
+                     int first)
+{
+    if (json)
+    {
+        printf("%s  {\"backend\":\"%s\",\"workload\":\"%s\",\"size\":%ld,\"ops\":%lld,"
+               "\"ns_per_op\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f,"
+               "\"peak_rss_kb\":%ld,\"cache_misses_per_op\":",
+               first ? "" : ",\n", b->name, w->name, size, r->ops, r->nsPerOp, r->p50, r->p90, r->p99, r->max,
+               rssKb);
+        printCounter(r->cacheMisses, r->ops, json);
+        printf(",\"branch_misses_per_op\":");
+        printCounter(r->branchMisses, r->ops, json);
+        printf(",\"check\":\"%s\"}", r->ok ? "ok" : "FAILED");
+        return;
+    }
+    printf("%s,%s,%ld,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%ld,", b->name, w->name, size, r->ops, r->nsPerOp, r->p50,
+           r->p90, r->p99, r->max, rssKb);
+    printCounter(r->cacheMisses, r->ops, json);
+    printf(",");
+    printCounter(r->branchMisses, r->ops, json);
+    printf(",%s\n", r->ok ? "ok" : "FAILED");
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [-f csv|json] [-b backend,...] [-w workload,...] [-s min size] [-m max size]"
+            " [-o min ops per case]\n",
+            program);
+}
+
+int main(int argc, char *argv[])
+{
+    int json = 0;
+    const char *backendList = NULL, *workloadList = NULL;
+    long minSize = 10, maxSize = 10000000;
+    long long minOps = 1000000;
+    int option;
+    while ((option = getopt(argc, argv, "f:b:w:s:m:o:")) != -1)
+    {
+        switch (option)
+        {
+        case 'f':
+            json = strcmp(optarg, "json") == 0;
+            break;
+        case 'b':
+            backendList = optarg;
+            break;
+        case 'w':
+            workloadList = optarg;
+            break;
+        case 's':
+            minSize = atol(optarg);
+            break;
+        case 'm':
+            maxSize = atol(optarg);
+            break;
+        case 'o':
+            minOps = atoll(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (minSize < 1 || maxSize > 2000000000L)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    printf(json ? "[\n" : "backend,workload,size,ops,ns_per_op,p50_ns,p90_ns,p99_ns,max_ns,peak_rss_kb,"
+                          "cache_misses_per_op,branch_misses_per_op,check\n");
+    int failures = 0, first = 1;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++)
+    {
+        for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++)
+        {
+            if (!selected(backendList, backends[b].name) || !selected(workloadList, workloads[w].name) ||
+                (workloads[w].reverse && backends[b].reverse == NULL))
+            {
+                continue;
+            }
+            for (long size = minSize; size <= maxSize; size *= 10)
+            {
+                Result result = { 0 };
+                long rssKb = 0;
+                if (forkCase(&backends[b], &workloads[w], size, minOps, &result, &rssKb) != 0)
+                {
+                    fprintf(stderr, "%s/%s/%ld: the benchmark process failed\n", backends[b].name,
+                            workloads[w].name, size);
+                    failures++;
+                    continue;
+                }
+                printRow(&backends[b], &workloads[w], size, &result, rssKb, json, first);
+                failures += !result.ok;
+                first = 0;
+            }
+        }
+    }
+    fputs(json ? "\n]\n" : "", stdout);
+    return failures != 0;
+}
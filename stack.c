@@ -0,0 +1,1319 @@
+/**
+ * @file stack.c
+ *
+ * @brief Implementation of the stack library declared in stack.h.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "stack.h"
+#include "stack_stats.h"
+
+/* ---------------------------------------------------------------------------
+ * Array backend
+ * ------------------------------------------------------------------------- */
+
+#define STACK_MIN_GROWTH 4  /**< Smallest number of slots a growing stack adds at once */
+
+/**
+ * @brief Initializes a new stack with the given capacity.
+ * 
+ * Allocates memory for the stack and its array of integers, and sets the 
+ * initial values for top and capacity.
+ * 
+ * @param cap The capacity of the stack.
+ * @return A pointer to the newly created stack, or NULL if it could not be allocated.
+ */
+struct Stack* initializeStack(unsigned cap) {
+    struct Stack* stack = malloc(sizeof(struct Stack));  // Allocate memory for the stack
+    if (stack == NULL)
+        return NULL;
+    if (initStack(stack, cap, 0, 0) != STACK_OK) {       // Fixed capacity by default
+        free(stack);
+        return NULL;
+    }
+    return stack;
+}
+
+/**
+ * @brief Initializes a stack that grows instead of rejecting pushes when full.
+ * 
+ * When the stack fills up its array is reallocated to `capacity * growthFactor`
+ * elements, so push stays amortized O(1). With `shrinkOnPop` set, the array is
+ * halved once the stack drains to a quarter of its capacity; the gap between
+ * the two thresholds keeps push/pop at the boundary from resizing every time.
+ * 
+ * @param cap The initial capacity of the stack, also the floor for shrinking.
+ * @param growthFactor The capacity multiplier on overflow; must be greater than 1.
+ * @param shrinkOnPop Non-zero to release memory as the stack drains.
+ * @return A pointer to the newly created stack, or NULL if it could not be allocated.
+ */
+struct Stack* initializeGrowableStack(unsigned cap, double growthFactor, int shrinkOnPop) {
+    struct Stack* stack = initializeStack(cap);
+    if (stack == NULL)
+        return NULL;
+    stack->growthFactor = growthFactor > 1 ? growthFactor : 2;
+    stack->shrinkOnPop = shrinkOnPop;
+    return stack;
+}
+
+/**
+ * @brief Frees a stack and its array.
+ * 
+ * @param stack A pointer to the stack, or NULL.
+ */
+void freeStack(struct Stack* stack) {
+    if (stack == NULL)
+        return;
+    free(stack->array);
+    free(stack);
+}
+
+/**
+ * @brief Initializes a stack whose header the caller has already allocated.
+ * 
+ * Lets stack headers live inside other structures, such as an array of stacks,
+ * instead of one heap block each.
+ * 
+ * @param stack A pointer to the stack header to initialize.
+ * @param cap The initial capacity of the stack.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @param shrinkOnPop Non-zero to release memory as the stack drains.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initStack(struct Stack* stack, unsigned cap, double growthFactor, int shrinkOnPop) {
+    stack->capacity = cap;                               // Set the stack capacity
+    stack->top = -1;                                     // Initialize top to -1 (empty stack)
+    stack->array = malloc((size_t)cap * sizeof(int));    // Allocate memory for the stack array
+    if (stack->array == NULL && cap > 0)
+        return STACK_NO_MEMORY;
+    stack->growthFactor = growthFactor > 1 ? growthFactor : 0;
+    stack->shrinkOnPop = shrinkOnPop;
+    stack->minCapacity = cap;
+#ifdef STACK_STATS
+    stack->stats = NULL;
+#endif
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees the array of a stack initialized with initStack(), leaving it empty.
+ * 
+ * @param stack A pointer to the stack.
+ */
+void destroyStack(struct Stack* stack) {
+    free(stack->array);
+    stack->array = NULL;
+    stack->top = -1;
+    stack->capacity = 0;
+    stack->minCapacity = 0;
+}
+
+/**
+ * @brief Reallocates the stack array to hold exactly `newCap` elements.
+ * 
+ * @param stack A pointer to the stack.
+ * @param newCap The new capacity; must be at least the current number of elements.
+ * @return 1 on success, 0 if the allocation failed (the stack is left unchanged).
+ */
+static int resizeStack(struct Stack* stack, unsigned newCap) {
+    if (newCap == 0)
+        newCap = 1;  // Keep a valid allocation so realloc never frees the array
+    int* array = realloc(stack->array, (size_t)newCap * sizeof(int));
+    if (array == NULL)
+        return 0;
+    STACK_STATS_EVENT(stack->stats, newCap > stack->capacity ? STATS_GROW : STATS_SHRINK);
+    stack->array = array;
+    stack->capacity = newCap;
+    return 1;
+}
+
+/**
+ * @brief Grows the stack array geometrically by its growth factor.
+ * 
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack now has room for another element, 0 otherwise.
+ */
+static int growStack(struct Stack* stack) {
+    if (stack->capacity >= INT_MAX)
+        return 0;  // top is an int, so the stack cannot address more elements
+    double wanted = stack->capacity * stack->growthFactor;
+    unsigned newCap = wanted > INT_MAX ? INT_MAX : (unsigned)wanted;
+    if (newCap < stack->capacity + STACK_MIN_GROWTH)
+        newCap = stack->capacity + STACK_MIN_GROWTH;
+    if (newCap > INT_MAX)
+        newCap = INT_MAX;
+    return resizeStack(stack, newCap);
+}
+
+/**
+ * @brief Halves the array of a shrinking stack once it is only a quarter full.
+ * 
+ * Halving repeats while the condition still holds, so a single large pop
+ * releases as much memory as the equivalent run of single pops.
+ * 
+ * @param stack A pointer to the stack.
+ */
+static void shrinkAfterPop(struct Stack* stack) {
+    while (stack->shrinkOnPop && stack->capacity / 2 >= stack->minCapacity &&
+           stack->capacity / 2 > 0 && (unsigned)(stack->top + 1) <= stack->capacity / 4) {
+        if (!resizeStack(stack, stack->capacity / 2))
+            return;
+    }
+}
+
+/**
+ * @brief Ensures the stack can hold at least `cap` elements without reallocating.
+ * 
+ * @param stack A pointer to the stack.
+ * @param cap The number of elements to reserve room for.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the allocation failed.
+ */
+StackStatus reserveStack(struct Stack* stack, unsigned cap) {
+    if (cap <= stack->capacity)
+        return STACK_OK;
+    if (cap > INT_MAX || !resizeStack(stack, cap))
+        return STACK_NO_MEMORY;
+    return STACK_OK;
+}
+
+/**
+ * @brief Releases unused capacity so the array holds only the live elements.
+ * 
+ * @param stack A pointer to the stack.
+ */
+void shrinkToFit(struct Stack* stack) {
+    unsigned size = (unsigned)(stack->top + 1);
+    if (size < stack->capacity)
+        resizeStack(stack, size);
+}
+
+/**
+ * @brief Checks if the stack is full.
+ * 
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is full, 0 otherwise.
+ */
+int isFull(struct Stack* stack) { 
+    return stack->top == (signed int)stack->capacity - 1; 
+}
+
+/**
+ * @brief Checks if the stack is empty.
+ * 
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int isEmpty(struct Stack* stack) { 
+    return stack->top == -1; 
+} 
+
+/**
+ * @brief Pushes an item onto the stack.
+ * 
+ * This function adds an item to the top of the stack if the stack is not full.
+ * A growable stack reallocates its array instead of rejecting the item.
+ * 
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if a growable stack could not grow.
+ */
+StackStatus push(struct Stack* stack, int item) {
+    STACK_STATS_BEGIN(stack->stats, STATS_PUSH, timer);
+    if (STACK_UNLIKELY(isFull(stack))) {
+        if (stack->growthFactor <= 1) {
+            STACK_STATS_EVENT(stack->stats, STATS_FULL);
+            return STACK_FULL;
+        }
+        if (!growStack(stack)) {
+            STACK_STATS_EVENT(stack->stats, STATS_NO_MEMORY);
+            return STACK_NO_MEMORY;
+        }
+    }
+    stack->top++;                           // Increment the top index
+    stack->array[stack->top] = item;        // Insert the item at the top of the stack
+    STACK_STATS_END(timer, STATS_PUSH, 1, stackSize(stack));
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops an item from the stack.
+ * 
+ * This function removes and returns the top item from the stack if it is not empty.
+ * 
+ * @param stack A pointer to the stack.
+ * @return The popped item if the stack is not empty; otherwise, returns INT_MIN.
+ */
+int pop(struct Stack* stack) {
+    if (STACK_UNLIKELY(isEmpty(stack))) {
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+        return INT_MIN;  // Return an indicator of an empty stack
+    }
+    return popUnchecked(stack);
+}
+
+/**
+ * @brief Peeks at the top item of the stack without removing it.
+ * 
+ * @param stack A pointer to the stack.
+ * @return The top item of the stack if the stack is not empty; otherwise, returns INT_MIN.
+ */
+int peek(struct Stack* stack) { 
+    if (STACK_UNLIKELY(isEmpty(stack))) {
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+        return INT_MIN; 
+    }
+    STACK_STATS_COUNT(stack->stats, STATS_PEEK, 1, 0);
+    return stack->array[stack->top];  // Return the top item without removing it
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * 
+ * @param stack A pointer to the stack.
+ * @return The number of items on the stack.
+ */
+unsigned stackSize(struct Stack* stack) {
+    return (unsigned)(stack->top + 1);
+}
+
+/**
+ * @brief Pops an item from the stack, reporting an empty stack separately from the item.
+ * 
+ * Unlike pop(), every int value including INT_MIN can be told apart from failure.
+ * 
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus tryPop(struct Stack* stack, int* out) {
+    if (STACK_UNLIKELY(isEmpty(stack))) {
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+        return STACK_EMPTY;
+    }
+    *out = popUnchecked(stack);
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item of the stack, reporting an empty stack separately from the item.
+ * 
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus tryPeek(struct Stack* stack, int* out) {
+    if (STACK_UNLIKELY(isEmpty(stack))) {
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+        return STACK_EMPTY;
+    }
+    STACK_STATS_COUNT(stack->stats, STATS_PEEK, 1, 0);
+    *out = stack->array[stack->top];
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops an item from a stack the caller knows is not empty.
+ * 
+ * @param stack A pointer to a non-empty stack.
+ * @return The popped item.
+ */
+int popUnchecked(struct Stack* stack) {
+    STACK_STATS_BEGIN(stack->stats, STATS_POP, timer);
+    int val = stack->array[stack->top--];
+    if (stack->shrinkOnPop)
+        shrinkAfterPop(stack);
+    STACK_STATS_END(timer, STATS_POP, 1, 0);
+    return val;
+}
+
+/**
+ * @brief Reads the top item of a stack the caller knows is not empty.
+ * 
+ * @param stack A pointer to a non-empty stack.
+ * @return The top item.
+ */
+int peekUnchecked(struct Stack* stack) {
+    STACK_STATS_COUNT(stack->stats, STATS_PEEK, 1, 0);
+    return stack->array[stack->top];
+}
+
+/**
+ * @brief Pushes a run of items onto the stack with a single capacity check.
+ * 
+ * The items are pushed in array order, so `items[n - 1]` ends up on top. Either
+ * all items are pushed or, if the stack cannot make room for them, none are.
+ * 
+ * @param stack A pointer to the stack.
+ * @param items The items to be pushed onto the stack.
+ * @param n The number of items.
+ * @return The number of items pushed: `n` on success, 0 if the stack is full.
+ */
+unsigned pushN(struct Stack* stack, const int* items, unsigned n) {
+    unsigned size = (unsigned)(stack->top + 1);
+    if (n > stack->capacity - size) {
+        if (stack->growthFactor <= 1 || n > INT_MAX - size) {
+            STACK_STATS_EVENT(stack->stats, STATS_FULL);
+            return 0;
+        }
+        // Grow geometrically unless the run alone needs more than that
+        unsigned needed = size + n;
+        double grown = stack->capacity * stack->growthFactor;
+        if (grown > needed)
+            needed = grown > INT_MAX ? INT_MAX : (unsigned)grown;
+        if (reserveStack(stack, needed) != STACK_OK) {
+            STACK_STATS_EVENT(stack->stats, STATS_NO_MEMORY);
+            return 0;
+        }
+    }
+    memcpy(stack->array + size, items, (size_t)n * sizeof(int));
+    stack->top += (int)n;
+    STACK_STATS_COUNT(stack->stats, STATS_PUSH, n, size + n);
+    return n;
+}
+
+/**
+ * @brief Copies up to `n` items from the top of the stack, top first, without recording statistics.
+ * 
+ * @param stack A pointer to the stack.
+ * @param out The array receiving the items.
+ * @param n The maximum number of items to copy.
+ * @return The number of items copied.
+ */
+static unsigned copyTop(struct Stack* stack, int* out, unsigned n) {
+    unsigned size = (unsigned)(stack->top + 1);
+    if (n > size)
+        n = size;
+    const int* src = stack->array + stack->top;  // Copy downwards from the top item
+    for (unsigned i = 0; i < n; i++) {
+        out[i] = src[-(int)i];
+    }
+    return n;
+}
+
+/**
+ * @brief Copies up to `n` items from the top of the stack without removing them.
+ * 
+ * @param stack A pointer to the stack.
+ * @param out The array receiving the items, top of the stack first.
+ * @param n The maximum number of items to copy.
+ * @return The number of items copied, which is less than `n` if the stack runs out.
+ */
+unsigned peekN(struct Stack* stack, int* out, unsigned n) {
+    n = copyTop(stack, out, n);
+    STACK_STATS_COUNT(stack->stats, STATS_PEEK, n, 0);
+    return n;
+}
+
+/**
+ * @brief Pops up to `n` items from the stack with a single bounds check.
+ * 
+ * The items are stored in the order repeated calls to pop() would return them,
+ * so `out[0]` receives the old top of the stack.
+ * 
+ * @param stack A pointer to the stack.
+ * @param out The array receiving the popped items; must have room for `n` items.
+ * @param n The maximum number of items to pop.
+ * @return The number of items popped, which is less than `n` if the stack runs out.
+ */
+unsigned popN(struct Stack* stack, int* out, unsigned n) {
+    if (STACK_UNLIKELY(n > stackSize(stack)))
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+    n = copyTop(stack, out, n);
+    stack->top -= (int)n;
+    STACK_STATS_COUNT(stack->stats, STATS_POP, n, 0);
+    shrinkAfterPop(stack);
+    return n;
+}
+
+/**
+ * @brief Reverses the stack in place.
+ * 
+ * This function swaps elements pairwise from both ends of the array towards the
+ * middle, so it needs no auxiliary storage. Where SSE2 is available, four elements
+ * are swapped at a time from each end, reversing each group with a shuffle.
+ * 
+ * @param stack A pointer to the stack to be reversed.
+ */
+void reverseStack(struct Stack* stack) {
+    if (stack->top < 1)
+        return;  // Nothing to swap; also keeps array + top from pointing before the array
+    int* lo = stack->array;               // Bottom-most element not yet swapped
+    int* hi = stack->array + stack->top;  // Top-most element not yet swapped
+
+#ifdef __SSE2__
+    // Swap four-element groups while they do not overlap
+    while (hi - lo >= 7) {
+        __m128i bottom = _mm_loadu_si128((__m128i*)lo);
+        __m128i top = _mm_loadu_si128((__m128i*)(hi - 3));
+        _mm_storeu_si128((__m128i*)lo, _mm_shuffle_epi32(top, _MM_SHUFFLE(0, 1, 2, 3)));
+        _mm_storeu_si128((__m128i*)(hi - 3), _mm_shuffle_epi32(bottom, _MM_SHUFFLE(0, 1, 2, 3)));
+        lo += 4;
+        hi -= 4;
+    }
+#endif
+
+    // Swap the remaining elements one pair at a time
+    while (lo < hi) {
+        int item = *lo;
+        *lo++ = *hi;
+        *hi-- = item;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Linked-list backend
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @def SLAB_BYTES
+ * @brief Size and alignment of one slab of pooled nodes.
+ * @details Slabs are aligned to their own size, so the slab owning a node is found by masking the node's address.
+ */
+#define SLAB_BYTES 65536
+
+/**
+ * @struct slab
+ * @brief Header of a chunk of nodes carved out of a single allocation.
+ * @details The nodes follow the header directly in memory. Only the owning
+ *          pool's thread touches `used`; other threads hand nodes back through
+ *          the owner's remote free list.
+ */
+typedef struct slab
+{
+    NodePool *owner;   /**< Pool the slab was carved for; never changes */
+    struct slab *next; /**< Next slab owned by the same pool */
+    size_t used;       /**< Number of nodes of this slab currently handed out */
+} Slab;
+
+/**
+ * @def SLAB_NODES
+ * @brief Number of nodes that fit in one slab after its header.
+ */
+#define SLAB_NODES ((SLAB_BYTES - sizeof(Slab)) / sizeof(Node))
+
+/**
+ * @brief Finds the slab a pooled node belongs to.
+ * @param node A node handed out by poolAlloc.
+ * @return A pointer to the owning slab's header.
+ */
+static Slab *slabOf(Node *node)
+{
+    return (Slab *)((uintptr_t)node & ~(uintptr_t)(SLAB_BYTES - 1));
+}
+
+/**
+ * @brief Initializes an empty node pool.
+ * @param pool A pointer to the pool to initialize.
+ */
+void initNodePool(NodePool *pool)
+{
+    pool->freeList = NULL;
+    pool->slabs = NULL;
+    atomic_init(&pool->remoteFree, NULL);
+    pool->nextOrphan = NULL;
+}
+
+static _Thread_local NodePool *threadPool;                     /**< The calling thread's pool, created on first use */
+static pthread_once_t poolKeyOnce = PTHREAD_ONCE_INIT;         /**< Guards the creation of poolKey */
+static pthread_key_t poolKey;                                  /**< Runs releaseThreadPool() at thread exit */
+static int poolKeyReady;                                       /**< 1 once poolKey exists */
+static pthread_mutex_t orphanLock = PTHREAD_MUTEX_INITIALIZER; /**< Protects orphanPools */
+static NodePool *orphanPools;                                  /**< Pools of exited threads that still had live nodes */
+
+/**
+ * @brief Releases the orphaned pools whose nodes have all been freed since their thread exited.
+ * @details Called with orphanLock held, which makes the caller the only user of
+ *          the orphans. Only a pool other threads have freed nodes into since it
+ *          was trimmed is trimmed again, so the list stays cheap to walk.
+ */
+static void reclaimOrphanPools(void)
+{
+    NodePool **pool_ref = &orphanPools;
+    while (*pool_ref != NULL)
+    {
+        NodePool *pool = *pool_ref;
+        if (atomic_load_explicit(&pool->remoteFree, memory_order_relaxed) != NULL)
+        {
+            trimNodePool(pool);
+        }
+        if (pool->slabs == NULL)
+        {
+            *pool_ref = pool->nextOrphan;
+            free(pool);
+        }
+        else
+        {
+            pool_ref = &pool->nextOrphan;
+        }
+    }
+}
+
+/**
+ * @brief Exit handler releasing every orphaned pool, nodes still linked into stacks included.
+ * @details No thread is left to adopt them, so their nodes can only be freed by
+ *          stacks the process is about to drop anyway.
+ */
+static void releaseOrphanPools(void)
+{
+    pthread_mutex_lock(&orphanLock);
+    while (orphanPools != NULL)
+    {
+        NodePool *pool = orphanPools;
+        orphanPools = pool->nextOrphan;
+        drainNodePool(pool);
+        free(pool);
+    }
+    pthread_mutex_unlock(&orphanLock);
+}
+
+/**
+ * @brief Hands back a node of another pool by pushing it onto that pool's remote free list.
+ * @details Only the owner ever takes nodes off the list, and it takes all of them
+ *          at once, so the push cannot suffer from ABA.
+ */
+static void remoteFree(NodePool *owner, Node *node)
+{
+    Node *head = atomic_load_explicit(&owner->remoteFree, memory_order_relaxed);
+    do
+    {
+        node->link = head;
+    } while (!atomic_compare_exchange_weak_explicit(&owner->remoteFree, &head, node, memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/**
+ * @brief Moves the nodes other threads handed back onto the pool's own free list.
+ * @param pool A pointer to the pool, on its owner's thread.
+ * @return 1 if any node was collected, 0 otherwise.
+ */
+static int collectRemoteFrees(NodePool *pool)
+{
+    if (atomic_load_explicit(&pool->remoteFree, memory_order_relaxed) == NULL)
+    {
+        return 0;
+    }
+    Node *node = atomic_exchange_explicit(&pool->remoteFree, NULL, memory_order_acquire);
+    while (node != NULL)
+    {
+        Node *next = node->link;
+        slabOf(node)->used--;
+        node->link = pool->freeList;
+        pool->freeList = node;
+        node = next;
+    }
+    return 1;
+}
+
+/**
+ * @brief Thread-exit destructor of a thread's pool.
+ * @details Slabs whose nodes are all free are released. If nodes are still
+ *          linked into stacks, the pool must outlive its thread so those nodes
+ *          can still be freed; it is parked for the next new thread to adopt,
+ *          or released once they have all been freed. Orphans whose nodes were
+ *          freed since are released here too.
+ * @param arg The exiting thread's pool.
+ */
+static void releaseThreadPool(void *arg)
+{
+    NodePool *pool = arg;
+    threadPool = NULL;
+    trimNodePool(pool);
+    pthread_mutex_lock(&orphanLock);
+    reclaimOrphanPools();
+    if (pool->slabs == NULL)
+    {
+        free(pool);
+    }
+    else
+    {
+        pool->nextOrphan = orphanPools;
+        orphanPools = pool;
+    }
+    pthread_mutex_unlock(&orphanLock);
+}
+
+/**
+ * @brief Creates the key whose destructor releases each thread's pool, and the
+ *        exit handler releasing the pools left orphaned.
+ */
+static void createPoolKey(void)
+{
+    poolKeyReady = pthread_key_create(&poolKey, releaseThreadPool) == 0;
+    atexit(releaseOrphanPools);
+}
+
+/**
+ * @brief Returns the calling thread's default node pool.
+ * @details The pool is created on first use, or adopted from a thread that
+ *          exited while some of its nodes were still in use, and released when
+ *          the thread exits. Orphans whose nodes have all been freed meanwhile
+ *          are released rather than adopted.
+ * @return A pointer to the thread's pool, or NULL if it could not be allocated.
+ */
+NodePool *threadNodePool(void)
+{
+    if (threadPool != NULL)
+    {
+        return threadPool;
+    }
+    pthread_once(&poolKeyOnce, createPoolKey);
+    pthread_mutex_lock(&orphanLock);
+    reclaimOrphanPools();
+    NodePool *pool = orphanPools;
+    if (pool != NULL)
+    {
+        orphanPools = pool->nextOrphan;
+    }
+    pthread_mutex_unlock(&orphanLock);
+    if (pool == NULL)
+    {
+        pool = malloc(sizeof(NodePool));
+        if (pool == NULL)
+        {
+            return NULL;
+        }
+        initNodePool(pool);
+    }
+    if (poolKeyReady)
+    {
+        pthread_setspecific(poolKey, pool); // Without the key the pool simply lives until exit
+    }
+    threadPool = pool;
+    return pool;
+}
+
+/**
+ * @brief Takes a node from the pool's free list, carving a new slab when it is empty.
+ * @details Nodes handed back by other threads are collected before a new slab is carved.
+ * @param pool A pointer to the pool.
+ * @return A pointer to an uninitialized node, or NULL if a new slab could not be allocated.
+ */
+Node *poolAlloc(NodePool *pool)
+{
+    if (pool->freeList == NULL && !collectRemoteFrees(pool))
+    {
+        Slab *slab = aligned_alloc(SLAB_BYTES, SLAB_BYTES);
+        if (!slab)
+        {
+            return NULL;
+        }
+        slab->owner = pool;
+        slab->used = 0;
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+
+        // Thread the new nodes onto the free list, lowest address on top
+        Node *nodes = (Node *)(slab + 1);
+        for (size_t i = SLAB_NODES; i-- > 0;)
+        {
+            nodes[i].link = pool->freeList;
+            pool->freeList = &nodes[i];
+        }
+    }
+    Node *node = pool->freeList;
+    pool->freeList = node->link;
+    slabOf(node)->used++;
+    return node;
+}
+
+/**
+ * @brief Puts a node back on the free list of the pool it came from.
+ * @details A node of another pool, e.g. pushed on one thread and popped on
+ *          another, goes onto that pool's remote free list for its owner to collect.
+ * @param pool The calling thread's pool, or NULL.
+ * @param node The node to be released.
+ */
+void poolFree(NodePool *pool, Node *node)
+{
+    Slab *slab = slabOf(node);
+    if (STACK_UNLIKELY(slab->owner != pool))
+    {
+        remoteFree(slab->owner, node);
+        return;
+    }
+    slab->used--;
+    node->link = pool->freeList;
+    pool->freeList = node;
+}
+
+/**
+ * @brief Gives every slab without live nodes back to the system allocator.
+ * @param pool A pointer to the pool, or NULL.
+ * @return The number of slabs released.
+ */
+size_t trimNodePool(NodePool *pool)
+{
+    if (pool == NULL)
+    {
+        return 0;
+    }
+    collectRemoteFrees(pool);
+
+    // Unlink the free nodes that live in empty slabs
+    Node **node_ref = &pool->freeList;
+    while (*node_ref != NULL)
+    {
+        if (slabOf(*node_ref)->used == 0)
+        {
+            *node_ref = (*node_ref)->link;
+        }
+        else
+        {
+            node_ref = &(*node_ref)->link;
+        }
+    }
+
+    // Then release those slabs
+    size_t released = 0;
+    Slab **slab_ref = &pool->slabs;
+    while (*slab_ref != NULL)
+    {
+        Slab *slab = *slab_ref;
+        if (slab->used == 0)
+        {
+            *slab_ref = slab->next;
+            free(slab);
+            released++;
+        }
+        else
+        {
+            slab_ref = &slab->next;
+        }
+    }
+    return released;
+}
+
+/**
+ * @brief Releases all slabs of the pool, whether or not their nodes are still in use.
+ * @details Unlike trimNodePool(), this does not look at the nodes at all, so it
+ *          is only safe once no stack holds a node of the pool anymore.
+ * @param pool A pointer to the pool, or NULL.
+ */
+void drainNodePool(NodePool *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    while (pool->slabs != NULL)
+    {
+        Slab *slab = pool->slabs;
+        pool->slabs = slab->next;
+        free(slab);
+    }
+    pool->freeList = NULL;
+    atomic_store_explicit(&pool->remoteFree, NULL, memory_order_relaxed);
+}
+
+/**
+ * @brief Creates a new node with the given data value, taken from the thread's node pool.
+ * @param data The integer value to be stored in the node.
+ * @return A pointer to the newly created node, or NULL if no memory was available.
+ */
+Node *createNode(int data)
+{
+    NodePool *pool = threadNodePool();
+    Node *newNode = pool != NULL ? poolAlloc(pool) : NULL;
+    if (!newNode)
+    {
+        return NULL;
+    }
+    newNode->data = data;
+    newNode->link = NULL;
+    return newNode;
+}
+
+/**
+ * @brief Pushes a new node with data onto the stack.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The data to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listPush(Node **top_ref, int data)
+{
+    Node *new = createNode(data);
+    if (STACK_UNLIKELY(!new))
+    {
+        return STACK_NO_MEMORY;
+    }
+    new->link = *top_ref;
+    *top_ref = new;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pushes a new node with data onto the stack, taking the node from the given pool.
+ * @param pool A pointer to the node pool.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The data to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listPushPooled(NodePool *pool, Node **top_ref, int data)
+{
+    Node *new = poolAlloc(pool);
+    if (STACK_UNLIKELY(!new))
+    {
+        return STACK_NO_MEMORY;
+    }
+    new->data = data;
+    new->link = *top_ref;
+    *top_ref = new;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top node from the stack.
+ * @param top_ref A double pointer to the top of the stack.
+ * @return The data of the popped node. If the stack is empty, returns INT_MIN.
+ */
+int listPop(Node **top_ref)
+{
+    if (STACK_UNLIKELY(*top_ref == NULL))
+    {
+        return INT_MIN; // Return INT_MIN if the stack is empty
+    }
+    return listPopUnchecked(top_ref);
+}
+
+/**
+ * @brief Pops the top node from the stack, returning it to the given pool.
+ * @param pool A pointer to the node pool the stack's nodes came from.
+ * @param top_ref A double pointer to the top of the stack.
+ * @return The data of the popped node. If the stack is empty, returns INT_MIN.
+ */
+int listPopPooled(NodePool *pool, Node **top_ref)
+{
+    if (STACK_UNLIKELY(*top_ref == NULL))
+    {
+        return INT_MIN; // Return INT_MIN if the stack is empty
+    }
+    int val = (*top_ref)->data;
+    Node *temp = *top_ref;
+    *top_ref = (*top_ref)->link;
+    poolFree(pool, temp);
+    return val;
+}
+
+/**
+ * @brief Pushes a run of items by building their chain off to the side and splicing it on top.
+ * @details The chain is linked bottom-up from `items[0]`, then attached to the stack with a
+ *          single pointer store. If the pool runs out of memory midway, the partial chain is
+ *          released and the stack is left untouched.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param items The items to be pushed; `items[n - 1]` ends up on top.
+ * @param n The number of items.
+ * @return The number of items pushed: `n` on success, 0 if no memory was available.
+ */
+unsigned listPushN(Node **top_ref, const int *items, unsigned n)
+{
+    NodePool *pool = threadNodePool();
+    if (pool == NULL)
+    {
+        return 0;
+    }
+    Node *chain = NULL;   // Top of the chain being built
+    Node *bottom = NULL;  // Bottom of the chain, linked to the stack last
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        Node *new = poolAlloc(pool);
+        if (!new)
+        {
+            while (chain != NULL)
+            {
+                Node *temp = chain;
+                chain = chain->link;
+                poolFree(pool, temp);
+            }
+            return 0;
+        }
+        new->data = items[i];
+        new->link = chain;
+        chain = new;
+        if (bottom == NULL)
+        {
+            bottom = new;
+        }
+    }
+
+    if (chain != NULL)
+    {
+        bottom->link = *top_ref;
+        *top_ref = chain;
+    }
+    return n;
+}
+
+/**
+ * @brief Pops up to `n` items from the stack, returning their nodes to the thread's pool.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param out The array receiving the popped items, top of the stack first.
+ * @param n The maximum number of items to pop.
+ * @return The number of items popped.
+ */
+unsigned listPopN(Node **top_ref, int *out, unsigned n)
+{
+    NodePool *pool = threadNodePool();
+    Node *top = *top_ref;
+    unsigned i = 0;
+    while (i < n && top != NULL)
+    {
+        Node *temp = top;
+        out[i++] = temp->data;
+        top = temp->link;
+        poolFree(pool, temp);
+    }
+    *top_ref = top;
+    return i;
+}
+
+/**
+ * @brief Copies up to `n` items from the top of the stack without removing them.
+ * @param top A pointer to the top of the stack.
+ * @param out The array receiving the items, top of the stack first.
+ * @param n The maximum number of items to copy.
+ * @return The number of items copied.
+ */
+unsigned listPeekN(Node *top, int *out, unsigned n)
+{
+    unsigned i = 0;
+    for (Node *temp = top; i < n && temp != NULL; temp = temp->link)
+    {
+        out[i++] = temp->data;
+    }
+    return i;
+}
+
+/**
+ * @brief Checks if the stack is empty.
+ * @param top A pointer to the top of the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int listIsEmpty(Node *top)
+{
+    return top == NULL;
+}
+
+/**
+ * @brief Peeks at the top element of the stack without removing it.
+ * @param top A pointer to the top of the stack.
+ * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ */
+int listPeek(Node *top)
+{
+    if (STACK_UNLIKELY(listIsEmpty(top)))
+    {
+        return INT_MIN; // Return INT_MIN if the stack is empty
+    }
+    return top->data;
+}
+
+/**
+ * @brief Counts the elements of the stack by walking the list.
+ * @param top A pointer to the top of the stack.
+ * @return The number of elements on the stack.
+ */
+size_t listSize(Node *top)
+{
+    size_t size = 0;
+    for (Node *temp = top; temp != NULL; temp = temp->link)
+    {
+        size++;
+    }
+    return size;
+}
+
+/**
+ * @brief Pops the top element, reporting an empty stack separately from the value.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus listTryPop(Node **top_ref, int *out)
+{
+    if (STACK_UNLIKELY(*top_ref == NULL))
+    {
+        return STACK_EMPTY;
+    }
+    *out = listPopUnchecked(top_ref);
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top element, reporting an empty stack separately from the value.
+ * @param top A pointer to the top of the stack.
+ * @param out Receives the top value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus listTryPeek(Node *top, int *out)
+{
+    if (STACK_UNLIKELY(top == NULL))
+    {
+        return STACK_EMPTY;
+    }
+    *out = top->data;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top element of a stack the caller knows is not empty.
+ * @param top_ref A double pointer to the top of a non-empty stack.
+ * @return The value of the popped element.
+ */
+int listPopUnchecked(Node **top_ref)
+{
+    Node *temp = *top_ref;
+    int val = temp->data;
+    *top_ref = temp->link;
+    poolFree(threadNodePool(), temp);
+    return val;
+}
+
+/**
+ * @brief Reads the top element of a stack the caller knows is not empty.
+ * @param top A pointer to the top of a non-empty stack.
+ * @return The value of the top element.
+ */
+int listPeekUnchecked(Node *top)
+{
+    return top->data;
+}
+
+/**
+ * @brief Reverses the stack in place by relinking its nodes.
+ * @param top_ref A double pointer to the top of the stack.
+ */
+void listReverse(Node** top_ref)
+{
+    Node* prev = NULL;
+    Node* curr = *top_ref;
+
+    // Point every node at the one that used to be above it
+    while (curr != NULL)
+    {
+        Node* next = curr->link;
+        curr->link = prev;
+        prev = curr;
+        curr = next;
+    }
+    *top_ref = prev;
+}
+
+/**
+ * @brief Frees every node of the stack, leaving it empty.
+ * @details Nodes go back to the pool they came from, so the slabs can be trimmed.
+ * @param top_ref A double pointer to the top of the stack.
+ */
+void listClear(Node **top_ref)
+{
+    NodePool *pool = threadNodePool();
+    while (*top_ref != NULL)
+    {
+        Node *temp = *top_ref;
+        *top_ref = temp->link;
+        poolFree(pool, temp);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Unrolled linked-list backend
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Pushes an item onto the stack, starting a new block when the top one is full.
+ * @param stack A pointer to the stack.
+ * @param data The data to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a new block could not be allocated.
+ */
+StackStatus unrolledPush(UnrolledStack *stack, int data)
+{
+    Block *top = stack->top;
+    if (STACK_UNLIKELY(top == NULL || top->count == (int)BLOCK_ITEMS))
+    {
+        Block *new = stack->spare;
+        if (new != NULL)
+        {
+            stack->spare = NULL;
+        }
+        else
+        {
+            new = malloc(sizeof(Block));
+            if (STACK_UNLIKELY(!new))
+            {
+                return STACK_NO_MEMORY;
+            }
+        }
+        new->count = 0;
+        new->link = top;
+        stack->top = top = new;
+    }
+    top->items[top->count++] = data;
+    stack->size++;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top element from the stack, unlinking the top block once it empties.
+ * @param stack A pointer to the stack.
+ * @return The popped element. If the stack is empty, returns INT_MIN.
+ */
+int unrolledPop(UnrolledStack *stack)
+{
+    if (STACK_UNLIKELY(stack->top == NULL))
+    {
+        return INT_MIN; // Return INT_MIN if the stack is empty
+    }
+    return unrolledPopUnchecked(stack);
+}
+
+/**
+ * @brief Checks if the stack is empty.
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int unrolledIsEmpty(UnrolledStack *stack)
+{
+    return stack->top == NULL;
+}
+
+/**
+ * @brief Peeks at the top element of the stack without removing it.
+ * @param stack A pointer to the stack.
+ * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ */
+int unrolledPeek(UnrolledStack *stack)
+{
+    if (STACK_UNLIKELY(unrolledIsEmpty(stack)))
+    {
+        return INT_MIN; // Return INT_MIN if the stack is empty
+    }
+    return stack->top->items[stack->top->count - 1];
+}
+
+/**
+ * @brief Returns the number of elements on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of elements on the stack.
+ */
+size_t unrolledSize(UnrolledStack *stack)
+{
+    return stack->size;
+}
+
+/**
+ * @brief Pops the top element, reporting an empty stack separately from the value.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus unrolledTryPop(UnrolledStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->top == NULL))
+    {
+        return STACK_EMPTY;
+    }
+    *out = unrolledPopUnchecked(stack);
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top element, reporting an empty stack separately from the value.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus unrolledTryPeek(UnrolledStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->top == NULL))
+    {
+        return STACK_EMPTY;
+    }
+    *out = stack->top->items[stack->top->count - 1];
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top element of a stack the caller knows is not empty.
+ * @details The top block is unlinked once it empties and kept as the spare.
+ * @param stack A pointer to a non-empty stack.
+ * @return The value of the popped element.
+ */
+int unrolledPopUnchecked(UnrolledStack *stack)
+{
+    Block *top = stack->top;
+    int val = top->items[--top->count];
+    stack->size--;
+    if (STACK_UNLIKELY(top->count == 0))
+    {
+        stack->top = top->link;
+        free(stack->spare); // Keep at most one spare block
+        stack->spare = top;
+    }
+    return val;
+}
+
+/**
+ * @brief Reads the top element of a stack the caller knows is not empty.
+ * @param stack A pointer to a non-empty stack.
+ * @return The value of the top element.
+ */
+int unrolledPeekUnchecked(UnrolledStack *stack)
+{
+    return stack->top->items[stack->top->count - 1];
+}
+
+/**
+ * @brief Reverses the stack in place by reversing the block list and the elements of each block.
+ * @details Blocks keep their fill counts, so a partially filled block may end up below full ones.
+ *          Push only ever appends to the top block, so this needs no rebalancing.
+ * @param stack A pointer to the stack.
+ */
+void unrolledReverse(UnrolledStack *stack)
+{
+    Block *prev = NULL;
+    Block *block = stack->top;
+    while (block != NULL)
+    {
+        // Reverse the elements within the block
+        for (int i = 0, j = block->count - 1; i < j; i++, j--)
+        {
+            int tmp = block->items[i];
+            block->items[i] = block->items[j];
+            block->items[j] = tmp;
+        }
+
+        // Relink the block in front of the already reversed ones
+        Block *next = block->link;
+        block->link = prev;
+        prev = block;
+        block = next;
+    }
+    stack->top = prev;
+}
+
+/**
+ * @brief Frees every block of the stack, including the spare, leaving it empty.
+ * @param stack A pointer to the stack.
+ */
+void unrolledClear(UnrolledStack *stack)
+{
+    while (stack->top != NULL)
+    {
+        Block *temp = stack->top;
+        stack->top = temp->link;
+        free(temp);
+    }
+    free(stack->spare);
+    stack->spare = NULL;
+    stack->size = 0;
+}
@@ -0,0 +1,574 @@
+/**
+ * @file stack.h
+ *
+ * @brief Stack library shared by the menu-driven programs.
+ *
+ * Three backends are provided: a (optionally growable) array stack, a linked-list
+ * stack whose nodes come from a slab pool, and an unrolled linked-list stack whose
+ * nodes hold whole blocks of elements. None of the operations print anything;
+ * failures are reported through return values and left to the caller to report.
+ */
+
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * @def STACK_UNLIKELY
+ * @brief Marks a condition as rarely true so the compiler lays out the common path first.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define STACK_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define STACK_UNLIKELY(x) (x)
+#endif
+
+/**
+ * @enum stackStatus
+ * @brief Result of a stack operation that can fail.
+ */
+typedef enum stackStatus
+{
+    STACK_OK = 0,    /**< The operation succeeded */
+    STACK_FULL,      /**< A fixed-capacity stack had no room left */
+    STACK_EMPTY,     /**< The stack held no element to remove */
+    STACK_NO_MEMORY, /**< Memory for the operation could not be allocated */
+    STACK_IO_ERROR,  /**< A file could not be opened, read, written or mapped */
+    STACK_CORRUPT,   /**< Serialized data was malformed, truncated or failed its checksum */
+    STACK_EXISTS     /**< A stack with the requested name already exists */
+} StackStatus;
+
+/* ---------------------------------------------------------------------------
+ * Array backend
+ * ------------------------------------------------------------------------- */
+
+/**
+ * Structure representing a stack.
+ */
+struct Stack {
+    int top;             /**< Index of the top element in the stack */
+    unsigned capacity;   /**< Maximum number of elements the stack can hold */
+    int* array;          /**< Pointer to the array holding the stack elements */
+    double growthFactor; /**< Capacity multiplier applied when full; 0 keeps the stack fixed-size */
+    int shrinkOnPop;     /**< Non-zero to give memory back when the stack drains to a quarter of capacity */
+    unsigned minCapacity;/**< Capacity the stack never shrinks below on pop */
+#ifdef STACK_STATS
+    struct stackStats* stats; /**< Statistics to record into, or NULL; see stack_stats.h */
+#endif
+};
+
+/**
+ * @brief Initializes a new stack with the given capacity.
+ *
+ * @param cap The capacity of the stack.
+ * @return A pointer to the newly created stack, or NULL if it could not be allocated.
+ */
+struct Stack* initializeStack(unsigned cap);
+
+/**
+ * @brief Initializes a stack that grows instead of rejecting pushes when full.
+ *
+ * @param cap The initial capacity of the stack, also the floor for shrinking.
+ * @param growthFactor The capacity multiplier on overflow; must be greater than 1.
+ * @param shrinkOnPop Non-zero to release memory as the stack drains.
+ * @return A pointer to the newly created stack, or NULL if it could not be allocated.
+ */
+struct Stack* initializeGrowableStack(unsigned cap, double growthFactor, int shrinkOnPop);
+
+/**
+ * @brief Frees a stack and its array.
+ *
+ * @param stack A pointer to the stack, or NULL.
+ */
+void freeStack(struct Stack* stack);
+
+/**
+ * @brief Initializes a stack whose header the caller has already allocated.
+ *
+ * @param stack A pointer to the stack header to initialize.
+ * @param cap The initial capacity of the stack.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @param shrinkOnPop Non-zero to release memory as the stack drains.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initStack(struct Stack* stack, unsigned cap, double growthFactor, int shrinkOnPop);
+
+/**
+ * @brief Frees the array of a stack initialized with initStack(), leaving it empty.
+ *
+ * @param stack A pointer to the stack.
+ */
+void destroyStack(struct Stack* stack);
+
+/**
+ * @brief Ensures the stack can hold at least `cap` elements without reallocating.
+ *
+ * @param stack A pointer to the stack.
+ * @param cap The number of elements to reserve room for.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the allocation failed.
+ */
+StackStatus reserveStack(struct Stack* stack, unsigned cap);
+
+/**
+ * @brief Releases unused capacity so the array holds only the live elements.
+ *
+ * @param stack A pointer to the stack.
+ */
+void shrinkToFit(struct Stack* stack);
+
+/**
+ * @brief Checks if the stack is full.
+ *
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is full, 0 otherwise.
+ */
+int isFull(struct Stack* stack);
+
+/**
+ * @brief Checks if the stack is empty.
+ *
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int isEmpty(struct Stack* stack);
+
+/**
+ * @brief Pushes an item onto the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if a growable stack could not grow.
+ */
+StackStatus push(struct Stack* stack, int item);
+
+/**
+ * @brief Pops an item from the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @return The popped item if the stack is not empty; otherwise, returns INT_MIN.
+ */
+int pop(struct Stack* stack);
+
+/**
+ * @brief Peeks at the top item of the stack without removing it.
+ *
+ * @param stack A pointer to the stack.
+ * @return The top item of the stack if the stack is not empty; otherwise, returns INT_MIN.
+ */
+int peek(struct Stack* stack);
+
+/**
+ * @brief Returns the number of items on the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @return The number of items on the stack.
+ */
+unsigned stackSize(struct Stack* stack);
+
+/**
+ * @brief Pops an item from the stack, reporting an empty stack separately from the item.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus tryPop(struct Stack* stack, int* out);
+
+/**
+ * @brief Reads the top item of the stack, reporting an empty stack separately from the item.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus tryPeek(struct Stack* stack, int* out);
+
+/**
+ * @brief Pops an item from a stack the caller knows is not empty.
+ *
+ * @param stack A pointer to a non-empty stack.
+ * @return The popped item.
+ */
+int popUnchecked(struct Stack* stack);
+
+/**
+ * @brief Reads the top item of a stack the caller knows is not empty.
+ *
+ * @param stack A pointer to a non-empty stack.
+ * @return The top item.
+ */
+int peekUnchecked(struct Stack* stack);
+
+/**
+ * @brief Pushes a run of items onto the stack with a single capacity check.
+ *
+ * @param stack A pointer to the stack.
+ * @param items The items to be pushed; `items[n - 1]` ends up on top.
+ * @param n The number of items.
+ * @return The number of items pushed: `n` on success, 0 if the stack has no room for them.
+ */
+unsigned pushN(struct Stack* stack, const int* items, unsigned n);
+
+/**
+ * @brief Copies up to `n` items from the top of the stack without removing them.
+ *
+ * @param stack A pointer to the stack.
+ * @param out The array receiving the items, top of the stack first.
+ * @param n The maximum number of items to copy.
+ * @return The number of items copied.
+ */
+unsigned peekN(struct Stack* stack, int* out, unsigned n);
+
+/**
+ * @brief Pops up to `n` items from the stack with a single bounds check.
+ *
+ * @param stack A pointer to the stack.
+ * @param out The array receiving the popped items, top of the stack first.
+ * @param n The maximum number of items to pop.
+ * @return The number of items popped.
+ */
+unsigned popN(struct Stack* stack, int* out, unsigned n);
+
+/**
+ * @brief Reverses the stack in place.
+ *
+ * @param stack A pointer to the stack to be reversed.
+ */
+void reverseStack(struct Stack* stack);
+
+/* ---------------------------------------------------------------------------
+ * Linked-list backend
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct node
+ * @brief A structure representing a node in the linked list.
+ * @details Each node contains an integer `data` and a pointer to the next node, `link`.
+ */
+typedef struct node
+{
+    int data;         /**< Integer data of the node */
+    struct node *link; /**< Pointer to the next node in the linked list */
+} Node;
+
+/**
+ * @struct nodePool
+ * @brief A slab allocator handing out nodes without calling malloc or free in steady state.
+ * @details Free nodes are kept on an intrusive list threaded through their `link` field.
+ *          A pool belongs to one thread at a time (or is used under a lock): only
+ *          that thread allocates from it, trims it or frees into it. A node freed
+ *          through another pool, e.g. pushed on one thread and popped on another,
+ *          goes back to its own pool through `remoteFree`, which the owner
+ *          collects the next time it runs out of nodes or is trimmed.
+ */
+typedef struct nodePool
+{
+    Node *freeList;              /**< Nodes ready to be reused, most recently freed first */
+    struct slab *slabs;          /**< All slabs owned by the pool */
+    Node *_Atomic remoteFree;    /**< Nodes handed back by other threads, not yet collected */
+    struct nodePool *nextOrphan; /**< Next pool of an exited thread awaiting adoption */
+} NodePool;
+
+/**
+ * @brief Initializes an empty node pool.
+ * @param pool A pointer to the pool to initialize.
+ */
+void initNodePool(NodePool *pool);
+
+/**
+ * @brief Returns the calling thread's default node pool used by listPush and listPop.
+ * @details The pool is released when the thread exits, or, if some of its nodes
+ *          are still linked into stacks, kept for the next thread to adopt. Such
+ *          an orphan is released as soon as a thread starting or exiting finds
+ *          all its nodes freed, and at the latest when the process exits.
+ * @return A pointer to the thread's pool, or NULL if it could not be allocated.
+ */
+NodePool *threadNodePool(void);
+
+/**
+ * @brief Takes a node from the pool, allocating a new slab only when the pool is exhausted.
+ * @param pool A pointer to the pool.
+ * @return A pointer to an uninitialized node, or NULL if a new slab could not be allocated.
+ */
+Node *poolAlloc(NodePool *pool);
+
+/**
+ * @brief Returns a node to the pool it was allocated from.
+ * @details A node of another pool is handed back to that pool, whichever thread owns it.
+ * @param pool The calling thread's pool, or NULL.
+ * @param node The node to be released.
+ */
+void poolFree(NodePool *pool, Node *node);
+
+/**
+ * @brief Gives every slab without live nodes back to the system allocator.
+ * @param pool A pointer to the pool, or NULL.
+ * @return The number of slabs released.
+ */
+size_t trimNodePool(NodePool *pool);
+
+/**
+ * @brief Releases all slabs of the pool, including nodes still linked into stacks.
+ * @details Every stack holding a node of the pool is left dangling: call this
+ *          only once all of them are dropped, which for the thread's pool means
+ *          every list stack the thread pushed onto, and any other thread's stack
+ *          its nodes were handed to. Otherwise free the stacks with listClear()
+ *          and call trimNodePool(), which keeps the slabs still in use.
+ * @param pool A pointer to the pool, or NULL.
+ */
+void drainNodePool(NodePool *pool);
+
+/**
+ * @brief Creates a new node with a given data value, taken from the thread's node pool.
+ * @param data The integer value to be stored in the node.
+ * @return A pointer to the newly created node, or NULL if no memory was available.
+ */
+Node* createNode(int data);
+
+/**
+ * @brief Pushes an item onto the stack represented by the linked list.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listPush(Node **top_ref, int data);
+
+/**
+ * @brief Pushes an item onto the stack, taking its node from the given pool.
+ * @param pool A pointer to the node pool.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listPushPooled(NodePool *pool, Node **top_ref, int data);
+
+/**
+ * @brief Pushes a run of items onto the stack by splicing a pre-built chain of nodes.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param items The items to be pushed; `items[n - 1]` ends up on top.
+ * @param n The number of items.
+ * @return The number of items pushed: `n` on success, 0 if no memory was available.
+ */
+unsigned listPushN(Node **top_ref, const int *items, unsigned n);
+
+/**
+ * @brief Pops up to `n` items from the stack.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param out The array receiving the popped items, top of the stack first.
+ * @param n The maximum number of items to pop.
+ * @return The number of items popped.
+ */
+unsigned listPopN(Node **top_ref, int *out, unsigned n);
+
+/**
+ * @brief Copies up to `n` items from the top of the stack without removing them.
+ * @param top A pointer to the top of the stack.
+ * @param out The array receiving the items, top of the stack first.
+ * @param n The maximum number of items to copy.
+ * @return The number of items copied.
+ */
+unsigned listPeekN(Node *top, int *out, unsigned n);
+
+/**
+ * @brief Checks if the stack is empty.
+ * @param top A pointer to the top of the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int listIsEmpty(Node *top);
+
+/**
+ * @brief Pops the top element from the stack.
+ * @param top_ref A double pointer to the top of the stack.
+ * @return The value of the popped element. If the stack is empty, returns INT_MIN.
+ */
+int listPop(Node **top_ref);
+
+/**
+ * @brief Pops the top element from the stack, returning its node to the given pool.
+ * @param pool A pointer to the node pool the stack's nodes came from.
+ * @param top_ref A double pointer to the top of the stack.
+ * @return The value of the popped element. If the stack is empty, returns INT_MIN.
+ */
+int listPopPooled(NodePool *pool, Node **top_ref);
+
+/**
+ * @brief Peeks at the top element of the stack without removing it.
+ * @param top A pointer to the top of the stack.
+ * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ */
+int listPeek(Node *top);
+
+/**
+ * @brief Counts the elements of the stack; this walks the whole list.
+ * @param top A pointer to the top of the stack.
+ * @return The number of elements on the stack.
+ */
+size_t listSize(Node *top);
+
+/**
+ * @brief Pops the top element, reporting an empty stack separately from the value.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus listTryPop(Node **top_ref, int *out);
+
+/**
+ * @brief Reads the top element, reporting an empty stack separately from the value.
+ * @param top A pointer to the top of the stack.
+ * @param out Receives the top value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus listTryPeek(Node *top, int *out);
+
+/**
+ * @brief Pops the top element of a stack the caller knows is not empty.
+ * @param top_ref A double pointer to the top of a non-empty stack.
+ * @return The value of the popped element.
+ */
+int listPopUnchecked(Node **top_ref);
+
+/**
+ * @brief Reads the top element of a stack the caller knows is not empty.
+ * @param top A pointer to the top of a non-empty stack.
+ * @return The value of the top element.
+ */
+int listPeekUnchecked(Node *top);
+
+/**
+ * @brief Reverses the stack in place by relinking its nodes.
+ * @param top_ref A double pointer to the top of the stack.
+ */
+void listReverse(Node** top_ref);
+
+/**
+ * @brief Frees every node of the stack, leaving it empty.
+ * @param top_ref A double pointer to the top of the stack.
+ */
+void listClear(Node **top_ref);
+
+/* ---------------------------------------------------------------------------
+ * Unrolled linked-list backend
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @def BLOCK_BYTES
+ * @brief Size of one block of the unrolled list, chosen to match a memory page.
+ */
+#define BLOCK_BYTES 4096
+
+/**
+ * @def BLOCK_ITEMS
+ * @brief Number of elements held by one block after its link and fill count.
+ */
+#define BLOCK_ITEMS ((BLOCK_BYTES - 2 * sizeof(void *)) / sizeof(int))
+
+/**
+ * @struct block
+ * @brief A node of the unrolled linked list holding a whole run of stack elements.
+ * @details Elements are stored bottom to top in `items[0 .. count - 1]`. Every block
+ *          linked into a stack holds at least one element.
+ */
+typedef struct block
+{
+    struct block *link;     /**< Pointer to the block below this one */
+    int count;              /**< Number of elements stored in this block */
+    int items[BLOCK_ITEMS]; /**< Elements of this block, bottom to top */
+} Block;
+
+/**
+ * @struct unrolledStack
+ * @brief An unbounded stack stored as a linked list of blocks.
+ * @details One emptied block is kept as a spare so that a push/pop sequence crossing
+ *          a block boundary does not allocate and free a block on every operation.
+ *          Zero-initialize it to get an empty stack.
+ */
+typedef struct unrolledStack
+{
+    Block *top;   /**< Block holding the top of the stack, NULL when empty */
+    Block *spare; /**< Emptied block kept for the next push, or NULL */
+    size_t size;  /**< Number of elements on the stack */
+} UnrolledStack;
+
+/**
+ * @brief Pushes an item onto the stack.
+ * @param stack A pointer to the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a new block could not be allocated.
+ */
+StackStatus unrolledPush(UnrolledStack *stack, int data);
+
+/**
+ * @brief Checks if the stack is empty.
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int unrolledIsEmpty(UnrolledStack *stack);
+
+/**
+ * @brief Pops the top element from the stack.
+ * @param stack A pointer to the stack.
+ * @return The value of the popped element. If the stack is empty, returns INT_MIN.
+ */
+int unrolledPop(UnrolledStack *stack);
+
+/**
+ * @brief Peeks at the top element of the stack without removing it.
+ * @param stack A pointer to the stack.
+ * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ */
+int unrolledPeek(UnrolledStack *stack);
+
+/**
+ * @brief Returns the number of elements on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of elements on the stack.
+ */
+size_t unrolledSize(UnrolledStack *stack);
+
+/**
+ * @brief Pops the top element, reporting an empty stack separately from the value.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus unrolledTryPop(UnrolledStack *stack, int *out);
+
+/**
+ * @brief Reads the top element, reporting an empty stack separately from the value.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus unrolledTryPeek(UnrolledStack *stack, int *out);
+
+/**
+ * @brief Pops the top element of a stack the caller knows is not empty.
+ * @param stack A pointer to a non-empty stack.
+ * @return The value of the popped element.
+ */
+int unrolledPopUnchecked(UnrolledStack *stack);
+
+/**
+ * @brief Reads the top element of a stack the caller knows is not empty.
+ * @param stack A pointer to a non-empty stack.
+ * @return The value of the top element.
+ */
+int unrolledPeekUnchecked(UnrolledStack *stack);
+
+/**
+ * @brief Reverses the stack in place.
+ * @param stack A pointer to the stack.
+ */
+void unrolledReverse(UnrolledStack *stack);
+
+/**
+ * @brief Frees every block of the stack, leaving it empty.
+ * @param stack A pointer to the stack.
+ */
+void unrolledClear(UnrolledStack *stack);
+
+#endif /* STACK_H */
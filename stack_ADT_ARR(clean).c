@@ -1,54 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
+#include <string.h>
 
-struct Stack {
-    int top;
-    unsigned capacity;
-    int* array;
-};
-
-struct Stack* initializeStack(unsigned cap) {
-    struct Stack* stack = malloc(sizeof(struct Stack));
-    stack->capacity = cap;
-    stack->top = -1;
-    stack->array = malloc(stack->capacity * sizeof(int));
-    return stack;
-}
-
-int isFull(struct Stack* stack) { 
-    return stack->top == (signed int)stack->capacity - 1; 
-}
-
-int isEmpty(struct Stack* stack) { 
-    return stack->top == -1; 
-} 
-
-void push(struct Stack* stack, int item) {
-    if (isFull(stack)) {
-        printf("Stack is Full\n");
-        return;
-    }
-    stack->top++;
-    stack->array[stack->top] = item;
-    printf("%d pushed to stack\n", item);
-}
+#include "stack.h"
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
 
-int pop(struct Stack* stack) {
-    if (isEmpty(stack)) {
-        printf("Stack is Empty\n");
-        return INT_MIN;
-    }
-    int val = stack->array[stack->top];
-    stack->top--;
-    return val;
-}
-
-int peek(struct Stack* stack) { 
-    if (isEmpty(stack)) 
-        return INT_MIN; 
-    return stack->array[stack->top];
-}
+#define INITIAL_STACKS 2
 
 void display(struct Stack* stack) {
     if (isEmpty(stack)) {
@@ -56,50 +15,130 @@ void display(struct Stack* stack) {
         return;
     }
     printf("Stack elements:\n");
-    for (int i = stack->top; i >= 0; i--) {
-        printf("%d\n", stack->array[i]);
-    }
+    fflush(stdout);
+    if (dumpStack(stack, NULL) != STACK_OK)
+        printf("Could not display the stack\n");
 }
 
-void reverseStack(struct Stack* stack) {
-    struct Stack* auxStack1 = initializeStack(stack->capacity);
-    struct Stack* auxStack2 = initializeStack(stack->capacity);
+StackHandle selectStack(StackRegistry* registry, unsigned number, unsigned capacity, double growthFactor) {
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, capacity, growthFactor, &handle) != STACK_OK)
+        return STACK_HANDLE_NONE;
+    return handle;
+}
 
-    while (!isEmpty(stack)) {
-        int item = pop(stack);
-        push(auxStack1, item);
+StackStatus createStacks(StackRegistry* registry, unsigned capacity, double growthFactor) {
+    if (initRegistry(registry, INITIAL_STACKS) != STACK_OK)
+        return STACK_NO_MEMORY;
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++) {
+        if (selectStack(registry, number, capacity, growthFactor) == STACK_HANDLE_NONE) {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
     }
+    return STACK_OK;
+}
 
-    while (!isEmpty(auxStack1)) {
-        int item = pop(auxStack1);
-        push(auxStack2, item);
+int runBatch(const char* path, unsigned capacity, double growthFactor) {
+    StackRegistry registry;
+    BatchRun run;
+    if (createStacks(&registry, capacity, growthFactor) != STACK_OK) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
     }
-
-    while (!isEmpty(auxStack2)) {
-        int item = pop(auxStack2);
-        push(stack, item);
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK) {
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
     }
 
-    free(auxStack1->array);
-    free(auxStack1);
-    free(auxStack2->array);
-    free(auxStack2);
+    BatchCommand command;
+    unsigned current = 1;
+    StackHandle handle = registryFind(&registry, "1");
+    int item;
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT) {
+        struct Stack* stack = registryGet(&registry, handle);
+        switch (command.op) {
+            case BATCH_PUSH:
+                switch (push(stack, command.value)) {
+                    case STACK_OK:
+                        break;
+                    case STACK_FULL:
+                        batchPrintText(&run, "full\n");
+                        break;
+                    default:
+                        batchPrintText(&run, "nomem\n");
+                }
+                break;
+            case BATCH_POP:
+                if (tryPop(stack, &item) == STACK_OK)
+                    batchPrintInt(&run, item);
+                else
+                    batchPrintText(&run, "empty\n");
+                break;
+            case BATCH_PEEK:
+                if (tryPeek(stack, &item) == STACK_OK)
+                    batchPrintInt(&run, item);
+                else
+                    batchPrintText(&run, "empty\n");
+                break;
+            case BATCH_DISPLAY:
+                flushBatch(&run);
+                dumpStack(stack, NULL);
+                break;
+            case BATCH_SWITCH: {
+                unsigned number = command.value == 0 ? current % registryCount(&registry) + 1 : (unsigned)command.value;
+                StackHandle selected = selectStack(&registry, number, capacity, growthFactor);
+                if (selected == STACK_HANDLE_NONE) {
+                    batchPrintText(&run, "nostack\n");
+                } else {
+                    current = number;
+                    handle = selected;
+                }
+                break;
+            }
+            case BATCH_REVERSE:
+                reverseStack(stack);
+                break;
+            default:
+                break;
+        }
+    }
 
-    printf("Stack has been reversed!\n");
+    destroyRegistry(&registry);
+    return closeBatch(&run, status);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     unsigned capacity;
+    double growthFactor;
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        capacity = argc > 3 ? (unsigned)atoi(argv[3]) : 16;
+        growthFactor = argc > 4 ? atof(argv[4]) : 2;
+        return runBatch(argc > 2 ? argv[2] : NULL, capacity, growthFactor);
+    }
+
     printf("Enter the capacity of each stack: ");
     scanf("%u", &capacity);
+    printf("Enter the growth factor (0 for a fixed capacity): ");
+    scanf("%lf", &growthFactor);
 
-    struct Stack* stack1 = initializeStack(capacity);
-    struct Stack* stack2 = initializeStack(capacity);
+    StackRegistry registry;
+    if (createStacks(&registry, capacity, growthFactor) != STACK_OK) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
 
-    int choice, item, stackChoice = 1;
+    int choice, item;
+    unsigned stackChoice = 1;
+    StackHandle handle = registryFind(&registry, "1");
 
     do {
-        printf("\nCurrent Stack: Stack %d\n", stackChoice);
+        printf("\nCurrent Stack: Stack %u of %u\n", stackChoice, registryCount(&registry));
         printf("Menu:\n");
         printf("1. Push\n");
         printf("2. Pop\n");
@@ -111,35 +150,57 @@ int main() {
         printf("Enter your choice: ");
         scanf("%d", &choice);
 
-        struct Stack* currentStack = (stackChoice == 1) ? stack1 : stack2;
+        struct Stack* currentStack = registryGet(&registry, handle);
 
         switch (choice) {
             case 1:
                 printf("Enter item to push: ");
                 scanf("%d", &item);
-                push(currentStack, item);
+                switch (push(currentStack, item)) {
+                    case STACK_OK:
+                        printf("%d pushed to stack\n", item);
+                        break;
+                    case STACK_FULL:
+                        printf("Stack is Full\n");
+                        break;
+                    default:
+                        printf("Memory allocation failed\n");
+                }
                 break;
             case 2:
-                item = pop(currentStack);
-                if (item != INT_MIN) {
+                if (tryPop(currentStack, &item) == STACK_OK) {
                     printf("%d popped from stack\n", item);
+                } else {
+                    printf("Stack is Empty\n");
                 }
                 break;
             case 3:
-                item = peek(currentStack);
-                if (item != INT_MIN) {
+                if (tryPeek(currentStack, &item) == STACK_OK) {
                     printf("Top item is: %d\n", item);
                 }
                 break;
             case 4:
                 display(currentStack);
                 break;
-            case 5:
-                stackChoice = (stackChoice == 1) ? 2 : 1;
-                printf("Switched to Stack %d\n", stackChoice);
+            case 5: {
+                unsigned count = registryCount(&registry), number = 0;
+                printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", count, count + 1);
+                scanf("%u", &number);
+                if (number == 0)
+                    number = stackChoice % count + 1;
+                StackHandle selected = selectStack(&registry, number, capacity, growthFactor);
+                if (selected == STACK_HANDLE_NONE) {
+                    printf("No such stack! Staying with Stack %u\n", stackChoice);
+                } else {
+                    stackChoice = number;
+                    handle = selected;
+                    printf("Switched to Stack %u\n", stackChoice);
+                }
                 break;
+            }
             case 6:
                 reverseStack(currentStack);
+                printf("Stack has been reversed!\n");
                 break;
             case 7:
                 printf("Exiting program...\n");
@@ -149,10 +210,7 @@ int main() {
         }
     } while (choice != 7);
 
-    free(stack1->array);
-    free(stack1);
-    free(stack2->array);
-    free(stack2);
+    destroyRegistry(&registry);
 
     return 0;
 }
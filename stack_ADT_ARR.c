@@ -1,13 +1,18 @@
 /**
- * @file main.c
+ * @file stack_ADT_ARR.c
  * @date 02-01-2025
  * 
  * @brief The program implements a menu-driven stack manipulation system that allows the user to 
  * perform various stack operations including pushing, popping, peeking, displaying the stack, 
- * switching between two stacks, and reversing the stack using two auxiliary stacks.
+ * switching between any number of stacks, and reversing the stack in place.
+ * 
+ * The stacks live in a registry of the stack library (stack_registry.h), under the names
+ * "1", "2", ...; this file only reads the user's choices and prints the results. Build it with
+ * `cc stack_ADT_ARR.c stack.c stack_dump.c stack_batch.c stack_registry.c`; run it as
+ * `stack_ADT_ARR -b [commands file]` to replay a scripted command stream.
  * 
  * This program demonstrates basic stack operations such as push, pop, peek, display, 
- * switching between two stacks, and reversing the stack using auxiliary stacks.
+ * switching between stacks, and reversing the stack in place.
  * 
  * @param cap The `cap` parameter represents the capacity of the stack, which is the maximum number 
  * of elements the stack can hold. It is used to initialize the stack with a specific capacity 
@@ -19,158 +24,157 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
-
-/** 
- * Structure representing a stack.
- */
-struct Stack {
-    int top;             /**< Index of the top element in the stack */
-    unsigned capacity;   /**< Maximum number of elements the stack can hold */
-    int* array;          /**< Pointer to the array holding the stack elements */
-};
+#include <string.h>
 
-/**
- * @brief Initializes a new stack with the given capacity.
- * 
- * Allocates memory for the stack and its array of integers, and sets the 
- * initial values for top and capacity.
- * 
- * @param cap The capacity of the stack.
- * @return A pointer to the newly created stack.
- */
-struct Stack* initializeStack(unsigned cap) {
-    struct Stack* stack = malloc(sizeof(struct Stack));  // Allocate memory for the stack
-    stack->capacity = cap;                               // Set the stack capacity
-    stack->top = -1;                                     // Initialize top to -1 (empty stack)
-    stack->array = malloc(stack->capacity * sizeof(int)); // Allocate memory for the stack array
-    return stack;
-}
+#include "stack.h"
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
 
-/**
- * @brief Checks if the stack is full.
- * 
- * @param stack A pointer to the stack.
- * @return 1 if the stack is full, 0 otherwise.
- */
-int isFull(struct Stack* stack) { 
-    return stack->top == (signed int)stack->capacity - 1; 
-}
-
-/**
- * @brief Checks if the stack is empty.
- * 
- * @param stack A pointer to the stack.
- * @return 1 if the stack is empty, 0 otherwise.
- */
-int isEmpty(struct Stack* stack) { 
-    return stack->top == -1; 
-} 
+#define INITIAL_STACKS 2  /**< Stacks created at startup; more are created on demand */
 
 /**
- * @brief Pushes an item onto the stack.
+ * @brief Displays all the items in the stack.
  * 
- * This function adds an item to the top of the stack if the stack is not full.
+ * This function prints all items in the stack from top to bottom through the
+ * buffered dump routine, which stays fast on very large stacks.
  * 
  * @param stack A pointer to the stack.
- * @param item The item to be pushed onto the stack.
  */
-void push(struct Stack* stack, int item) {
-    if (isFull(stack)) {
-        printf("Stack is Full\n");
+void display(struct Stack* stack) {
+    if (isEmpty(stack)) {
+        printf("Stack is Empty!\n");
         return;
     }
-    stack->top++;                           // Increment the top index
-    stack->array[stack->top] = item;        // Insert the item at the top of the stack
-    printf("%d pushed to stack\n", item);   // Print the pushed item
+    printf("Stack elements:\n");
+    fflush(stdout);  // dumpStack() writes to the descriptor, bypassing stdio
+    if (dumpStack(stack, NULL) != STACK_OK)
+        printf("Could not display the stack\n");
 }
 
 /**
- * @brief Pops an item from the stack.
+ * @brief Finds stack number `number`, creating it if it is the next number to hand out.
  * 
- * This function removes and returns the top item from the stack if it is not empty.
- * 
- * @param stack A pointer to the stack.
- * @return The popped item if the stack is not empty; otherwise, returns INT_MIN.
- */
-int pop(struct Stack* stack) {
-    if (isEmpty(stack)) {
-        printf("Stack is Empty\n");
-        return INT_MIN;  // Return an indicator of an empty stack
-    }
-    int val = stack->array[stack->top];  // Retrieve the top item
-    stack->top--;                        // Decrement the top index
-    return val;                          // Return the popped item
-}
-
-/**
- * @brief Peeks at the top item of the stack without removing it.
+ * Stacks are numbered from 1 in creation order and registered under their number,
+ * so any of them is found in O(1) by name.
  * 
- * @param stack A pointer to the stack.
- * @return The top item of the stack if the stack is not empty; otherwise, returns INT_MIN.
+ * @param registry The registry holding the stacks.
+ * @param number The number of the stack.
+ * @param capacity The capacity of a new stack.
+ * @param growthFactor The growth factor of a new stack; 1 or less keeps it fixed-size.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if there is no such stack
+ *         and it could not be created.
  */
-int peek(struct Stack* stack) { 
-    if (isEmpty(stack)) 
-        return INT_MIN; 
-    return stack->array[stack->top];  // Return the top item without removing it
+StackHandle selectStack(StackRegistry* registry, unsigned number, unsigned capacity, double growthFactor) {
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, capacity, growthFactor, &handle) != STACK_OK)
+        return STACK_HANDLE_NONE;
+    return handle;
 }
 
 /**
- * @brief Displays all the items in the stack.
- * 
- * This function prints all items in the stack from top to bottom.
+ * @brief Creates a registry holding the first INITIAL_STACKS numbered stacks.
  * 
- * @param stack A pointer to the stack.
+ * @param registry The registry to initialize.
+ * @param capacity The capacity of each stack.
+ * @param growthFactor The growth factor of each stack; 1 or less keeps them fixed-size.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the registry or a stack could not be allocated.
  */
-void display(struct Stack* stack) {
-    if (isEmpty(stack)) {
-        printf("Stack is Empty!\n");
-        return;
-    }
-    printf("Stack elements:\n");
-    for (int i = stack->top; i >= 0; i--) {
-        printf("%d\n", stack->array[i]);  // Print each item from top to bottom
+StackStatus createStacks(StackRegistry* registry, unsigned capacity, double growthFactor) {
+    if (initRegistry(registry, INITIAL_STACKS) != STACK_OK)
+        return STACK_NO_MEMORY;
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++) {
+        if (selectStack(registry, number, capacity, growthFactor) == STACK_HANDLE_NONE) {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
     }
+    return STACK_OK;
 }
 
 /**
- * @brief Reverses the stack using two auxiliary stacks.
+ * @brief Runs a scripted command stream against the numbered stacks instead of the menu.
  * 
- * This function reverses the contents of the stack by using two auxiliary stacks.
- * It pops all elements from the original stack and transfers them into two auxiliary stacks
- * in a way that reverses the order of the elements.
+ * Only results are printed: popped and peeked values, rejected pushes and
+ * displays. The stream format is described in stack_batch.h.
  * 
- * @param stack A pointer to the stack to be reversed.
+ * @param path The command file, or NULL for standard input.
+ * @param capacity The capacity of each stack.
+ * @param growthFactor The growth factor of each stack; 1 or less keeps them fixed-size.
+ * @return 0 if the whole stream ran, 1 otherwise.
  */
-void reverseStack(struct Stack* stack) {
-    struct Stack* auxStack1 = initializeStack(stack->capacity);  // First auxiliary stack
-    struct Stack* auxStack2 = initializeStack(stack->capacity);  // Second auxiliary stack
-
-    // Transfer all elements from the original stack to auxStack1
-    while (!isEmpty(stack)) {
-        int item = pop(stack);
-        push(auxStack1, item);
+int runBatch(const char* path, unsigned capacity, double growthFactor) {
+    StackRegistry registry;
+    BatchRun run;
+    if (createStacks(&registry, capacity, growthFactor) != STACK_OK) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
     }
-
-    // Transfer all elements from auxStack1 to auxStack2
-    while (!isEmpty(auxStack1)) {
-        int item = pop(auxStack1);
-        push(auxStack2, item);
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK) {
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
     }
 
-    // Transfer all elements from auxStack2 back to the original stack
-    while (!isEmpty(auxStack2)) {
-        int item = pop(auxStack2);
-        push(stack, item);
+    BatchCommand command;
+    unsigned current = 1;
+    StackHandle handle = registryFind(&registry, "1");
+    int item;
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT) {
+        struct Stack* stack = registryGet(&registry, handle);
+        switch (command.op) {
+            case BATCH_PUSH:
+                switch (push(stack, command.value)) {
+                    case STACK_OK:
+                        break;
+                    case STACK_FULL:
+                        batchPrintText(&run, "full\n");
+                        break;
+                    default:
+                        batchPrintText(&run, "nomem\n");
+                }
+                break;
+            case BATCH_POP:
+                if (tryPop(stack, &item) == STACK_OK)
+                    batchPrintInt(&run, item);
+                else
+                    batchPrintText(&run, "empty\n");
+                break;
+            case BATCH_PEEK:
+                if (tryPeek(stack, &item) == STACK_OK)
+                    batchPrintInt(&run, item);
+                else
+                    batchPrintText(&run, "empty\n");
+                break;
+            case BATCH_DISPLAY:
+                flushBatch(&run);
+                dumpStack(stack, NULL);
+                break;
+            case BATCH_SWITCH: {
+                unsigned number = command.value == 0 ? current % registryCount(&registry) + 1 : (unsigned)command.value;
+                StackHandle selected = selectStack(&registry, number, capacity, growthFactor);
+                if (selected == STACK_HANDLE_NONE) {
+                    batchPrintText(&run, "nostack\n");
+                } else {
+                    current = number;
+                    handle = selected;
+                }
+                break;
+            }
+            case BATCH_REVERSE:
+                reverseStack(stack);
+                break;
+            default:
+                break;
+        }
     }
 
-    // Free dynamically allocated memory for the auxiliary stacks
-    free(auxStack1->array);
-    free(auxStack1);
-    free(auxStack2->array);
-    free(auxStack2);
-
-    printf("Stack has been reversed!\n");
+    destroyRegistry(&registry);
+    return closeBatch(&run, status);
 }
 
 /**
@@ -178,22 +182,37 @@ void reverseStack(struct Stack* stack) {
  * 
  * The main function provides a menu-driven interface to the user, allowing them to perform
  * various stack operations such as pushing, popping, peeking, displaying, switching between
- * two stacks, and reversing the stack. The program runs in a loop until the user chooses to exit.
+ * any number of stacks, and reversing the stack. The program runs in a loop until the user chooses to exit.
  * 
  * @return 0 upon successful execution.
  */
-int main() {
+int main(int argc, char* argv[]) {
     unsigned capacity;
+    double growthFactor;
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        // Batch mode: -b [commands file] [capacity (16)] [growth factor (2)]
+        capacity = argc > 3 ? (unsigned)atoi(argv[3]) : 16;
+        growthFactor = argc > 4 ? atof(argv[4]) : 2;
+        return runBatch(argc > 2 ? argv[2] : NULL, capacity, growthFactor);
+    }
+
     printf("Enter the capacity of each stack: ");
     scanf("%u", &capacity);
+    printf("Enter the growth factor (0 for a fixed capacity): ");
+    scanf("%lf", &growthFactor);
 
-    struct Stack* stack1 = initializeStack(capacity);  // Initialize stack1
-    struct Stack* stack2 = initializeStack(capacity);  // Initialize stack2
+    StackRegistry registry;
+    if (createStacks(&registry, capacity, growthFactor) != STACK_OK) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
 
-    int choice, item, stackChoice = 1;  // Default to stack1
+    int choice, item;
+    unsigned stackChoice = 1;  // Default to stack 1
+    StackHandle handle = registryFind(&registry, "1");
 
     do {
-        printf("\nCurrent Stack: Stack %d\n", stackChoice);
+        printf("\nCurrent Stack: Stack %u of %u\n", stackChoice, registryCount(&registry));
         printf("Menu:\n");
         printf("1. Push\n");
         printf("2. Pop\n");
@@ -205,36 +224,58 @@ int main() {
         printf("Enter your choice: ");
         scanf("%d", &choice);
 
-        struct Stack* currentStack = (stackChoice == 1) ? stack1 : stack2;  // Select current stack
+        struct Stack* currentStack = registryGet(&registry, handle);  // Select current stack
 
         switch (choice) {
             case 1:
                 printf("Enter item to push: ");
                 scanf("%d", &item);
-                push(currentStack, item);
+                switch (push(currentStack, item)) {
+                    case STACK_OK:
+                        printf("%d pushed to stack\n", item);
+                        break;
+                    case STACK_FULL:
+                        printf("Stack is Full\n");
+                        break;
+                    default:
+                        printf("Memory allocation failed\n");
+                }
                 break;
             case 2:
-                item = pop(currentStack);
-                if (item != INT_MIN) {
+                if (tryPop(currentStack, &item) == STACK_OK) {
                     printf("%d popped from stack\n", item);
+                } else {
+                    printf("Stack is Empty\n");
                 }
                 break;
             case 3:
-                item = peek(currentStack);
-                if (item != INT_MIN) {
+                if (tryPeek(currentStack, &item) == STACK_OK) {
                     printf("Top item is: %d\n", item);
                 }
                 break;
             case 4:
                 display(currentStack);
                 break;
-            case 5:
-                // Switch between stack1 and stack2
-                stackChoice = (stackChoice == 1) ? 2 : 1;
-                printf("Switched to Stack %d\n", stackChoice);
+            case 5: {
+                // Any existing stack, the next one after the last to create it, or 0 to cycle
+                unsigned count = registryCount(&registry), number = 0;
+                printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", count, count + 1);
+                scanf("%u", &number);
+                if (number == 0)
+                    number = stackChoice % count + 1;
+                StackHandle selected = selectStack(&registry, number, capacity, growthFactor);
+                if (selected == STACK_HANDLE_NONE) {
+                    printf("No such stack! Staying with Stack %u\n", stackChoice);
+                } else {
+                    stackChoice = number;
+                    handle = selected;
+                    printf("Switched to Stack %u\n", stackChoice);
+                }
                 break;
+            }
             case 6:
                 reverseStack(currentStack);
+                printf("Stack has been reversed!\n");
                 break;
             case 7:
                 printf("Exiting program...\n");
@@ -244,11 +285,8 @@ int main() {
         }
     } while (choice != 7);
 
-    // Free dynamically allocated memory for stacks
-    free(stack1->array);
-    free(stack1);
-    free(stack2->array);
-    free(stack2);
+    // Free every stack and the registry in one pass
+    destroyRegistry(&registry);
 
     return 0;
 }
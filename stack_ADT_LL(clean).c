@@ -1,33 +1,48 @@
 #include <stdio.h>
-#include <stdlib.h>
-#include <limits.h>
+#include <string.h>
+
+#include "stack.h"
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
+
+#define INITIAL_STACKS 2
 
-typedef struct node
-{
-    int data;
-    struct node *link;
-} Node;
-
-Node* createNode(int data);
-int push(Node **top_ref, int data);
-int isEmpty(Node *top);
-int pop(Node **top_ref);
-int peek(Node *top);
 void display(Node *top);
-void reverse(Node** top_ref);
 
-int main()
+StackHandle selectStack(StackRegistry *registry, unsigned number);
+
+StackStatus createStacks(StackRegistry *registry);
+
+void freeStacks(StackRegistry *registry);
+
+int runBatch(const char *path);
+
+int main(int argc, char *argv[])
 {
-    Node *top1 = NULL;
-    Node *top2 = NULL;
-    Node **active = &top1;
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    Node **active;
     int choice;
     int value;
-    int stackChoice;
+    unsigned stackChoice;
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return runBatch(argc > 2 ? argv[2] : NULL);
+    }
+    if (createStacks(&registry) != STACK_OK)
+    {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
 
     do
     {
-        printf("Current Stack: %s\n", active == &top1 ? "Stack 1" : "Stack 2");
+        active = registryGetList(&registry, handle);
+        printf("Current Stack: Stack %u of %u\n", current, registryCount(&registry));
         printf("1. Push\n");
         printf("2. Pop\n");
         printf("3. Peek\n");
@@ -43,12 +58,14 @@ int main()
         case 1:
             printf("Enter element to be pushed: ");
             scanf("%d", &value);
-            push(active, value);
+            if (listPush(active, value) != STACK_OK)
+            {
+                printf("Memory allocation failed\n");
+            }
             break;
 
         case 2:
-            value = pop(active);
-            if (value != INT_MIN)
+            if (listTryPop(active, &value) == STACK_OK)
             {
                 printf("Popped Element: %d\n", value);
             }
@@ -59,8 +76,7 @@ int main()
             break;
 
         case 3:
-            value = peek(*active);
-            if (value != INT_MIN)
+            if (listTryPeek(*active, &value) == STACK_OK)
             {
                 printf("Top Element: %d\n", value);
             }
@@ -75,30 +91,44 @@ int main()
             break;
 
         case 5:
-            printf("Switch to:\n1. Stack 1\n2. Stack 2\nEnter your choice: ");
-            scanf("%d", &stackChoice);
-            if (stackChoice == 1)
+        {
+            printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", registryCount(&registry),
+                   registryCount(&registry) + 1);
+            stackChoice = 0;
+            scanf("%u", &stackChoice);
+            if (stackChoice == 0)
             {
-                active = &top1;
-                printf("Switched to Stack 1.\n");
+                stackChoice = current % registryCount(&registry) + 1;
             }
-            else if (stackChoice == 2)
+            StackHandle selected = selectStack(&registry, stackChoice);
+            if (selected == STACK_HANDLE_NONE)
             {
-                active = &top2;
-                printf("Switched to Stack 2.\n");
+                printf("Invalid choice! Staying with the current stack.\n");
             }
             else
             {
-                printf("Invalid choice! Staying with the current stack.\n");
+                current = stackChoice;
+                handle = selected;
+                printf("Switched to Stack %u.\n", current);
             }
             break;
+        }
 
         case 6:
-            reverse(active);
+            if (listIsEmpty(*active))
+            {
+                printf("Cannot reverse an empty Stack!\n");
+            }
+            else
+            {
+                listReverse(active);
+                printf("Reversed Successfully!\n");
+            }
             break;
 
         case 7:
             printf("Exiting...\n");
+            freeStacks(&registry);
             break;
 
         default:
@@ -109,99 +139,145 @@ int main()
     return 0;
 }
 
-Node *createNode(int data)
+void display(Node *top)
 {
-    Node *newNode = malloc(sizeof(Node));
-    if (!newNode)
+    if (listIsEmpty(top))
     {
-        printf("Memory allocation failed\n");
-        exit(1);
+        printf("Stack is Empty\n");
+        return;
     }
-    newNode->data = data;
-    newNode->link = NULL;
-    return newNode;
-}
 
-int push(Node **top_ref, int data)
-{
-    Node *new = createNode(data);
-    new->link = *top_ref;
-    *top_ref = new;
-    return 1;
-}
-
-int pop(Node **top_ref)
-{
-    if (*top_ref == NULL)
+    fflush(stdout);
+    if (listDump(top, NULL) != STACK_OK)
     {
-        return INT_MIN;
+        printf("Could not display the stack\n");
     }
-    int val = (*top_ref)->data;
-    Node *temp = *top_ref;
-    *top_ref = (*top_ref)->link;
-    free(temp);
-    return val;
-}
-
-int isEmpty(Node *top)
-{
-    return top == NULL;
+    printf("\n");
 }
 
-int peek(Node *top)
+StackHandle selectStack(StackRegistry *registry, unsigned number)
 {
-    if (isEmpty(top))
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, 0, 0, &handle) != STACK_OK)
     {
-        return INT_MIN;
+        return STACK_HANDLE_NONE;
     }
-    return top->data;
+    return handle;
 }
 
-void display(Node *top)
+StackStatus createStacks(StackRegistry *registry)
 {
-    if (isEmpty(top))
+    if (initRegistryOf(registry, STACK_BACKEND_LIST, INITIAL_STACKS) != STACK_OK)
     {
-        printf("Stack is Empty\n");
-        return;
+        return STACK_NO_MEMORY;
     }
-
-    Node *temp = top;
-    while (temp != NULL)
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++)
     {
-        printf("%d\n", temp->data);
-        temp = temp->link;
+        if (selectStack(registry, number) == STACK_HANDLE_NONE)
+        {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
     }
-    printf("\n");
+    return STACK_OK;
 }
 
-void reverse(Node** top_ref)
+void freeStacks(StackRegistry *registry)
 {
-    if (*top_ref == NULL)
-    {
-        printf("Cannot reverse an empty Stack!\n");
-        return;
-    }
+    destroyRegistry(registry);
+    trimNodePool(threadNodePool());
+}
 
-    Node* aux1 = NULL;
-    Node* aux2 = NULL;
+int runBatch(const char *path)
+{
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    BatchRun run;
+    BatchCommand command;
+    int value;
 
-    while (*top_ref != NULL)
+    if (createStacks(&registry) != STACK_OK)
     {
-        int value = pop(top_ref);
-        push(&aux1, value);
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
     }
-
-    while (aux1 != NULL)
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK)
     {
-        int value = pop(&aux1);
-        push(&aux2, value);
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
     }
+    handle = registryFind(&registry, "1");
 
-    while (aux2 != NULL)
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT)
     {
-        int value = pop(&aux2);
-        push(top_ref, value);
+        Node **top = registryGetList(&registry, handle);
+        switch (command.op)
+        {
+        case BATCH_PUSH:
+            if (listPush(top, command.value) != STACK_OK)
+            {
+                batchPrintText(&run, "nomem\n");
+            }
+            break;
+
+        case BATCH_POP:
+            if (listTryPop(top, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_PEEK:
+            if (listTryPeek(*top, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_DISPLAY:
+            flushBatch(&run);
+            listDump(*top, NULL);
+            break;
+
+        case BATCH_SWITCH:
+        {
+            unsigned number = command.value ? (unsigned)command.value : current % registryCount(&registry) + 1;
+            StackHandle selected = selectStack(&registry, number);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                batchPrintText(&run, "nostack\n");
+            }
+            else
+            {
+                current = number;
+                handle = selected;
+            }
+            break;
+        }
+
+        case BATCH_REVERSE:
+            listReverse(top);
+            break;
+
+        default:
+            break;
+        }
     }
 
-    printf("Reversed Successfully!\n");
+    freeStacks(&registry);
+    return closeBatch(&run, status);
 }
@@ -1,85 +1,80 @@
 #include <stdio.h>
-#include <stdlib.h>
-#include <limits.h>  // For INT_MIN
+#include <string.h>
 
-/**
- * @struct node
- * @brief A structure representing a node in the linked list.
- * @details Each node contains an integer `data` and a pointer to the next node, `link`.
- */
-typedef struct node
-{
-    int data;         /**< Integer data of the node */
-    struct node *link; /**< Pointer to the next node in the linked list */
-} Node;
+#include "stack.h"   // Linked-list stack library; build with `cc stack_ADT_LL.c stack.c stack_dump.c stack_batch.c stack_registry.c`
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
 
-/**
- * @brief Creates a new node with a given data value.
- * @param data The integer value to be stored in the node.
- * @return A pointer to the newly created node.
- */
-Node* createNode(int data);
+#define INITIAL_STACKS 2 /**< Stacks created at startup; more are created on demand */
 
 /**
- * @brief Pushes an item onto the stack represented by the linked list.
- * @param top_ref A double pointer to the top of the stack.
- * @param data The integer value to be pushed onto the stack.
- * @return 1 if the push operation was successful.
- */
-int push(Node **top_ref, int data);
-
-/**
- * @brief Checks if the stack is empty.
+ * @brief Displays all elements in the stack.
  * @param top A pointer to the top of the stack.
- * @return 1 if the stack is empty, 0 otherwise.
  */
-int isEmpty(Node *top);
+void display(Node *top);
 
 /**
- * @brief Pops the top element from the stack.
- * @param top_ref A double pointer to the top of the stack.
- * @return The value of the popped element. If the stack is empty, returns INT_MIN.
+ * @brief Finds stack number `number`, creating it if it is the next number to hand out.
+ * @param registry The registry holding the stacks under the names "1", "2", ...
+ * @param number The number of the stack, counting from 1.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if there is no such stack and it could not be created.
  */
-int pop(Node **top_ref);
+StackHandle selectStack(StackRegistry *registry, unsigned number);
 
 /**
- * @brief Peeks at the top element of the stack without removing it.
- * @param top A pointer to the top of the stack.
- * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ * @brief Creates a registry holding the first INITIAL_STACKS numbered stacks.
+ * @param registry The registry to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the registry could not be allocated.
  */
-int peek(Node *top);
+StackStatus createStacks(StackRegistry *registry);
 
 /**
- * @brief Displays all elements in the stack.
- * @param top A pointer to the top of the stack.
+ * @brief Frees the nodes of every stack and the registry.
+ * @param registry The registry holding the stacks.
  */
-void display(Node *top);
+void freeStacks(StackRegistry *registry);
 
 /**
- * @brief Reverses the stack using two auxiliary stacks.
- * @param top_ref A double pointer to the top of the stack.
+ * @brief Runs a scripted command stream against the numbered stacks instead of the menu.
+ * @details Only results are printed; the stream format is described in stack_batch.h.
+ * @param path The command file, or NULL for standard input.
+ * @return 0 if the whole stream ran, 1 otherwise.
  */
-void reverse(Node** top_ref);
+int runBatch(const char *path);
 
 /**
  * @brief Main function to drive the menu and stack operations.
- * @details It initializes two stacks and allows the user to perform various operations like push, pop, peek, display,
- *          switch between stacks, and reverse the stack.
+ * @details It starts with two stacks and allows the user to perform various operations like push, pop, peek, display,
+ *          switch between stacks or to a new one, and reverse the stack.
  * @return 0 to indicate successful execution of the program.
  */
-int main()
+int main(int argc, char *argv[])
 {
-    Node *top1 = NULL; /**< Stack 1 */
-    Node *top2 = NULL; /**< Stack 2 */
-    Node **active = &top1; /**< Pointer to the active stack (default Stack 1) */
+    StackRegistry registry; /**< The stacks, named by their number */
+    unsigned current = 1; /**< Number of the active stack (default Stack 1) */
+    StackHandle handle; /**< Handle of the active stack */
+    Node **active; /**< Top of the active stack */
     int choice; /**< User choice for the menu */
     int value; /**< Value to be pushed or popped */
-    int stackChoice; /**< Stack choice for switching between Stack 1 and Stack 2 */
+    unsigned stackChoice; /**< Stack number to switch to */
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return runBatch(argc > 2 ? argv[2] : NULL); // Batch mode: -b [commands file]
+    }
+    if (createStacks(&registry) != STACK_OK)
+    {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
 
     do
     {
         // Display the current active stack
-        printf("Current Stack: %s\n", active == &top1 ? "Stack 1" : "Stack 2");
+        active = registryGetList(&registry, handle);
+        printf("Current Stack: Stack %u of %u\n", current, registryCount(&registry));
         printf("1. Push\n");
         printf("2. Pop\n");
         printf("3. Peek\n");
@@ -96,13 +91,15 @@ int main()
             // Push element onto the current active stack
             printf("Enter element to be pushed: ");
             scanf("%d", &value);
-            push(active, value);
+            if (listPush(active, value) != STACK_OK)
+            {
+                printf("Memory allocation failed\n");
+            }
             break;
 
         case 2:
             // Pop element from the current active stack
-            value = pop(active);
-            if (value != INT_MIN)
+            if (listTryPop(active, &value) == STACK_OK)
             {
                 printf("Popped Element: %d\n", value);
             }
@@ -114,8 +111,7 @@ int main()
 
         case 3:
             // Peek the top element of the current active stack
-            value = peek(*active);
-            if (value != INT_MIN)
+            if (listTryPeek(*active, &value) == STACK_OK)
             {
                 printf("Top Element: %d\n", value);
             }
@@ -131,32 +127,46 @@ int main()
             break;
 
         case 5:
-            // Switch between Stack 1 and Stack 2
-            printf("Switch to:\n1. Stack 1\n2. Stack 2\nEnter your choice: ");
-            scanf("%d", &stackChoice);
-            if (stackChoice == 1)
+        {
+            // Switch to any stack, to a new one after the last, or to the next one
+            printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", registryCount(&registry),
+                   registryCount(&registry) + 1);
+            stackChoice = 0;
+            scanf("%u", &stackChoice);
+            if (stackChoice == 0)
             {
-                active = &top1;
-                printf("Switched to Stack 1.\n");
+                stackChoice = current % registryCount(&registry) + 1;
             }
-            else if (stackChoice == 2)
+            StackHandle selected = selectStack(&registry, stackChoice);
+            if (selected == STACK_HANDLE_NONE)
             {
-                active = &top2;
-                printf("Switched to Stack 2.\n");
+                printf("Invalid choice! Staying with the current stack.\n");
             }
             else
             {
-                printf("Invalid choice! Staying with the current stack.\n");
+                current = stackChoice;
+                handle = selected;
+                printf("Switched to Stack %u.\n", current);
             }
             break;
+        }
 
         case 6:
             // Reverse the current active stack
-            reverse(active);
+            if (listIsEmpty(*active))
+            {
+                printf("Cannot reverse an empty Stack!\n");
+            }
+            else
+            {
+                listReverse(active);
+                printf("Reversed Successfully!\n");
+            }
             break;
 
         case 7:
             printf("Exiting...\n");
+            freeStacks(&registry);
             break;
 
         default:
@@ -168,135 +178,171 @@ int main()
 }
 
 /**
- * @brief Creates a new node with the given data value.
- * @param data The integer value to be stored in the node.
- * @return A pointer to the newly created node.
+ * @brief Displays all elements of the stack.
+ * @param top A pointer to the top of the stack.
  */
-Node *createNode(int data)
+void display(Node *top)
 {
-    Node *newNode = malloc(sizeof(Node));
-    if (!newNode)
+    if (listIsEmpty(top))
     {
-        printf("Memory allocation failed\n");
-        exit(1);
+        printf("Stack is Empty\n");
+        return;
     }
-    newNode->data = data;
-    newNode->link = NULL;
-    return newNode;
-}
 
-/**
- * @brief Pushes a new node with data onto the stack.
- * @param top_ref A double pointer to the top of the stack.
- * @param data The data to be pushed onto the stack.
- * @return 1 if the push operation is successful.
- */
-int push(Node **top_ref, int data)
-{
-    Node *new = createNode(data);
-    new->link = *top_ref;
-    *top_ref = new;
-    return 1;
+    fflush(stdout); // listDump() writes to the descriptor, bypassing stdio
+    if (listDump(top, NULL) != STACK_OK)
+    {
+        printf("Could not display the stack\n");
+    }
+    printf("\n");
 }
 
 /**
- * @brief Pops the top node from the stack.
- * @param top_ref A double pointer to the top of the stack.
- * @return The data of the popped node. If the stack is empty, returns INT_MIN.
+ * @brief Finds stack number `number`, creating it if it is the next number to hand out.
+ * @details Stacks are numbered from 1 in creation order and registered under their number,
+ *          so any of them is found in O(1) by name.
+ * @param registry The registry holding the stacks under the names "1", "2", ...
+ * @param number The number of the stack, counting from 1.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if there is no such stack and it could not be created.
  */
-int pop(Node **top_ref)
+StackHandle selectStack(StackRegistry *registry, unsigned number)
 {
-    if (*top_ref == NULL)
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, 0, 0, &handle) != STACK_OK)
     {
-        return INT_MIN; // Return INT_MIN if the stack is empty
+        return STACK_HANDLE_NONE;
     }
-    int val = (*top_ref)->data;
-    Node *temp = *top_ref;
-    *top_ref = (*top_ref)->link;
-    free(temp);
-    return val;
+    return handle;
 }
 
 /**
- * @brief Checks if the stack is empty.
- * @param top A pointer to the top of the stack.
- * @return 1 if the stack is empty, 0 otherwise.
+ * @brief Creates a registry holding the first INITIAL_STACKS numbered stacks.
+ * @param registry The registry to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the registry could not be allocated.
  */
-int isEmpty(Node *top)
+StackStatus createStacks(StackRegistry *registry)
 {
-    return top == NULL;
+    if (initRegistryOf(registry, STACK_BACKEND_LIST, INITIAL_STACKS) != STACK_OK)
+    {
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++)
+    {
+        if (selectStack(registry, number) == STACK_HANDLE_NONE)
+        {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
+    }
+    return STACK_OK;
 }
 
 /**
- * @brief Peeks at the top element of the stack without removing it.
- * @param top A pointer to the top of the stack.
- * @return The value of the top element. If the stack is empty, returns INT_MIN.
+ * @brief Frees the nodes of every stack and the registry.
+ * @param registry The registry holding the stacks.
  */
-int peek(Node *top)
+void freeStacks(StackRegistry *registry)
 {
-    if (isEmpty(top))
-    {
-        return INT_MIN; // Return INT_MIN if the stack is empty
-    }
-    return top->data;
+    destroyRegistry(registry);
+    trimNodePool(threadNodePool()); // The emptied slabs go back to the system
 }
 
 /**
- * @brief Displays all elements of the stack.
- * @param top A pointer to the top of the stack.
+ * @brief Runs a scripted command stream against the numbered stacks instead of the menu.
+ * @details Only results are printed; the stream format is described in stack_batch.h.
+ * @param path The command file, or NULL for standard input.
+ * @return 0 if the whole stream ran, 1 otherwise.
  */
-void display(Node *top)
+int runBatch(const char *path)
 {
-    if (isEmpty(top))
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    BatchRun run;
+    BatchCommand command;
+    int value;
+
+    if (createStacks(&registry) != STACK_OK)
     {
-        printf("Stack is Empty\n");
-        return;
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
     }
-
-    Node *temp = top;
-    while (temp != NULL)
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK)
     {
-        printf("%d\n", temp->data);
-        temp = temp->link;
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
     }
-    printf("\n");
-}
+    handle = registryFind(&registry, "1");
 
-/**
- * @brief Reverses the stack using two auxiliary stacks.
- * @param top_ref A double pointer to the top of the stack.
- */
-void reverse(Node** top_ref)
-{
-    if (*top_ref == NULL)
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT)
     {
-        printf("Cannot reverse an empty Stack!\n");
-        return;
-    }
+        Node **top = registryGetList(&registry, handle);
+        switch (command.op)
+        {
+        case BATCH_PUSH:
+            if (listPush(top, command.value) != STACK_OK)
+            {
+                batchPrintText(&run, "nomem\n");
+            }
+            break;
 
-    Node* aux1 = NULL;
-    Node* aux2 = NULL;
+        case BATCH_POP:
+            if (listTryPop(top, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
 
-    // Transfer all elements from original stack to aux1
-    while (*top_ref != NULL)
-    {
-        int value = pop(top_ref);
-        push(&aux1, value);
-    }
+        case BATCH_PEEK:
+            if (listTryPeek(*top, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
 
-    // Transfer all elements from aux1 to aux2
-    while (aux1 != NULL)
-    {
-        int value = pop(&aux1);
-        push(&aux2, value);
-    }
+        case BATCH_DISPLAY:
+            flushBatch(&run);
+            listDump(*top, NULL);
+            break;
 
-    // Transfer all elements from aux2 back to the original stack
-    while (aux2 != NULL)
-    {
-        int value = pop(&aux2);
-        push(top_ref, value);
+        case BATCH_SWITCH:
+        {
+            unsigned number = command.value ? (unsigned)command.value : current % registryCount(&registry) + 1;
+            StackHandle selected = selectStack(&registry, number);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                batchPrintText(&run, "nostack\n");
+            }
+            else
+            {
+                current = number;
+                handle = selected;
+            }
+            break;
+        }
+
+        case BATCH_REVERSE:
+            listReverse(top);
+            break;
+
+        default:
+            break;
+        }
     }
 
-    printf("Reversed Successfully!\n");
+    freeStacks(&registry);
+    return closeBatch(&run, status);
 }
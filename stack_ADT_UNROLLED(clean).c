@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "stack.h"
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
+
+#define INITIAL_STACKS 2
+
+void display(UnrolledStack *stack);
+
+StackHandle selectStack(StackRegistry *registry, unsigned number);
+
+StackStatus createStacks(StackRegistry *registry);
+
+int runBatch(const char *path);
+
+int main(int argc, char *argv[])
+{
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    UnrolledStack *active;
+    int choice;
+    int value;
+    unsigned stackChoice;
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return runBatch(argc > 2 ? argv[2] : NULL);
+    }
+    if (createStacks(&registry) != STACK_OK)
+    {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
+
+    do
+    {
+        active = registryGetUnrolled(&registry, handle);
+        printf("Current Stack: Stack %u of %u\n", current, registryCount(&registry));
+        printf("1. Push\n");
+        printf("2. Pop\n");
+        printf("3. Peek\n");
+        printf("4. Display\n");
+        printf("5. Switch Stack\n");
+        printf("6. Reverse\n");
+        printf("7. Exit\n\n");
+        printf("Enter your choice: ");
+        scanf("%d", &choice);
+
+        switch (choice)
+        {
+        case 1:
+            printf("Enter element to be pushed: ");
+            scanf("%d", &value);
+            if (unrolledPush(active, value) != STACK_OK)
+            {
+                printf("Memory allocation failed\n");
+            }
+            break;
+
+        case 2:
+            if (unrolledTryPop(active, &value) == STACK_OK)
+            {
+                printf("Popped Element: %d\n", value);
+            }
+            else
+            {
+                printf("Stack is Empty! Cannot pop.\n");
+            }
+            break;
+
+        case 3:
+            if (unrolledTryPeek(active, &value) == STACK_OK)
+            {
+                printf("Top Element: %d\n", value);
+            }
+            else
+            {
+                printf("Stack is Empty! Cannot peek.\n");
+            }
+            break;
+
+        case 4:
+            display(active);
+            break;
+
+        case 5:
+        {
+            printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", registryCount(&registry),
+                   registryCount(&registry) + 1);
+            stackChoice = 0;
+            scanf("%u", &stackChoice);
+            if (stackChoice == 0)
+            {
+                stackChoice = current % registryCount(&registry) + 1;
+            }
+            StackHandle selected = selectStack(&registry, stackChoice);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                printf("Invalid choice! Staying with the current stack.\n");
+            }
+            else
+            {
+                current = stackChoice;
+                handle = selected;
+                printf("Switched to Stack %u.\n", current);
+            }
+            break;
+        }
+
+        case 6:
+            if (unrolledIsEmpty(active))
+            {
+                printf("Cannot reverse an empty Stack!\n");
+            }
+            else
+            {
+                unrolledReverse(active);
+                printf("Reversed Successfully!\n");
+            }
+            break;
+
+        case 7:
+            printf("Exiting...\n");
+            destroyRegistry(&registry);
+            break;
+
+        default:
+            printf("Invalid Choice! Try Again!\n");
+        }
+    } while (choice != 7);
+
+    return 0;
+}
+
+void display(UnrolledStack *stack)
+{
+    if (unrolledIsEmpty(stack))
+    {
+        printf("Stack is Empty\n");
+        return;
+    }
+
+    fflush(stdout);
+    if (unrolledDump(stack, NULL) != STACK_OK)
+    {
+        printf("Could not display the stack\n");
+    }
+    printf("\n");
+}
+
+StackHandle selectStack(StackRegistry *registry, unsigned number)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, 0, 0, &handle) != STACK_OK)
+    {
+        return STACK_HANDLE_NONE;
+    }
+    return handle;
+}
+
+StackStatus createStacks(StackRegistry *registry)
+{
+    if (initRegistryOf(registry, STACK_BACKEND_UNROLLED, INITIAL_STACKS) != STACK_OK)
+    {
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++)
+    {
+        if (selectStack(registry, number) == STACK_HANDLE_NONE)
+        {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
+    }
+    return STACK_OK;
+}
+
+int runBatch(const char *path)
+{
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    BatchRun run;
+    BatchCommand command;
+    int value;
+
+    if (createStacks(&registry) != STACK_OK)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK)
+    {
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
+
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT)
+    {
+        UnrolledStack *active = registryGetUnrolled(&registry, handle);
+        switch (command.op)
+        {
+        case BATCH_PUSH:
+            if (unrolledPush(active, command.value) != STACK_OK)
+            {
+                batchPrintText(&run, "nomem\n");
+            }
+            break;
+
+        case BATCH_POP:
+            if (unrolledTryPop(active, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_PEEK:
+            if (unrolledTryPeek(active, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_DISPLAY:
+            flushBatch(&run);
+            unrolledDump(active, NULL);
+            break;
+
+        case BATCH_SWITCH:
+        {
+            unsigned number = command.value ? (unsigned)command.value : current % registryCount(&registry) + 1;
+            StackHandle selected = selectStack(&registry, number);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                batchPrintText(&run, "nostack\n");
+            }
+            else
+            {
+                current = number;
+                handle = selected;
+            }
+            break;
+        }
+
+        case BATCH_REVERSE:
+            unrolledReverse(active);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    destroyRegistry(&registry);
+    return closeBatch(&run, status);
+}
@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "stack.h"   // Unrolled stack library; build with `cc stack_ADT_UNROLLED.c stack.c stack_dump.c stack_batch.c stack_registry.c`
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "stack_registry.h"
+
+#define INITIAL_STACKS 2 /**< Stacks created at startup; more are created on demand */
+
+/**
+ * @brief Displays all elements in the stack.
+ * @param stack A pointer to the stack.
+ */
+void display(UnrolledStack *stack);
+
+/**
+ * @brief Finds stack number `number`, creating it if it is the next number to hand out.
+ * @param registry The registry holding the stacks under the names "1", "2", ...
+ * @param number The number of the stack, counting from 1.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if there is no such stack and it could not be created.
+ */
+StackHandle selectStack(StackRegistry *registry, unsigned number);
+
+/**
+ * @brief Creates a registry holding the first INITIAL_STACKS numbered stacks.
+ * @param registry The registry to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the registry could not be allocated.
+ */
+StackStatus createStacks(StackRegistry *registry);
+
+/**
+ * @brief Runs a scripted command stream against the numbered stacks instead of the menu.
+ * @details Only results are printed; the stream format is described in stack_batch.h.
+ * @param path The command file, or NULL for standard input.
+ * @return 0 if the whole stream ran, 1 otherwise.
+ */
+int runBatch(const char *path);
+
+/**
+ * @brief Main function to drive the menu and stack operations.
+ * @details It starts with two stacks and allows the user to perform various operations like push, pop, peek, display,
+ *          switch between stacks or to a new one, and reverse the stack.
+ * @return 0 to indicate successful execution of the program.
+ */
+int main(int argc, char *argv[])
+{
+    StackRegistry registry; /**< The stacks, named by their number */
+    unsigned current = 1; /**< Number of the active stack (default Stack 1) */
+    StackHandle handle; /**< Handle of the active stack */
+    UnrolledStack *active; /**< Pointer to the active stack */
+    int choice; /**< User choice for the menu */
+    int value; /**< Value to be pushed or popped */
+    unsigned stackChoice; /**< Stack number to switch to */
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+        return runBatch(argc > 2 ? argv[2] : NULL); // Batch mode: -b [commands file]
+    }
+    if (createStacks(&registry) != STACK_OK)
+    {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
+
+    do
+    {
+        // Display the current active stack
+        active = registryGetUnrolled(&registry, handle);
+        printf("Current Stack: Stack %u of %u\n", current, registryCount(&registry));
+        printf("1. Push\n");
+        printf("2. Pop\n");
+        printf("3. Peek\n");
+        printf("4. Display\n");
+        printf("5. Switch Stack\n");
+        printf("6. Reverse\n");
+        printf("7. Exit\n\n");
+        printf("Enter your choice: ");
+        scanf("%d", &choice);
+
+        switch (choice)
+        {
+        case 1:
+            // Push element onto the current active stack
+            printf("Enter element to be pushed: ");
+            scanf("%d", &value);
+            if (unrolledPush(active, value) != STACK_OK)
+            {
+                printf("Memory allocation failed\n");
+            }
+            break;
+
+        case 2:
+            // Pop element from the current active stack
+            if (unrolledTryPop(active, &value) == STACK_OK)
+            {
+                printf("Popped Element: %d\n", value);
+            }
+            else
+            {
+                printf("Stack is Empty! Cannot pop.\n");
+            }
+            break;
+
+        case 3:
+            // Peek the top element of the current active stack
+            if (unrolledTryPeek(active, &value) == STACK_OK)
+            {
+                printf("Top Element: %d\n", value);
+            }
+            else
+            {
+                printf("Stack is Empty! Cannot peek.\n");
+            }
+            break;
+
+        case 4:
+            // Display all elements of the current active stack
+            display(active);
+            break;
+
+        case 5:
+        {
+            // Switch to any stack, to a new one after the last, or to the next one
+            printf("Enter the stack number (1-%u, %u for a new stack, 0 for the next one): ", registryCount(&registry),
+                   registryCount(&registry) + 1);
+            stackChoice = 0;
+            scanf("%u", &stackChoice);
+            if (stackChoice == 0)
+            {
+                stackChoice = current % registryCount(&registry) + 1;
+            }
+            StackHandle selected = selectStack(&registry, stackChoice);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                printf("Invalid choice! Staying with the current stack.\n");
+            }
+            else
+            {
+                current = stackChoice;
+                handle = selected;
+                printf("Switched to Stack %u.\n", current);
+            }
+            break;
+        }
+
+        case 6:
+            // Reverse the current active stack
+            if (unrolledIsEmpty(active))
+            {
+                printf("Cannot reverse an empty Stack!\n");
+            }
+            else
+            {
+                unrolledReverse(active);
+                printf("Reversed Successfully!\n");
+            }
+            break;
+
+        case 7:
+            printf("Exiting...\n");
+            destroyRegistry(&registry);
+            break;
+
+        default:
+            printf("Invalid Choice! Try Again!\n");
+        }
+    } while (choice != 7);
+
+    return 0;
+}
+
+/**
+ * @brief Displays all elements of the stack, from top to bottom.
+ * @param stack A pointer to the stack.
+ */
+void display(UnrolledStack *stack)
+{
+    if (unrolledIsEmpty(stack))
+    {
+        printf("Stack is Empty\n");
+        return;
+    }
+
+    fflush(stdout); // unrolledDump() writes to the descriptor, bypassing stdio
+    if (unrolledDump(stack, NULL) != STACK_OK)
+    {
+        printf("Could not display the stack\n");
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Finds stack number `number`, creating it if it is the next number to hand out.
+ * @details Stacks are numbered from 1 in creation order and registered under their number,
+ *          so any of them is found in O(1) by name.
+ * @param registry The registry holding the stacks under the names "1", "2", ...
+ * @param number The number of the stack, counting from 1.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if there is no such stack and it could not be created.
+ */
+StackHandle selectStack(StackRegistry *registry, unsigned number)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "%u", number);
+    StackHandle handle = registryFind(registry, name);
+    if (handle == STACK_HANDLE_NONE && number == registryCount(registry) + 1 &&
+        registryCreate(registry, name, 0, 0, &handle) != STACK_OK)
+    {
+        return STACK_HANDLE_NONE;
+    }
+    return handle;
+}
+
+/**
+ * @brief Creates a registry holding the first INITIAL_STACKS numbered stacks.
+ * @param registry The registry to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the registry could not be allocated.
+ */
+StackStatus createStacks(StackRegistry *registry)
+{
+    if (initRegistryOf(registry, STACK_BACKEND_UNROLLED, INITIAL_STACKS) != STACK_OK)
+    {
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned number = 1; number <= INITIAL_STACKS; number++)
+    {
+        if (selectStack(registry, number) == STACK_HANDLE_NONE)
+        {
+            destroyRegistry(registry);
+            return STACK_NO_MEMORY;
+        }
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Runs a scripted command stream against the numbered stacks instead of the menu.
+ * @details Only results are printed; the stream format is described in stack_batch.h.
+ * @param path The command file, or NULL for standard input.
+ * @return 0 if the whole stream ran, 1 otherwise.
+ */
+int runBatch(const char *path)
+{
+    StackRegistry registry;
+    unsigned current = 1;
+    StackHandle handle;
+    BatchRun run;
+    BatchCommand command;
+    int value;
+
+    if (createStacks(&registry) != STACK_OK)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    StackStatus status = openBatch(&run, path);
+    if (status != STACK_OK)
+    {
+        fprintf(stderr, status == STACK_NO_MEMORY ? "Memory allocation failed\n" : "Cannot open the commands\n");
+        destroyRegistry(&registry);
+        return 1;
+    }
+    handle = registryFind(&registry, "1");
+
+    while ((status = nextBatchCommand(&run, &command)) == STACK_OK && command.op != BATCH_EXIT)
+    {
+        UnrolledStack *active = registryGetUnrolled(&registry, handle);
+        switch (command.op)
+        {
+        case BATCH_PUSH:
+            if (unrolledPush(active, command.value) != STACK_OK)
+            {
+                batchPrintText(&run, "nomem\n");
+            }
+            break;
+
+        case BATCH_POP:
+            if (unrolledTryPop(active, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_PEEK:
+            if (unrolledTryPeek(active, &value) == STACK_OK)
+            {
+                batchPrintInt(&run, value);
+            }
+            else
+            {
+                batchPrintText(&run, "empty\n");
+            }
+            break;
+
+        case BATCH_DISPLAY:
+            flushBatch(&run);
+            unrolledDump(active, NULL);
+            break;
+
+        case BATCH_SWITCH:
+        {
+            unsigned number = command.value ? (unsigned)command.value : current % registryCount(&registry) + 1;
+            StackHandle selected = selectStack(&registry, number);
+            if (selected == STACK_HANDLE_NONE)
+            {
+                batchPrintText(&run, "nostack\n");
+            }
+            else
+            {
+                current = number;
+                handle = selected;
+            }
+            break;
+        }
+
+        case BATCH_REVERSE:
+            unrolledReverse(active);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    destroyRegistry(&registry);
+    return closeBatch(&run, status);
+}
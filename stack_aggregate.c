@@ -0,0 +1,198 @@
+/**
+ * @file stack_aggregate.c
+ *
+ * @brief Implementation of the aggregate stack declared in stack_aggregate.h.
+ */
+
+#include <stdlib.h>
+
+#include "stack_aggregate.h"
+
+#define MIN_RECORDS 8 /**< Records allocated the first time a list is used */
+
+/**
+ * @brief Makes room for one more record.
+ * @return 1 on success, 0 if the list could not grow.
+ */
+static int reserveRecord(RecordList *list)
+{
+    if (list->count < list->capacity)
+    {
+        return 1;
+    }
+    unsigned capacity = list->capacity ? list->capacity * 2 : MIN_RECORDS;
+    if (capacity <= list->capacity)
+    {
+        return 0;
+    }
+    AggregateRecord *records = realloc(list->records, (size_t)capacity * sizeof(AggregateRecord));
+    if (records == NULL)
+    {
+        return 0;
+    }
+    list->records = records;
+    list->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Returns the most recent record of a non-empty list.
+ */
+static AggregateRecord *lastRecord(RecordList *list)
+{
+    return &list->records[list->count - 1];
+}
+
+/**
+ * @brief Initializes an empty stack.
+ * @param stack A pointer to the stack to initialize.
+ * @param cap The initial capacity.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initAggregateStack(AggregateStack *stack, unsigned cap, double growthFactor)
+{
+    stack->mins = (RecordList){ NULL, 0, 0 };
+    stack->maxes = (RecordList){ NULL, 0, 0 };
+    stack->sum = 0;
+    return initStack(&stack->items, cap, growthFactor, 0);
+}
+
+/**
+ * @brief Frees the memory of the stack, leaving it empty.
+ * @param stack A pointer to the stack.
+ */
+void destroyAggregateStack(AggregateStack *stack)
+{
+    destroyStack(&stack->items);
+    free(stack->mins.records);
+    free(stack->maxes.records);
+    stack->mins = (RecordList){ NULL, 0, 0 };
+    stack->maxes = (RecordList){ NULL, 0, 0 };
+    stack->sum = 0;
+}
+
+/**
+ * @brief Pushes an item, updating the minimum, maximum and sum.
+ * @details Room for the records is made before the item is pushed, so a failed
+ *          allocation leaves the stack as it was.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if memory could not be allocated.
+ */
+StackStatus aggregatePush(AggregateStack *stack, int item)
+{
+    int newMin = stack->mins.count == 0 || item < lastRecord(&stack->mins)->value;
+    int newMax = stack->maxes.count == 0 || item > lastRecord(&stack->maxes)->value;
+    if (STACK_UNLIKELY((newMin && !reserveRecord(&stack->mins)) || (newMax && !reserveRecord(&stack->maxes))))
+    {
+        return STACK_NO_MEMORY;
+    }
+    StackStatus status = push(&stack->items, item);
+    if (STACK_UNLIKELY(status != STACK_OK))
+    {
+        return status;
+    }
+    unsigned depth = stackSize(&stack->items);
+    if (newMin)
+    {
+        stack->mins.records[stack->mins.count++] = (AggregateRecord){ item, depth };
+    }
+    if (newMax)
+    {
+        stack->maxes.records[stack->maxes.count++] = (AggregateRecord){ item, depth };
+    }
+    stack->sum += item;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item, updating the minimum, maximum and sum.
+ * @details A record whose depth is above the new size was set by the popped item,
+ *          and the record before it becomes current again.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus aggregateTryPop(AggregateStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(tryPop(&stack->items, out) != STACK_OK))
+    {
+        return STACK_EMPTY;
+    }
+    unsigned depth = stackSize(&stack->items);
+    if (lastRecord(&stack->mins)->depth > depth)
+    {
+        stack->mins.count--;
+    }
+    if (lastRecord(&stack->maxes)->depth > depth)
+    {
+        stack->maxes.count--;
+    }
+    stack->sum -= *out;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateTryPeek(AggregateStack *stack, int *out)
+{
+    return tryPeek(&stack->items, out);
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+unsigned aggregateSize(AggregateStack *stack)
+{
+    return stackSize(&stack->items);
+}
+
+/**
+ * @brief Reads the smallest item on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @param out Receives the minimum; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateMin(AggregateStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->mins.count == 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = lastRecord(&stack->mins)->value;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the largest item on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @param out Receives the maximum; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateMax(AggregateStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->maxes.count == 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = lastRecord(&stack->maxes)->value;
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the sum of the items on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @return The sum, 0 for an empty stack.
+ */
+int64_t aggregateSum(AggregateStack *stack)
+{
+    return stack->sum;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file stack_aggregate.h
+ *
+ * @brief An array stack that keeps its minimum, maximum and sum up to date in O(1).
+ *
+ * The items live in an ordinary struct Stack. Beside it the stack keeps the
+ * running sum and two short record lists: a minimum record is added only when
+ * a push sets a new strict minimum, and remembers the depth at which it did, so
+ * it is dropped again when the stack is popped below that depth. The same goes
+ * for the maximum. A stack of n items therefore holds at most n records of each
+ * kind, and typically far fewer: none at all beyond the first for an ascending
+ * run of pushes, where a stack of (item, min, max) triples would triple the
+ * memory. Push, pop and every query stay O(1).
+ */
+
+#ifndef STACK_AGGREGATE_H
+#define STACK_AGGREGATE_H
+
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @struct aggregateRecord
+ * @brief A minimum or maximum, and the depth at which it became one.
+ */
+typedef struct aggregateRecord
+{
+    int value;      /**< The extreme value */
+    unsigned depth; /**< Stack size right after the item was pushed */
+} AggregateRecord;
+
+/**
+ * @struct recordList
+ * @brief A growable list of records, most recent last.
+ */
+typedef struct recordList
+{
+    AggregateRecord *records; /**< The records */
+    unsigned count;           /**< Records in use */
+    unsigned capacity;        /**< Records allocated */
+} RecordList;
+
+/**
+ * @struct aggregateStack
+ * @brief An array stack with its minimum, maximum and sum.
+ */
+typedef struct aggregateStack
+{
+    struct Stack items; /**< The items themselves */
+    RecordList mins;    /**< Successive strict minimums, the current one last */
+    RecordList maxes;   /**< Successive strict maximums, the current one last */
+    int64_t sum;        /**< Sum of the items */
+} AggregateStack;
+
+/**
+ * @brief Initializes an empty stack.
+ * @param stack A pointer to the stack to initialize.
+ * @param cap The initial capacity.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initAggregateStack(AggregateStack *stack, unsigned cap, double growthFactor);
+
+/**
+ * @brief Frees the memory of the stack, leaving it empty.
+ * @param stack A pointer to the stack.
+ */
+void destroyAggregateStack(AggregateStack *stack);
+
+/**
+ * @brief Pushes an item, updating the minimum, maximum and sum.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if memory could not be allocated.
+ */
+StackStatus aggregatePush(AggregateStack *stack, int item);
+
+/**
+ * @brief Pops the top item, updating the minimum, maximum and sum.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus aggregateTryPop(AggregateStack *stack, int *out);
+
+/**
+ * @brief Reads the top item.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateTryPeek(AggregateStack *stack, int *out);
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+unsigned aggregateSize(AggregateStack *stack);
+
+/**
+ * @brief Reads the smallest item on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @param out Receives the minimum; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateMin(AggregateStack *stack, int *out);
+
+/**
+ * @brief Reads the largest item on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @param out Receives the maximum; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus aggregateMax(AggregateStack *stack, int *out);
+
+/**
+ * @brief Returns the sum of the items on the stack in O(1).
+ * @param stack A pointer to the stack.
+ * @return The sum, 0 for an empty stack; it cannot overflow below 2^32 items.
+ */
+int64_t aggregateSum(AggregateStack *stack);
+
+#endif /* STACK_AGGREGATE_H */
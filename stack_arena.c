@@ -0,0 +1,221 @@
+/**
+ * @file stack_arena.c
+ *
+ * @brief Implementation of the stack families declared in stack_arena.h.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "stack_arena.h"
+
+/* ---------------------------------------------------------------------------
+ * Two stacks in one array
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Creates an empty pair of stacks in one allocation.
+ * @param cap The number of elements the two stacks can hold together.
+ * @return A pointer to the pair, to be released with free(), or NULL if it could not be allocated.
+ */
+TwinStack *createTwinStack(unsigned cap)
+{
+    if (cap > INT_MAX)
+    {
+        return NULL; // The tops are ints
+    }
+    TwinStack *twin = malloc(sizeof(TwinStack) + (size_t)cap * sizeof(int));
+    if (twin == NULL)
+    {
+        return NULL;
+    }
+    twin->capacity = cap;
+    twin->top[0] = -1;
+    twin->top[1] = (int)cap;
+    return twin;
+}
+
+/**
+ * @brief Pushes an item onto one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to push onto.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if the two stacks have met.
+ */
+StackStatus twinPush(TwinStack *twin, int which, int item)
+{
+    if (STACK_UNLIKELY(twin->top[0] + 1 == twin->top[1]))
+    {
+        return STACK_FULL;
+    }
+    // Stack 0 moves up, stack 1 moves down
+    twin->top[which] += which ? -1 : 1;
+    twin->array[twin->top[which]] = item;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item of one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to pop from.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus twinTryPop(TwinStack *twin, int which, int *out)
+{
+    if (STACK_UNLIKELY(twinSize(twin, which) == 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = twin->array[twin->top[which]];
+    twin->top[which] += which ? 1 : -1;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item of one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to read.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus twinTryPeek(TwinStack *twin, int which, int *out)
+{
+    if (STACK_UNLIKELY(twinSize(twin, which) == 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = twin->array[twin->top[which]];
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the number of items on one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to measure.
+ * @return The number of items.
+ */
+unsigned twinSize(TwinStack *twin, int which)
+{
+    return which ? twin->capacity - (unsigned)twin->top[1] : (unsigned)(twin->top[0] + 1);
+}
+
+/* ---------------------------------------------------------------------------
+ * k stacks sharing a pool of slots
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Creates a family of empty stacks in one allocation.
+ * @details The header, the per-stack arrays and the slot arrays are laid out back
+ *          to back, and every slot starts out on the free chain.
+ * @param stacks The number of stacks.
+ * @param cap The number of items all the stacks can hold together.
+ * @return A pointer to the family, to be released with free(), or NULL if it could not be allocated.
+ */
+MultiStack *createMultiStack(unsigned stacks, unsigned cap)
+{
+    if (cap == MULTI_NONE || (size_t)stacks + cap > SIZE_MAX / (3 * sizeof(unsigned)))
+    {
+        return NULL;
+    }
+    size_t bytes = sizeof(MultiStack) + 2 * (size_t)stacks * sizeof(unsigned) +
+                   (size_t)cap * (sizeof(unsigned) + sizeof(int));
+    MultiStack *multi = malloc(bytes);
+    if (multi == NULL)
+    {
+        return NULL;
+    }
+    multi->stacks = stacks;
+    multi->capacity = cap;
+    multi->top = (unsigned *)(multi + 1);
+    multi->size = multi->top + stacks;
+    multi->next = multi->size + stacks;
+    multi->items = (int *)(multi->next + cap);
+
+    for (unsigned i = 0; i < stacks; i++)
+    {
+        multi->top[i] = MULTI_NONE;
+        multi->size[i] = 0;
+    }
+    for (unsigned i = 0; i < cap; i++)
+    {
+        multi->next[i] = i + 1 < cap ? i + 1 : MULTI_NONE;
+    }
+    multi->freeTop = cap > 0 ? 0 : MULTI_NONE;
+    return multi;
+}
+
+/**
+ * @brief Pushes an item onto one stack of the family.
+ * @details The item goes into the first free slot, which is linked on top of the stack.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if every slot is in use.
+ */
+StackStatus multiPush(MultiStack *multi, unsigned which, int item)
+{
+    unsigned slot = multi->freeTop;
+    if (STACK_UNLIKELY(slot == MULTI_NONE))
+    {
+        return STACK_FULL;
+    }
+    multi->freeTop = multi->next[slot];
+    multi->items[slot] = item;
+    multi->next[slot] = multi->top[which];
+    multi->top[which] = slot;
+    multi->size[which]++;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item of one stack of the family, returning its slot to the pool.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus multiTryPop(MultiStack *multi, unsigned which, int *out)
+{
+    unsigned slot = multi->top[which];
+    if (STACK_UNLIKELY(slot == MULTI_NONE))
+    {
+        return STACK_EMPTY;
+    }
+    *out = multi->items[slot];
+    multi->top[which] = multi->next[slot];
+    multi->next[slot] = multi->freeTop;
+    multi->freeTop = slot;
+    multi->size[which]--;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item of one stack of the family.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus multiTryPeek(MultiStack *multi, unsigned which, int *out)
+{
+    unsigned slot = multi->top[which];
+    if (STACK_UNLIKELY(slot == MULTI_NONE))
+    {
+        return STACK_EMPTY;
+    }
+    *out = multi->items[slot];
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the number of items on one stack of the family.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @return The number of items.
+ */
+unsigned multiSize(MultiStack *multi, unsigned which)
+{
+    return multi->size[which];
+}
@@ -0,0 +1,154 @@
+/**
+ * @file stack_arena.h
+ *
+ * @brief Families of array stacks carved from one contiguous allocation.
+ *
+ * Every stack of a family shares a single block of memory holding the headers
+ * and the elements of all of them, so creating a family costs one malloc(),
+ * freeing it costs one free(), and many small stacks no longer fragment the
+ * heap. Two layouts are provided:
+ *
+ * - TwinStack: two stacks in one array, the first growing up from the start and
+ *   the second down from the end. Either stack can use all the room the other
+ *   one leaves, and the pair is full only when they meet.
+ * - MultiStack: any number of stacks sharing a pool of element slots. Each
+ *   stack is a chain of slots linked by index; free slots form one more chain
+ *   that every stack pushes from and pops back to.
+ *
+ * Both have a fixed total capacity chosen when the family is created; a push
+ * into a full family fails with STACK_FULL.
+ */
+
+#ifndef STACK_ARENA_H
+#define STACK_ARENA_H
+
+#include "stack.h"
+
+/* ---------------------------------------------------------------------------
+ * Two stacks in one array
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct twinStack
+ * @brief Two stacks growing toward each other in one array.
+ */
+typedef struct twinStack
+{
+    unsigned capacity; /**< Elements the two stacks can hold together */
+    int top[2];        /**< Top index of each stack: stack 0 starts at -1, stack 1 at `capacity` */
+    int array[];       /**< Elements of stack 0 from the start, of stack 1 from the end */
+} TwinStack;
+
+/**
+ * @brief Creates an empty pair of stacks in one allocation.
+ * @param cap The number of elements the two stacks can hold together.
+ * @return A pointer to the pair, to be released with free(), or NULL if it could not be allocated.
+ */
+TwinStack *createTwinStack(unsigned cap);
+
+/**
+ * @brief Pushes an item onto one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to push onto.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if the two stacks have met.
+ */
+StackStatus twinPush(TwinStack *twin, int which, int item);
+
+/**
+ * @brief Pops the top item of one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to pop from.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus twinTryPop(TwinStack *twin, int which, int *out);
+
+/**
+ * @brief Reads the top item of one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to read.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus twinTryPeek(TwinStack *twin, int which, int *out);
+
+/**
+ * @brief Returns the number of items on one of the two stacks.
+ * @param twin A pointer to the pair.
+ * @param which 0 or 1, the stack to measure.
+ * @return The number of items.
+ */
+unsigned twinSize(TwinStack *twin, int which);
+
+/* ---------------------------------------------------------------------------
+ * k stacks sharing a pool of slots
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct multiStack
+ * @brief A family of stacks sharing one pool of element slots.
+ * @details The header is followed, in the same allocation, by the per-stack
+ *          tops and sizes and by the slots' items and links.
+ */
+typedef struct multiStack
+{
+    unsigned stacks;   /**< Number of stacks in the family */
+    unsigned capacity; /**< Slots shared by all the stacks */
+    unsigned freeTop;  /**< First free slot, or MULTI_NONE */
+    unsigned *top;     /**< Top slot of each stack, or MULTI_NONE */
+    unsigned *size;    /**< Number of items of each stack */
+    unsigned *next;    /**< Slot below each slot, or the next free slot */
+    int *items;        /**< Item held by each slot */
+} MultiStack;
+
+/**
+ * @def MULTI_NONE
+ * @brief Slot index marking the end of a chain.
+ */
+#define MULTI_NONE ((unsigned)-1)
+
+/**
+ * @brief Creates a family of empty stacks in one allocation.
+ * @param stacks The number of stacks.
+ * @param cap The number of items all the stacks can hold together.
+ * @return A pointer to the family, to be released with free(), or NULL if it could not be allocated.
+ */
+MultiStack *createMultiStack(unsigned stacks, unsigned cap);
+
+/**
+ * @brief Pushes an item onto one stack of the family.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if every slot is in use.
+ */
+StackStatus multiPush(MultiStack *multi, unsigned which, int item);
+
+/**
+ * @brief Pops the top item of one stack of the family, returning its slot to the pool.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus multiTryPop(MultiStack *multi, unsigned which, int *out);
+
+/**
+ * @brief Reads the top item of one stack of the family.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus multiTryPeek(MultiStack *multi, unsigned which, int *out);
+
+/**
+ * @brief Returns the number of items on one stack of the family.
+ * @param multi A pointer to the family.
+ * @param which The index of the stack.
+ * @return The number of items.
+ */
+unsigned multiSize(MultiStack *multi, unsigned which);
+
+#endif /* STACK_ARENA_H */
@@ -0,0 +1,446 @@
+/**
+ * @file stack_batch.c
+ *
+ * @brief Implementation of the command streams declared in stack_batch.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stack_batch.h"
+#include "stack_dump.h"
+
+#define MAX_RESULT_BYTES 16 /**< Longest result line: a sign, ten digits and a newline */
+
+/**
+ * @brief Returns a monotonic timestamp in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ---------------------------------------------------------------------------
+ * Input
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Moves the unread bytes to the front of the buffer and reads more behind them.
+ * @param run A pointer to the run.
+ * @return STACK_OK on success (including end of file), STACK_IO_ERROR if a read failed.
+ */
+static StackStatus refill(BatchRun *run)
+{
+    memmove(run->input, run->input + run->start, run->end - run->start);
+    run->end -= run->start;
+    run->start = 0;
+    for (;;)
+    {
+        ssize_t n = read(run->in, run->input + run->end, BATCH_BUFFER_BYTES - run->end);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            return STACK_IO_ERROR;
+        }
+        if (n == 0)
+        {
+            run->eof = 1;
+        }
+        run->end += (size_t)n;
+        return STACK_OK;
+    }
+}
+
+/**
+ * @brief Makes sure at least `n` unread bytes are buffered, unless the stream ends first.
+ * @param run A pointer to the run.
+ * @param n The number of bytes wanted, at most BATCH_BUFFER_BYTES.
+ * @return STACK_OK on success, STACK_EMPTY if the stream ends first, STACK_IO_ERROR if a read failed.
+ */
+static StackStatus ensureBytes(BatchRun *run, size_t n)
+{
+    while (run->end - run->start < n)
+    {
+        if (run->eof)
+        {
+            return STACK_EMPTY;
+        }
+        StackStatus status = refill(run);
+        if (status != STACK_OK)
+        {
+            return status;
+        }
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Opens a command stream and detects its format.
+ * @param run A pointer to the run to initialize.
+ * @param path The file to read, or NULL or "-" for standard input.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+StackStatus openBatch(BatchRun *run, const char *path)
+{
+    memset(run, 0, sizeof(*run));
+    run->in = STDIN_FILENO;
+    if (path != NULL && strcmp(path, "-") != 0)
+    {
+        run->in = open(path, O_RDONLY);
+        if (run->in < 0)
+        {
+            return STACK_IO_ERROR;
+        }
+    }
+    run->input = malloc(BATCH_BUFFER_BYTES);
+    run->output = malloc(BATCH_BUFFER_BYTES);
+    if (run->input == NULL || run->output == NULL)
+    {
+        free(run->input);
+        free(run->output);
+        if (run->in != STDIN_FILENO)
+        {
+            close(run->in);
+        }
+        return STACK_NO_MEMORY;
+    }
+
+    StackStatus status = ensureBytes(run, 4);
+    if (status == STACK_OK && memcmp(run->input, BATCH_MAGIC, 4) == 0)
+    {
+        run->binary = 1;
+        run->start = 4;
+    }
+    if (status == STACK_IO_ERROR)
+    {
+        free(run->input);
+        free(run->output);
+        if (run->in != STDIN_FILENO)
+        {
+            close(run->in);
+        }
+        return STACK_IO_ERROR;
+    }
+    run->started = now();
+    return STACK_OK;
+}
+
+/**
+ * @brief Decodes the next command of a binary stream.
+ * @param run A pointer to the run.
+ * @param command Receives the command.
+ * @return STACK_OK, STACK_EMPTY, STACK_CORRUPT or STACK_IO_ERROR.
+ */
+static StackStatus nextBinaryCommand(BatchRun *run, BatchCommand *command)
+{
+    StackStatus status = ensureBytes(run, 1);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    unsigned op = run->input[run->start];
+    if (op < BATCH_PUSH || op > BATCH_EXIT)
+    {
+        return STACK_CORRUPT;
+    }
+    command->op = (BatchOp)op;
+    command->value = 0;
+    if (op != BATCH_PUSH && op != BATCH_SWITCH)
+    {
+        run->start++;
+        return STACK_OK;
+    }
+
+    status = ensureBytes(run, 5);
+    if (status != STACK_OK)
+    {
+        return status == STACK_EMPTY ? STACK_CORRUPT : status; // Operand cut off
+    }
+    const unsigned char *p = run->input + run->start + 1;
+    command->value = (int)((unsigned)p[0] | (unsigned)p[1] << 8 | (unsigned)p[2] << 16 | (unsigned)p[3] << 24);
+    if (op == BATCH_SWITCH && (command->value < 0))
+    {
+        return STACK_CORRUPT;
+    }
+    run->start += 5;
+    return STACK_OK;
+}
+
+/**
+ * @brief Parses an optionally signed decimal number.
+ * @param p A pointer to the cursor, advanced past the number.
+ * @param end The end of the line.
+ * @param value Receives the number.
+ * @return 1 on success, 0 if there is no number or it does not fit an int.
+ */
+static int parseInt(const char **p, const char *end, int *value)
+{
+    const char *s = *p;
+    int negative = s < end && *s == '-';
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        s++;
+    }
+    if (s == end || *s < '0' || *s > '9')
+    {
+        return 0;
+    }
+    long long n = 0;
+    while (s < end && *s >= '0' && *s <= '9')
+    {
+        n = n * 10 + (*s++ - '0');
+        if (n > (long long)INT_MAX + 1)
+        {
+            return 0;
+        }
+    }
+    n = negative ? -n : n;
+    if (n > INT_MAX)
+    {
+        return 0;
+    }
+    *value = (int)n;
+    *p = s;
+    return 1;
+}
+
+/**
+ * @brief Skips spaces and tabs.
+ */
+static const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Parses one line of a text stream.
+ * @param p The start of the line.
+ * @param end The end of the line, excluding the newline.
+ * @param command Receives the command.
+ * @return STACK_OK for a command, STACK_EMPTY for a blank or comment line, STACK_CORRUPT otherwise.
+ */
+static StackStatus parseLine(const char *p, const char *end, BatchCommand *command)
+{
+    static const char *const keywords[] = { "push", "pop", "peek", "display", "switch", "reverse", "exit" };
+
+    p = skipBlanks(p, end);
+    if (p == end || *p == '#')
+    {
+        return STACK_EMPTY;
+    }
+
+    int op = 0;
+    if (*p >= '0' && *p <= '9')
+    {
+        if (!parseInt(&p, end, &op) || op < BATCH_PUSH || op > BATCH_EXIT)
+        {
+            return STACK_CORRUPT;
+        }
+    }
+    else
+    {
+        const char *word = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+        {
+            p++;
+        }
+        for (int i = 0; i < BATCH_EXIT; i++)
+        {
+            if (strlen(keywords[i]) == (size_t)(p - word) && memcmp(keywords[i], word, (size_t)(p - word)) == 0)
+            {
+                op = i + 1;
+            }
+        }
+        if (op == 0)
+        {
+            return STACK_CORRUPT;
+        }
+    }
+
+    command->op = (BatchOp)op;
+    command->value = 0;
+    p = skipBlanks(p, end);
+    if (op == BATCH_PUSH || (op == BATCH_SWITCH && p < end))
+    {
+        if (!parseInt(&p, end, &command->value))
+        {
+            return STACK_CORRUPT;
+        }
+        if (op == BATCH_SWITCH && (command->value < 0))
+        {
+            return STACK_CORRUPT;
+        }
+    }
+    return skipBlanks(p, end) == end ? STACK_OK : STACK_CORRUPT;
+}
+
+/**
+ * @brief Decodes the next command of a text stream, skipping blank and comment lines.
+ * @param run A pointer to the run.
+ * @param command Receives the command.
+ * @return STACK_OK, STACK_EMPTY, STACK_CORRUPT or STACK_IO_ERROR.
+ */
+static StackStatus nextTextCommand(BatchRun *run, BatchCommand *command)
+{
+    for (;;)
+    {
+        const char *line = (const char *)run->input + run->start;
+        const char *newline = memchr(line, '\n', run->end - run->start);
+        if (newline == NULL && !run->eof)
+        {
+            if (run->start == 0 && run->end == BATCH_BUFFER_BYTES)
+            {
+                run->line++; // Reported as the line it is
+                return STACK_CORRUPT; // A line longer than the whole buffer
+            }
+            StackStatus status = refill(run);
+            if (status != STACK_OK)
+            {
+                return status;
+            }
+            continue;
+        }
+        if (newline == NULL && run->start == run->end)
+        {
+            return STACK_EMPTY;
+        }
+
+        const char *lineEnd = newline != NULL ? newline : (const char *)run->input + run->end;
+        run->start = (size_t)(lineEnd - (const char *)run->input) + (newline != NULL);
+        run->line++;
+        StackStatus status = parseLine(line, lineEnd, command);
+        if (status != STACK_EMPTY)
+        {
+            return status;
+        }
+    }
+}
+
+/**
+ * @brief Decodes the next command of the stream.
+ * @param run A pointer to the run.
+ * @param command Receives the command.
+ * @return STACK_OK on success, STACK_EMPTY at the end of the stream,
+ *         STACK_CORRUPT for a malformed command, STACK_IO_ERROR if a read failed.
+ */
+StackStatus nextBatchCommand(BatchRun *run, BatchCommand *command)
+{
+    StackStatus status = run->binary ? nextBinaryCommand(run, command) : nextTextCommand(run, command);
+    if (status == STACK_OK)
+    {
+        run->commands++;
+    }
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Output
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Writes the buffered output to standard output.
+ * @param run A pointer to the run.
+ */
+void flushBatch(BatchRun *run)
+{
+    size_t done = 0;
+    while (done < run->used)
+    {
+        ssize_t n = write(STDOUT_FILENO, run->output + done, run->used - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break; // Nowhere to report it; the results are lost either way
+        }
+        done += (size_t)n;
+    }
+    run->used = 0;
+}
+
+/**
+ * @brief Adds a number and a newline to the output.
+ * @param run A pointer to the run.
+ * @param value The number.
+ */
+void batchPrintInt(BatchRun *run, int value)
+{
+    if (run->used + MAX_RESULT_BYTES > BATCH_BUFFER_BYTES)
+    {
+        flushBatch(run);
+    }
+    run->used += dumpFormatInt(run->output + run->used, value);
+    run->output[run->used++] = '\n';
+}
+
+/**
+ * @brief Adds a string to the output.
+ * @param run A pointer to the run.
+ * @param text The string, shorter than BATCH_BUFFER_BYTES.
+ */
+void batchPrintText(BatchRun *run, const char *text)
+{
+    size_t length = strlen(text);
+    if (run->used + length > BATCH_BUFFER_BYTES)
+    {
+        flushBatch(run);
+    }
+    memcpy(run->output + run->used, text, length);
+    run->used += length;
+}
+
+/**
+ * @brief Flushes the output, prints the summary, and closes the stream.
+ * @param run A pointer to the run.
+ * @param status How the run ended.
+ * @return 0 if the run succeeded, 1 otherwise.
+ */
+int closeBatch(BatchRun *run, StackStatus status)
+{
+    double seconds = now() - run->started;
+    flushBatch(run);
+    if (status == STACK_CORRUPT)
+    {
+        if (run->binary)
+        {
+            fprintf(stderr, "Malformed command after %zu commands\n", run->commands);
+        }
+        else
+        {
+            fprintf(stderr, "Malformed command on line %zu\n", run->line);
+        }
+    }
+    else if (status == STACK_IO_ERROR)
+    {
+        fprintf(stderr, "Could not read the commands\n");
+    }
+    fprintf(stderr, "%zu commands in %.3f s (%.2f million per second)\n", run->commands, seconds,
+            seconds > 0 ? run->commands / seconds / 1e6 : 0.0);
+
+    if (run->in != STDIN_FILENO)
+    {
+        close(run->in);
+    }
+    free(run->input);
+    free(run->output);
+    return status != STACK_OK && status != STACK_EMPTY;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file stack_batch.h
+ *
+ * @brief Scripted command streams for the menu-driven programs.
+ *
+ * Instead of prompting, a driver started in batch mode reads its operations from
+ * a file or standard input and runs them without printing the menu. Two stream
+ * formats are accepted, told apart by their first bytes:
+ *
+ * - Text: one command per line, either as the menu number or as a keyword, with
+ *   an operand where the command takes one. Blank lines and lines starting with
+ *   `#` are skipped.
+ *
+ *       push 42        (or: 1 42)
+ *       pop            (or: 2)
+ *       peek           (or: 3)
+ *       display        (or: 4)
+ *       switch [n]     (or: 5 [n]; without an operand, switches to the next stack)
+ *       reverse        (or: 6)
+ *       exit           (or: 7)
+ *
+ * - Binary: the four bytes BATCH_MAGIC, then one byte per command holding its
+ *   BatchOp value; push and switch are followed by their operand as a 32-bit
+ *   little-endian integer.
+ *
+ * Input and output both go through large buffers. Results are written one per
+ * line: the value of a pop or peek, `empty` when there was nothing to return,
+ * `full` or `nomem` for a rejected push, and `nostack` for a switch to a stack
+ * the driver does not have. Successful pushes, switches and reversals print
+ * nothing. A summary with the command count and the elapsed time goes to
+ * standard error at the end.
+ */
+
+#ifndef STACK_BATCH_H
+#define STACK_BATCH_H
+
+#include <stddef.h>
+
+#include "stack.h"
+
+/**
+ * @def BATCH_MAGIC
+ * @brief First four bytes of a binary command stream.
+ */
+#define BATCH_MAGIC "STKO"
+
+/**
+ * @def BATCH_BUFFER_BYTES
+ * @brief Size of the input and output buffers.
+ */
+#define BATCH_BUFFER_BYTES (1 << 16)
+
+/**
+ * @enum batchOp
+ * @brief A batch command; the values match the menu choices.
+ */
+typedef enum batchOp
+{
+    BATCH_PUSH = 1, /**< Push the operand */
+    BATCH_POP,      /**< Pop and print the top element */
+    BATCH_PEEK,     /**< Print the top element */
+    BATCH_DISPLAY,  /**< Print the whole stack */
+    BATCH_SWITCH,   /**< Select stack n, counting from 1, or the next one when the operand is 0 */
+    BATCH_REVERSE,  /**< Reverse the stack */
+    BATCH_EXIT      /**< Stop reading commands */
+} BatchOp;
+
+/**
+ * @struct batchCommand
+ * @brief One decoded command.
+ */
+typedef struct batchCommand
+{
+    BatchOp op; /**< What to do */
+    int value;  /**< Operand of push and switch, 0 otherwise */
+} BatchCommand;
+
+/**
+ * @struct batchRun
+ * @brief An open command stream together with the buffered output of its results.
+ */
+typedef struct batchRun
+{
+    int in;                 /**< Descriptor commands are read from */
+    int binary;             /**< Non-zero for a binary stream */
+    unsigned char *input;   /**< Input buffer */
+    size_t start;           /**< First unread byte of `input` */
+    size_t end;             /**< End of the valid bytes of `input` */
+    int eof;                /**< Non-zero once the descriptor is exhausted */
+    size_t line;            /**< Line of the last text command, for error messages */
+    size_t commands;        /**< Commands executed so far */
+    char *output;           /**< Output buffer */
+    size_t used;            /**< Bytes waiting in `output` */
+    double started;         /**< Start time, in seconds */
+} BatchRun;
+
+/**
+ * @brief Opens a command stream and detects its format.
+ * @param run A pointer to the run to initialize.
+ * @param path The file to read, or NULL or "-" for standard input.
+ * @return STACK_OK on success, STACK_IO_ERROR if the file could not be opened,
+ *         STACK_NO_MEMORY if the buffers could not be allocated.
+ */
+StackStatus openBatch(BatchRun *run, const char *path);
+
+/**
+ * @brief Decodes the next command of the stream.
+ * @param run A pointer to the run.
+ * @param command Receives the command.
+ * @return STACK_OK on success, STACK_EMPTY at the end of the stream,
+ *         STACK_CORRUPT for a malformed command, STACK_IO_ERROR if a read failed.
+ */
+StackStatus nextBatchCommand(BatchRun *run, BatchCommand *command);
+
+/**
+ * @brief Adds a number and a newline to the output.
+ * @param run A pointer to the run.
+ * @param value The number.
+ */
+void batchPrintInt(BatchRun *run, int value);
+
+/**
+ * @brief Adds a string to the output.
+ * @param run A pointer to the run.
+ * @param text The string.
+ */
+void batchPrintText(BatchRun *run, const char *text);
+
+/**
+ * @brief Writes the buffered output to standard output.
+ * @details Call this before writing to standard output by other means.
+ * @param run A pointer to the run.
+ */
+void flushBatch(BatchRun *run);
+
+/**
+ * @brief Flushes the output, prints the summary, and closes the stream.
+ * @details A failed stream is reported with the line it stopped at.
+ * @param run A pointer to the run.
+ * @param status How the run ended: STACK_EMPTY or STACK_OK for success, or the error that stopped it.
+ * @return 0 if the run succeeded, 1 otherwise, for use as the exit code.
+ */
+int closeBatch(BatchRun *run, StackStatus status);
+
+#endif /* STACK_BATCH_H */
@@ -0,0 +1,229 @@
+/**
+ * @file stack_checkpoint.c
+ *
+ * @brief Implementation of the checkpointed stack declared in stack_checkpoint.h.
+ */
+
+#include <stdlib.h>
+
+#include "stack_checkpoint.h"
+
+#define MIN_ENTRIES 8 /**< Entries allocated the first time the log or the checkpoint list is used */
+
+/**
+ * @brief Makes room for one more element in a growable array.
+ * @param items The array, or NULL if nothing has been allocated yet.
+ * @param count Elements in use.
+ * @param capacity Elements allocated; updated if the array grows.
+ * @param size Size of one element.
+ * @return The array, possibly moved, or NULL if it could not grow.
+ */
+static void *reserveEntry(void *items, unsigned count, unsigned *capacity, size_t size)
+{
+    if (count < *capacity)
+    {
+        return items;
+    }
+    unsigned newCapacity = *capacity ? *capacity * 2 : MIN_ENTRIES;
+    if (newCapacity <= *capacity)
+    {
+        return NULL;
+    }
+    void *grown = realloc(items, (size_t)newCapacity * size);
+    if (grown != NULL)
+    {
+        *capacity = newCapacity;
+    }
+    return grown;
+}
+
+/**
+ * @brief Returns the slot below which pushes must log, 0 without a checkpoint.
+ */
+static unsigned guardedSlots(CheckpointStack *stack)
+{
+    return stack->markCount ? stack->marks[stack->markCount - 1].guarded : 0;
+}
+
+/**
+ * @brief Initializes an empty stack with no checkpoint.
+ * @details The array is created without shrink-on-pop: popped slots must survive for a rollback.
+ * @param stack A pointer to the stack to initialize.
+ * @param cap The initial capacity.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initCheckpointStack(CheckpointStack *stack, unsigned cap, double growthFactor)
+{
+    stack->log = NULL;
+    stack->logCount = stack->logCapacity = 0;
+    stack->marks = NULL;
+    stack->markCount = stack->markCapacity = 0;
+    stack->loggedFrom = stack->loggedTo = 0;
+    return initStack(&stack->items, cap, growthFactor, 0);
+}
+
+/**
+ * @brief Frees the memory of the stack, leaving it empty with no checkpoint.
+ * @param stack A pointer to the stack.
+ */
+void destroyCheckpointStack(CheckpointStack *stack)
+{
+    destroyStack(&stack->items);
+    free(stack->log);
+    free(stack->marks);
+    stack->log = NULL;
+    stack->logCount = stack->logCapacity = 0;
+    stack->marks = NULL;
+    stack->markCount = stack->markCapacity = 0;
+    stack->loggedFrom = stack->loggedTo = 0;
+}
+
+/**
+ * @brief Pushes an item, logging the slot's old value first if a checkpoint may need it.
+ * @details Pushes only write the slot at the top, so the slots logged since the
+ *          innermost checkpoint are tracked as one run that grows by one at either
+ *          end; a slot outside it is logged and starts a new run. A guarded slot
+ *          lies below the size at some checkpoint, so the push cannot need to grow
+ *          the array and fail after logging.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if memory could not be allocated.
+ */
+StackStatus checkpointPush(CheckpointStack *stack, int item)
+{
+    unsigned slot = stackSize(&stack->items);
+    if (STACK_UNLIKELY(slot < guardedSlots(stack)) && (slot < stack->loggedFrom || slot >= stack->loggedTo))
+    {
+        UndoEntry *log = reserveEntry(stack->log, stack->logCount, &stack->logCapacity, sizeof(UndoEntry));
+        if (log == NULL)
+        {
+            return STACK_NO_MEMORY;
+        }
+        stack->log = log;
+        stack->log[stack->logCount++] = (UndoEntry){ slot, stack->items.array[slot] };
+        if (slot + 1 == stack->loggedFrom)
+        {
+            stack->loggedFrom = slot;
+        }
+        else if (slot == stack->loggedTo)
+        {
+            stack->loggedTo++;
+        }
+        else
+        {
+            stack->loggedFrom = slot;
+            stack->loggedTo = slot + 1;
+        }
+    }
+    return push(&stack->items, item);
+}
+
+/**
+ * @brief Pops the top item; the item stays in its slot until overwritten.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus checkpointTryPop(CheckpointStack *stack, int *out)
+{
+    return tryPop(&stack->items, out);
+}
+
+/**
+ * @brief Reads the top item.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus checkpointTryPeek(CheckpointStack *stack, int *out)
+{
+    return tryPeek(&stack->items, out);
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+unsigned checkpointSize(CheckpointStack *stack)
+{
+    return stackSize(&stack->items);
+}
+
+/**
+ * @brief Takes a checkpoint in O(1), nested inside those already active.
+ * @param stack A pointer to the stack.
+ * @param mark Receives the checkpoint's handle, to pass to checkpointRollback().
+ * @return STACK_OK on success, STACK_NO_MEMORY if the checkpoint could not be recorded.
+ */
+StackStatus checkpointMark(CheckpointStack *stack, unsigned *mark)
+{
+    StackMark *marks = reserveEntry(stack->marks, stack->markCount, &stack->markCapacity, sizeof(StackMark));
+    if (STACK_UNLIKELY(marks == NULL))
+    {
+        return STACK_NO_MEMORY;
+    }
+    stack->marks = marks;
+    unsigned size = stackSize(&stack->items);
+    unsigned guarded = guardedSlots(stack);
+    stack->marks[stack->markCount] = (StackMark){ size, stack->logCount, size > guarded ? size : guarded };
+    *mark = stack->markCount++;
+    stack->loggedFrom = stack->loggedTo = 0; // Slots must be logged again for this checkpoint
+    return STACK_OK;
+}
+
+/**
+ * @brief Restores the stack as it was when `mark` was taken.
+ * @details The log is replayed newest first, so a slot logged more than once ends
+ *          with its oldest value. The checkpoints taken after `mark` are discarded;
+ *          `mark` stays active.
+ * @param stack A pointer to the stack.
+ * @param mark A handle returned by checkpointMark().
+ * @return STACK_OK on success, STACK_EMPTY if `mark` is not an active checkpoint.
+ */
+StackStatus checkpointRollback(CheckpointStack *stack, unsigned mark)
+{
+    if (STACK_UNLIKELY(mark >= stack->markCount))
+    {
+        return STACK_EMPTY;
+    }
+    StackMark *saved = &stack->marks[mark];
+    while (stack->logCount > saved->logCount)
+    {
+        UndoEntry *entry = &stack->log[--stack->logCount];
+        stack->items.array[entry->index] = entry->value;
+    }
+    stack->items.top = (int)saved->size - 1;
+    stack->markCount = mark + 1;
+    stack->loggedFrom = stack->loggedTo = 0;
+    return STACK_OK;
+}
+
+/**
+ * @brief Releases the innermost checkpoint, keeping every change made since it was taken.
+ * @details Entries logged since the checkpoint for slots the enclosing one does not
+ *          guard are dropped, and the whole log once no checkpoint is left.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_EMPTY if no checkpoint is active.
+ */
+StackStatus checkpointCommit(CheckpointStack *stack)
+{
+    if (STACK_UNLIKELY(stack->markCount == 0))
+    {
+        return STACK_EMPTY;
+    }
+    unsigned first = stack->marks[--stack->markCount].logCount;
+    unsigned guarded = guardedSlots(stack);
+    unsigned kept = first;
+    for (unsigned i = first; i < stack->logCount; i++)
+    {
+        if (stack->log[i].index < guarded)
+        {
+            stack->log[kept++] = stack->log[i];
+        }
+    }
+    stack->logCount = kept;
+    return STACK_OK;
+}
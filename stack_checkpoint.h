@@ -0,0 +1,138 @@
+/**
+ * @file stack_checkpoint.h
+ *
+ * @brief An array stack with nested checkpoints that can be rolled back, for backtracking search.
+ *
+ * A checkpoint only records the size of the stack and the length of an undo
+ * log, so taking one is O(1). Rolling back pushes is then O(1) too: the stack
+ * is truncated to the recorded size. Pops need no copying either, because a
+ * popped element stays in the array until a later push overwrites its slot;
+ * only at that moment is the old value written to the undo log, and only for
+ * slots below a checkpoint. Rolling back replays those entries and truncates,
+ * so it costs O(slots overwritten) instead of O(depth). A slot overwritten
+ * again and again, as when pushing and popping around the same depth, is logged
+ * once per checkpoint.
+ *
+ * Checkpoints nest: rolling back to one discards the checkpoints taken after it
+ * and keeps it, ready for the next branch; committing releases the innermost
+ * one and keeps its changes. The array never shrinks, since popped slots may
+ * still be needed by a rollback.
+ */
+
+#ifndef STACK_CHECKPOINT_H
+#define STACK_CHECKPOINT_H
+
+#include "stack.h"
+
+/**
+ * @struct undoEntry
+ * @brief The value a slot held before a push overwrote it.
+ */
+typedef struct undoEntry
+{
+    unsigned index; /**< The slot */
+    int value;      /**< Its previous value */
+} UndoEntry;
+
+/**
+ * @struct stackMark
+ * @brief A checkpoint.
+ */
+typedef struct stackMark
+{
+    unsigned size;     /**< Stack size when the checkpoint was taken */
+    unsigned logCount; /**< Undo log length when the checkpoint was taken */
+    unsigned guarded;  /**< Slots below this one are logged before being overwritten */
+} StackMark;
+
+/**
+ * @struct checkpointStack
+ * @brief An array stack, its undo log and its active checkpoints.
+ */
+typedef struct checkpointStack
+{
+    struct Stack items;    /**< The items themselves */
+    UndoEntry *log;        /**< Overwritten slots, oldest first */
+    unsigned logCount;     /**< Entries in use */
+    unsigned logCapacity;  /**< Entries allocated */
+    StackMark *marks;      /**< Active checkpoints, innermost last */
+    unsigned markCount;    /**< Checkpoints in use */
+    unsigned markCapacity; /**< Checkpoints allocated */
+    unsigned loggedFrom;   /**< First of a run of slots logged since the innermost checkpoint */
+    unsigned loggedTo;     /**< One past the last slot of that run */
+} CheckpointStack;
+
+/**
+ * @brief Initializes an empty stack with no checkpoint.
+ * @param stack A pointer to the stack to initialize.
+ * @param cap The initial capacity.
+ * @param growthFactor The capacity multiplier on overflow; 1 or less keeps the stack fixed-size.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the array could not be allocated.
+ */
+StackStatus initCheckpointStack(CheckpointStack *stack, unsigned cap, double growthFactor);
+
+/**
+ * @brief Frees the memory of the stack, leaving it empty with no checkpoint.
+ * @param stack A pointer to the stack.
+ */
+void destroyCheckpointStack(CheckpointStack *stack);
+
+/**
+ * @brief Pushes an item, logging the slot's old value first if a checkpoint may need it.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_FULL if a fixed-capacity stack is full,
+ *         STACK_NO_MEMORY if memory could not be allocated.
+ */
+StackStatus checkpointPush(CheckpointStack *stack, int item);
+
+/**
+ * @brief Pops the top item; the item stays in its slot until overwritten.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus checkpointTryPop(CheckpointStack *stack, int *out);
+
+/**
+ * @brief Reads the top item.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus checkpointTryPeek(CheckpointStack *stack, int *out);
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+unsigned checkpointSize(CheckpointStack *stack);
+
+/**
+ * @brief Takes a checkpoint in O(1), nested inside those already active.
+ * @param stack A pointer to the stack.
+ * @param mark Receives the checkpoint's handle, to pass to checkpointRollback().
+ * @return STACK_OK on success, STACK_NO_MEMORY if the checkpoint could not be recorded.
+ */
+StackStatus checkpointMark(CheckpointStack *stack, unsigned *mark);
+
+/**
+ * @brief Restores the stack as it was when `mark` was taken.
+ * @details The checkpoints taken after `mark` are discarded; `mark` stays active,
+ *          so it can be rolled back to again. Costs O(1) plus one step per slot
+ *          below the checkpoint overwritten since it was taken.
+ * @param stack A pointer to the stack.
+ * @param mark A handle returned by checkpointMark().
+ * @return STACK_OK on success, STACK_EMPTY if `mark` is not an active checkpoint.
+ */
+StackStatus checkpointRollback(CheckpointStack *stack, unsigned mark);
+
+/**
+ * @brief Releases the innermost checkpoint, keeping every change made since it was taken.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_EMPTY if no checkpoint is active.
+ */
+StackStatus checkpointCommit(CheckpointStack *stack);
+
+#endif /* STACK_CHECKPOINT_H */
@@ -0,0 +1,259 @@
+/**
+ * @file stack_compressed.c
+ *
+ * @brief Implementation of the compressed stack declared in stack_compressed.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack_compressed.h"
+
+/**
+ * @brief Returns the number of bits needed to write `range`.
+ */
+static unsigned bitsFor(uint64_t range)
+{
+    return range == 0 ? 0 : 64 - (unsigned)__builtin_clzll(range);
+}
+
+/**
+ * @brief Returns the number of 64-bit words holding COMPRESSED_BLOCK_ITEMS offsets of `bits` bits.
+ */
+static size_t wordsFor(unsigned bits)
+{
+    return ((size_t)COMPRESSED_BLOCK_ITEMS * bits + 63) / 64;
+}
+
+/**
+ * @brief Packs one block of plain elements.
+ * @details Both encodings are sized first and the narrower one is written; the
+ *          difference encoding is only chosen when narrower, which keeps its
+ *          offsets within 32 bits like those of the plain one.
+ * @param items COMPRESSED_BLOCK_ITEMS elements, bottom first.
+ * @param bytes Receives the size of the allocation.
+ * @return The packed block, or NULL if it could not be allocated.
+ */
+static PackedBlock *packBlock(const int *items, size_t *bytes)
+{
+    int64_t min = items[0], max = items[0];
+    int64_t minDelta = INT64_MAX, maxDelta = INT64_MIN;
+    for (unsigned i = 1; i < COMPRESSED_BLOCK_ITEMS; i++)
+    {
+        int64_t delta = (int64_t)items[i] - items[i - 1];
+        min = items[i] < min ? items[i] : min;
+        max = items[i] > max ? items[i] : max;
+        minDelta = delta < minDelta ? delta : minDelta;
+        maxDelta = delta > maxDelta ? delta : maxDelta;
+    }
+    unsigned plainBits = bitsFor((uint64_t)(max - min));
+    unsigned deltaBits = bitsFor((uint64_t)(maxDelta - minDelta));
+    int delta = deltaBits < plainBits;
+    unsigned bits = delta ? deltaBits : plainBits;
+
+    *bytes = sizeof(PackedBlock) + wordsFor(bits) * sizeof(uint64_t);
+    PackedBlock *block = calloc(1, *bytes);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block->reference = delta ? minDelta : min;
+    block->first = items[0];
+    block->bits = (uint8_t)bits;
+    block->delta = (uint8_t)delta;
+    if (bits == 0)
+    {
+        return block;
+    }
+
+    for (unsigned i = 0; i < COMPRESSED_BLOCK_ITEMS; i++)
+    {
+        int64_t value = delta ? (i == 0 ? minDelta : (int64_t)items[i] - items[i - 1]) : items[i];
+        uint64_t offset = (uint64_t)(value - block->reference);
+        size_t position = (size_t)i * bits;
+        unsigned shift = position % 64;
+        block->words[position / 64] |= offset << shift;
+        if (shift + bits > 64)
+        {
+            block->words[position / 64 + 1] |= offset >> (64 - shift);
+        }
+    }
+    return block;
+}
+
+/**
+ * @brief Unpacks a block into COMPRESSED_BLOCK_ITEMS plain elements, bottom first.
+ */
+static void unpackBlock(const PackedBlock *block, int *items)
+{
+    unsigned bits = block->bits;
+    uint64_t mask = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    int64_t previous = block->first;
+    for (unsigned i = 0; i < COMPRESSED_BLOCK_ITEMS; i++)
+    {
+        uint64_t offset = 0;
+        if (bits != 0)
+        {
+            size_t position = (size_t)i * bits;
+            unsigned shift = position % 64;
+            offset = block->words[position / 64] >> shift;
+            if (shift + bits > 64)
+            {
+                offset |= block->words[position / 64 + 1] << (64 - shift);
+            }
+            offset &= mask;
+        }
+        int64_t value = block->reference + (int64_t)offset;
+        if (block->delta)
+        {
+            // The first offset stands for no difference at all: the bottom element is stored as is
+            value = i == 0 ? block->first : previous + value;
+            previous = value;
+        }
+        items[i] = (int)value;
+    }
+}
+
+/**
+ * @brief Initializes an empty stack.
+ * @param stack A pointer to the stack to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the top buffer could not be allocated.
+ */
+StackStatus initCompressedStack(CompressedStack *stack)
+{
+    memset(stack, 0, sizeof(*stack));
+    stack->hot = malloc(2 * COMPRESSED_BLOCK_ITEMS * sizeof(int));
+    return stack->hot != NULL ? STACK_OK : STACK_NO_MEMORY;
+}
+
+/**
+ * @brief Frees every block of the stack.
+ * @param stack A pointer to the stack.
+ */
+void destroyCompressedStack(CompressedStack *stack)
+{
+    for (size_t i = 0; i < stack->blockCount; i++)
+    {
+        free(stack->blocks[i]);
+    }
+    free(stack->blocks);
+    free(stack->hot);
+    memset(stack, 0, sizeof(*stack));
+}
+
+/**
+ * @brief Packs the lower half of a full top buffer and moves the upper half down.
+ * @return 1 on success, 0 if memory could not be allocated (the stack is unchanged).
+ */
+static int spillHot(CompressedStack *stack)
+{
+    if (stack->blockCount == stack->blockCapacity)
+    {
+        size_t capacity = stack->blockCapacity ? stack->blockCapacity * 2 : 16;
+        PackedBlock **blocks = realloc(stack->blocks, capacity * sizeof(PackedBlock *));
+        if (blocks == NULL)
+        {
+            return 0;
+        }
+        stack->blocks = blocks;
+        stack->blockCapacity = capacity;
+    }
+    size_t bytes;
+    PackedBlock *block = packBlock(stack->hot, &bytes);
+    if (block == NULL)
+    {
+        return 0;
+    }
+    stack->blocks[stack->blockCount++] = block;
+    stack->packedBytes += bytes;
+    memcpy(stack->hot, stack->hot + COMPRESSED_BLOCK_ITEMS, COMPRESSED_BLOCK_ITEMS * sizeof(int));
+    stack->hotCount = COMPRESSED_BLOCK_ITEMS;
+    return 1;
+}
+
+/**
+ * @brief Unpacks the most recent block into an empty top buffer.
+ * @return 1 on success, 0 if there is no packed block left.
+ */
+static int refillHot(CompressedStack *stack)
+{
+    if (stack->blockCount == 0)
+    {
+        return 0;
+    }
+    PackedBlock *block = stack->blocks[--stack->blockCount];
+    unpackBlock(block, stack->hot);
+    stack->packedBytes -= sizeof(PackedBlock) + wordsFor(block->bits) * sizeof(uint64_t);
+    free(block);
+    stack->hotCount = COMPRESSED_BLOCK_ITEMS;
+    return 1;
+}
+
+/**
+ * @brief Pushes an item, packing the lower half of the top buffer first if it is full.
+ * @param stack A pointer to the stack.
+ * @param data The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a packed block could not be allocated.
+ */
+StackStatus compressedPush(CompressedStack *stack, int data)
+{
+    if (STACK_UNLIKELY(stack->hotCount == 2 * COMPRESSED_BLOCK_ITEMS) && !spillHot(stack))
+    {
+        return STACK_NO_MEMORY;
+    }
+    stack->hot[stack->hotCount++] = data;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item, unpacking the most recent block first if the top buffer is empty.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus compressedTryPop(CompressedStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->hotCount == 0) && !refillHot(stack))
+    {
+        return STACK_EMPTY;
+    }
+    *out = stack->hot[--stack->hotCount];
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item, unpacking the most recent block first if the top buffer is empty.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus compressedTryPeek(CompressedStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->hotCount == 0) && !refillHot(stack))
+    {
+        return STACK_EMPTY;
+    }
+    *out = stack->hot[stack->hotCount - 1];
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+size_t compressedSize(CompressedStack *stack)
+{
+    return stack->blockCount * COMPRESSED_BLOCK_ITEMS + stack->hotCount;
+}
+
+/**
+ * @brief Returns the heap memory the stack holds, to compare with 4 bytes per element.
+ * @param stack A pointer to the stack.
+ * @return Bytes allocated for the top buffer, the block table and the packed blocks.
+ */
+size_t compressedBytes(CompressedStack *stack)
+{
+    return 2 * COMPRESSED_BLOCK_ITEMS * sizeof(int) + stack->blockCapacity * sizeof(PackedBlock *) +
+           stack->packedBytes;
+}
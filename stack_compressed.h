@@ -0,0 +1,114 @@
+/**
+ * @file stack_compressed.h
+ *
+ * @brief A stack of ints stored in bit-packed blocks, for very large stacks of small or monotonic values.
+ *
+ * Only the top of the stack is kept as plain ints, in a buffer of two blocks of
+ * COMPRESSED_BLOCK_ITEMS elements. When a push finds the buffer full, its lower
+ * block is packed and the upper one moved down; when a pop finds it empty, the
+ * most recent packed block is unpacked into it. Either costs O(COMPRESSED_BLOCK_ITEMS)
+ * and buys at least COMPRESSED_BLOCK_ITEMS plain pushes or pops before the next
+ * one, so push, pop and peek stay amortized O(1) and only the top block is ever
+ * decoded.
+ *
+ * Each block is packed with frame-of-reference coding, in whichever of two forms
+ * is smaller: the values as offsets from the block's minimum, or the differences
+ * between consecutive values as offsets from the smallest difference. Either way
+ * every offset takes the same number of bits, just enough for the largest one.
+ * Values spanning a range of 256 take one byte each; a run increasing by a
+ * constant step takes no bits at all beyond the block header.
+ */
+
+#ifndef STACK_COMPRESSED_H
+#define STACK_COMPRESSED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def COMPRESSED_BLOCK_ITEMS
+ * @brief Elements per packed block.
+ */
+#define COMPRESSED_BLOCK_ITEMS 1024
+
+/**
+ * @struct packedBlock
+ * @brief A block of COMPRESSED_BLOCK_ITEMS elements, bottom to top, packed into `bits`-bit offsets.
+ */
+typedef struct packedBlock
+{
+    int64_t reference; /**< Minimum value, or minimum difference when `delta` is set */
+    int first;         /**< The bottom element, when `delta` is set */
+    uint8_t bits;      /**< Width of each offset, 0 to 32 */
+    uint8_t delta;     /**< Non-zero if the offsets encode differences between neighbours */
+    uint64_t words[];  /**< The offsets, packed least significant bit first */
+} PackedBlock;
+
+/**
+ * @struct compressedStack
+ * @brief An unbounded stack keeping everything below its top two blocks packed.
+ */
+typedef struct compressedStack
+{
+    int *hot;              /**< Plain elements at the top, room for two blocks */
+    unsigned hotCount;     /**< Elements in `hot` */
+    PackedBlock **blocks;  /**< Packed blocks, bottom of the stack first */
+    size_t blockCount;     /**< Packed blocks in use */
+    size_t blockCapacity;  /**< Room in `blocks` */
+    size_t packedBytes;    /**< Bytes allocated for the packed blocks */
+} CompressedStack;
+
+/**
+ * @brief Initializes an empty stack.
+ * @param stack A pointer to the stack to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the top buffer could not be allocated.
+ */
+StackStatus initCompressedStack(CompressedStack *stack);
+
+/**
+ * @brief Frees every block of the stack.
+ * @param stack A pointer to the stack.
+ */
+void destroyCompressedStack(CompressedStack *stack);
+
+/**
+ * @brief Pushes an item, packing the lower half of the top buffer first if it is full.
+ * @param stack A pointer to the stack.
+ * @param data The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a packed block could not be allocated.
+ */
+StackStatus compressedPush(CompressedStack *stack, int data);
+
+/**
+ * @brief Pops the top item, unpacking the most recent block first if the top buffer is empty.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus compressedTryPop(CompressedStack *stack, int *out);
+
+/**
+ * @brief Reads the top item, unpacking the most recent block first if the top buffer is empty.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus compressedTryPeek(CompressedStack *stack, int *out);
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+size_t compressedSize(CompressedStack *stack);
+
+/**
+ * @brief Returns the heap memory the stack holds, to compare with 4 bytes per element.
+ * @param stack A pointer to the stack.
+ * @return Bytes allocated for the top buffer, the block table and the packed blocks.
+ */
+size_t compressedBytes(CompressedStack *stack);
+
+#endif /* STACK_COMPRESSED_H */
@@ -0,0 +1,317 @@
+/**
+ * @file stack_dump.c
+ *
+ * @brief Implementation of the stack dumps declared in stack_dump.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stack_dump.h"
+
+#define MAX_ROW_BYTES 48 /**< Longest text one element can produce, separators included */
+
+/**
+ * @brief The decimal digits of 00 to 99, two characters each.
+ */
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * @brief Writes an unsigned number in decimal, two digits per step.
+ * @param out Room for at least 20 characters.
+ * @param value The number.
+ * @return The number of characters written.
+ */
+static size_t formatUnsigned(char *out, unsigned long long value)
+{
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    while (value >= 100)
+    {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if (value >= 10)
+    {
+        *--p = digitPairs[value * 2 + 1];
+        *--p = digitPairs[value * 2];
+    }
+    else
+    {
+        *--p = (char)('0' + value);
+    }
+    size_t length = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(out, p, length);
+    return length;
+}
+
+/**
+ * @brief Writes an int in decimal.
+ * @param out Room for at least 11 characters.
+ * @param value The number; INT_MIN is handled.
+ * @return The number of characters written.
+ */
+size_t dumpFormatInt(char *out, int value)
+{
+    if (value < 0)
+    {
+        *out = '-';
+        return 1 + formatUnsigned(out + 1, 0ull - (unsigned long long)(long long)value);
+    }
+    return formatUnsigned(out, (unsigned long long)value);
+}
+
+/**
+ * @struct dumper
+ * @brief State of one dump in progress.
+ */
+typedef struct dumper
+{
+    char *buf;          /**< Output buffer of DUMP_BUFFER_BYTES */
+    size_t used;        /**< Bytes waiting in `buf` */
+    int fd;             /**< Destination */
+    DumpFormat format;  /**< Layout of the output */
+    size_t count;       /**< Elements written so far */
+    size_t limit;       /**< Elements to write before stopping */
+    size_t size;        /**< Elements on the stack */
+    StackStatus status; /**< First error met, STACK_OK until then */
+} Dumper;
+
+/**
+ * @brief Writes out the buffered text.
+ * @param d A pointer to the dump.
+ */
+static void flushDump(Dumper *d)
+{
+    size_t done = 0;
+    while (d->status == STACK_OK && done < d->used)
+    {
+        ssize_t n = write(d->fd, d->buf + done, d->used - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            d->status = STACK_IO_ERROR;
+        }
+        else
+        {
+            done += (size_t)n;
+        }
+    }
+    d->used = 0;
+}
+
+/**
+ * @brief Appends a string to the output.
+ * @param d A pointer to the dump.
+ * @param text The string, shorter than DUMP_BUFFER_BYTES.
+ */
+static void appendText(Dumper *d, const char *text)
+{
+    size_t length = strlen(text);
+    if (d->used + length > DUMP_BUFFER_BYTES)
+    {
+        flushDump(d);
+    }
+    memcpy(d->buf + d->used, text, length);
+    d->used += length;
+}
+
+/**
+ * @brief Prepares a dump: opens its destination, allocates the buffer and writes the preamble.
+ * @param d A pointer to the dump to initialize.
+ * @param options The caller's options, or NULL.
+ * @param size The number of elements on the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY or STACK_IO_ERROR otherwise.
+ */
+static StackStatus beginDump(Dumper *d, const DumpOptions *options, size_t size)
+{
+    DumpOptions defaults = { DUMP_LINES, 0, STDOUT_FILENO, NULL };
+    if (options == NULL)
+    {
+        options = &defaults;
+    }
+    *d = (Dumper){ NULL, 0, options->fd, options->format, 0, size, size, STACK_OK };
+    if (options->limit != 0 && options->limit < size)
+    {
+        d->limit = options->limit;
+    }
+
+    d->buf = malloc(DUMP_BUFFER_BYTES);
+    if (d->buf == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    if (options->path != NULL)
+    {
+        d->fd = open(options->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (d->fd < 0)
+        {
+            free(d->buf);
+            return STACK_IO_ERROR;
+        }
+    }
+
+    if (d->format == DUMP_CSV)
+    {
+        appendText(d, "position,value\n");
+    }
+    else if (d->format == DUMP_JSON)
+    {
+        char size[24];
+        size[formatUnsigned(size, d->size)] = '\0';
+        appendText(d, "{\"size\":");
+        appendText(d, size);
+        appendText(d, ",\"items\":[");
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Appends one element in the layout of the dump.
+ * @param d A pointer to the dump.
+ * @param value The element.
+ * @return 1 while more elements are wanted, 0 once the limit is reached.
+ */
+static int dumpItem(Dumper *d, int value)
+{
+    if (d->used + MAX_ROW_BYTES > DUMP_BUFFER_BYTES)
+    {
+        flushDump(d);
+    }
+    char *p = d->buf + d->used;
+    if (d->format == DUMP_CSV)
+    {
+        p += formatUnsigned(p, d->count);
+        *p++ = ',';
+    }
+    else if (d->format == DUMP_JSON && d->count > 0)
+    {
+        *p++ = ',';
+    }
+    p += dumpFormatInt(p, value);
+    if (d->format != DUMP_JSON)
+    {
+        *p++ = '\n';
+    }
+    d->used = (size_t)(p - d->buf);
+    return ++d->count < d->limit && d->status == STACK_OK;
+}
+
+/**
+ * @brief Writes the closing text, flushes the buffer and releases the dump's resources.
+ * @param d A pointer to the dump.
+ * @param options The caller's options, or NULL.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+static StackStatus endDump(Dumper *d, const DumpOptions *options)
+{
+    if (d->format == DUMP_JSON)
+    {
+        appendText(d, d->count < d->size ? "],\"truncated\":true}\n" : "],\"truncated\":false}\n");
+    }
+    else if (d->format == DUMP_LINES && d->count < d->size)
+    {
+        char rest[24];
+        rest[formatUnsigned(rest, d->size - d->count)] = '\0';
+        appendText(d, "... ");
+        appendText(d, rest);
+        appendText(d, " more\n");
+    }
+    flushDump(d);
+    free(d->buf);
+    if (options != NULL && options->path != NULL && close(d->fd) != 0 && d->status == STACK_OK)
+    {
+        d->status = STACK_IO_ERROR;
+    }
+    return d->status;
+}
+
+/**
+ * @brief Dumps an array stack.
+ * @param stack A pointer to the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY or STACK_IO_ERROR otherwise.
+ */
+StackStatus dumpStack(struct Stack* stack, const DumpOptions* options)
+{
+    Dumper d;
+    StackStatus status = beginDump(&d, options, stackSize(stack));
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    int more = 1;
+    for (int i = stack->top; i >= 0 && more; i--)
+    {
+        more = dumpItem(&d, stack->array[i]);
+    }
+    return endDump(&d, options);
+}
+
+/**
+ * @brief Dumps a linked-list stack.
+ * @details The list is walked twice: once to count it, once to dump it.
+ * @param top A pointer to the top of the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY or STACK_IO_ERROR otherwise.
+ */
+StackStatus listDump(Node *top, const DumpOptions *options)
+{
+    Dumper d;
+    StackStatus status = beginDump(&d, options, listSize(top));
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    int more = 1;
+    for (Node *node = top; node != NULL && more; node = node->link)
+    {
+        more = dumpItem(&d, node->data);
+    }
+    return endDump(&d, options);
+}
+
+/**
+ * @brief Dumps an unrolled stack.
+ * @param stack A pointer to the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY or STACK_IO_ERROR otherwise.
+ */
+StackStatus unrolledDump(UnrolledStack *stack, const DumpOptions *options)
+{
+    Dumper d;
+    StackStatus status = beginDump(&d, options, unrolledSize(stack));
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    int more = 1;
+    for (Block *block = stack->top; block != NULL && more; block = block->link)
+    {
+        for (int i = block->count - 1; i >= 0 && more; i--)
+        {
+            more = dumpItem(&d, block->items[i]);
+        }
+    }
+    return endDump(&d, options);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file stack_dump.h
+ *
+ * @brief Fast text dumps of a stack, for debugging and diagnostics on large stacks.
+ *
+ * Printing one element per printf() call spends most of its time inside stdio.
+ * These routines format the elements themselves, two digits at a time from a
+ * lookup table, into a DUMP_BUFFER_BYTES buffer that reaches the file descriptor
+ * with one write() per full buffer; a stack of up to about 100,000 elements is
+ * written with a single system call. Elements are listed top of the stack first.
+ *
+ * Nothing is written through stdio, so a caller mixing the two on the same
+ * descriptor should fflush() its stream first.
+ */
+
+#ifndef STACK_DUMP_H
+#define STACK_DUMP_H
+
+#include <stddef.h>
+
+#include "stack.h"
+
+/**
+ * @def DUMP_BUFFER_BYTES
+ * @brief Size of the output buffer.
+ */
+#define DUMP_BUFFER_BYTES (1 << 20)
+
+/**
+ * @enum dumpFormat
+ * @brief Layout of a dump.
+ */
+typedef enum dumpFormat
+{
+    DUMP_LINES = 0, /**< One element per line, as display() prints them */
+    DUMP_CSV,       /**< A `position,value` header, then one row per element; position 0 is the top */
+    DUMP_JSON       /**< `{"size":N,"items":[...],"truncated":false}` on one line */
+} DumpFormat;
+
+/**
+ * @struct dumpOptions
+ * @brief What to dump and where to.
+ * @details Pass NULL instead of a pointer to options for every element, one per
+ *          line, to standard output.
+ */
+typedef struct dumpOptions
+{
+    DumpFormat format; /**< Layout of the output */
+    size_t limit;      /**< Maximum number of elements to dump, 0 for all */
+    int fd;            /**< Descriptor to write to when `path` is NULL */
+    const char *path;  /**< File to create or truncate and write to instead of `fd`, or NULL */
+} DumpOptions;
+
+/**
+ * @brief Dumps an array stack.
+ * @param stack A pointer to the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be
+ *         allocated, STACK_IO_ERROR if the file could not be opened or written.
+ */
+StackStatus dumpStack(struct Stack* stack, const DumpOptions* options);
+
+/**
+ * @brief Dumps a linked-list stack.
+ * @param top A pointer to the top of the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be
+ *         allocated, STACK_IO_ERROR if the file could not be opened or written.
+ */
+StackStatus listDump(Node *top, const DumpOptions *options);
+
+/**
+ * @brief Dumps an unrolled stack.
+ * @param stack A pointer to the stack.
+ * @param options What to dump and where to, or NULL for the defaults.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be
+ *         allocated, STACK_IO_ERROR if the file could not be opened or written.
+ */
+StackStatus unrolledDump(UnrolledStack *stack, const DumpOptions *options);
+
+/**
+ * @brief Writes an int in decimal with the dumps' digit-pair formatter.
+ * @param out Room for at least 11 characters; no terminator is added.
+ * @param value The number.
+ * @return The number of characters written.
+ */
+size_t dumpFormatInt(char *out, int value);
+
+#endif /* STACK_DUMP_H */
@@ -0,0 +1,186 @@
+/**
+ * @file stack_generic.h
+ *
+ * @brief Type-specialized array stacks generated by a macro.
+ *
+ * `DEFINE_STACK(name, T)` expands to a growable array stack of `T` stored by value
+ * and contiguously, plus `static inline` operations prefixed with `name`:
+ *
+ *     DEFINE_STACK(IdStack, uint64_t)
+ *
+ *     IdStack ids = {0};              // an empty stack, no allocation yet
+ *     IdStackPush(&ids, 42);
+ *     uint64_t id;
+ *     while (IdStackTryPop(&ids, &id) == STACK_OK) { ... }
+ *     IdStackFree(&ids);
+ *
+ * Elements are moved with plain assignment and runs of elements with memcpy, so
+ * `T` can be any object type: integers, doubles, pointers or small structs.
+ * Expand the macro once per element type, at file scope.
+ */
+
+#ifndef STACK_GENERIC_H
+#define STACK_GENERIC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack.h"
+
+/**
+ * @def GENERIC_STACK_MIN_CAPACITY
+ * @brief Capacity of the first array allocated for an empty generic stack.
+ */
+#define GENERIC_STACK_MIN_CAPACITY 8
+
+/**
+ * @def DEFINE_STACK
+ * @brief Defines the stack type `name` holding elements of type `T` and its operations.
+ *
+ * A zero-initialized `name` is an empty stack. The array doubles when full, so
+ * push is amortized O(1).
+ *
+ * @param name The name of the generated type, also the prefix of its functions.
+ * @param T The element type.
+ */
+#define DEFINE_STACK(name, T)                                                         \
+                                                                                      \
+typedef struct name {                                                                 \
+    T* array;          /**< Elements, bottom of the stack first */                    \
+    size_t size;       /**< Number of elements on the stack */                        \
+    size_t capacity;   /**< Number of elements the array can hold */                  \
+} name;                                                                               \
+                                                                                      \
+/** @brief Initializes an empty stack with room for `cap` elements. */                \
+static inline StackStatus name##Init(name* stack, size_t cap) {                       \
+    stack->size = 0;                                                                  \
+    stack->capacity = 0;                                                              \
+    stack->array = NULL;                                                              \
+    if (cap == 0)                                                                     \
+        return STACK_OK;                                                              \
+    if (cap > SIZE_MAX / sizeof(T))                                                   \
+        return STACK_NO_MEMORY;                                                       \
+    stack->array = malloc(cap * sizeof(T));                                           \
+    if (stack->array == NULL)                                                         \
+        return STACK_NO_MEMORY;                                                       \
+    stack->capacity = cap;                                                            \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Frees the array of the stack, leaving it empty. */                         \
+static inline void name##Free(name* stack) {                                          \
+    free(stack->array);                                                               \
+    stack->array = NULL;                                                              \
+    stack->size = 0;                                                                  \
+    stack->capacity = 0;                                                              \
+}                                                                                     \
+                                                                                      \
+/** @brief Ensures the stack can hold `cap` elements without reallocating. */         \
+static inline StackStatus name##Reserve(name* stack, size_t cap) {                    \
+    if (cap <= stack->capacity)                                                       \
+        return STACK_OK;                                                              \
+    if (cap > SIZE_MAX / sizeof(T))                                                   \
+        return STACK_NO_MEMORY;                                                       \
+    T* array = realloc(stack->array, cap * sizeof(T));                                \
+    if (array == NULL)                                                                \
+        return STACK_NO_MEMORY;                                                       \
+    stack->array = array;                                                             \
+    stack->capacity = cap;                                                            \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Grows the array geometrically so that `extra` more elements fit. */        \
+static inline StackStatus name##Grow(name* stack, size_t extra) {                     \
+    if (extra > SIZE_MAX - stack->size ||                                             \
+        stack->capacity > SIZE_MAX / 2 / sizeof(T))                                   \
+        return STACK_NO_MEMORY; /* Neither the size nor the doubling may wrap */      \
+    size_t cap = stack->capacity ? stack->capacity * 2 : GENERIC_STACK_MIN_CAPACITY;  \
+    if (cap < stack->size + extra)                                                    \
+        cap = stack->size + extra;                                                    \
+    return name##Reserve(stack, cap);                                                 \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns the number of elements on the stack. */                            \
+static inline size_t name##Size(const name* stack) {                                  \
+    return stack->size;                                                               \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns 1 if the stack is empty, 0 otherwise. */                           \
+static inline int name##IsEmpty(const name* stack) {                                  \
+    return stack->size == 0;                                                          \
+}                                                                                     \
+                                                                                      \
+/** @brief Pushes a copy of `item`, growing the array when full. */                   \
+static inline StackStatus name##Push(name* stack, T item) {                           \
+    if (STACK_UNLIKELY(stack->size == stack->capacity) &&                             \
+        name##Grow(stack, 1) != STACK_OK)                                             \
+        return STACK_NO_MEMORY;                                                       \
+    stack->array[stack->size++] = item;                                               \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Pops the top element into `*out`; STACK_EMPTY if there is none. */         \
+static inline StackStatus name##TryPop(name* stack, T* out) {                         \
+    if (STACK_UNLIKELY(stack->size == 0))                                             \
+        return STACK_EMPTY;                                                           \
+    *out = stack->array[--stack->size];                                               \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Copies the top element into `*out`; STACK_EMPTY if there is none. */       \
+static inline StackStatus name##TryPeek(const name* stack, T* out) {                  \
+    if (STACK_UNLIKELY(stack->size == 0))                                             \
+        return STACK_EMPTY;                                                           \
+    *out = stack->array[stack->size - 1];                                             \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Pops the top element of a stack the caller knows is not empty. */          \
+static inline T name##PopUnchecked(name* stack) {                                     \
+    return stack->array[--stack->size];                                               \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns a pointer to the top element, or NULL if the stack is empty. */    \
+static inline T* name##Top(name* stack) {                                             \
+    return stack->size ? &stack->array[stack->size - 1] : NULL;                       \
+}                                                                                     \
+                                                                                      \
+/** @brief Pushes `n` elements with one memcpy; `items[n - 1]` ends up on top. */     \
+static inline StackStatus name##PushN(name* stack, T const* items, size_t n) {        \
+    if (n == 0)                                                                       \
+        return STACK_OK;                                                              \
+    if (n > stack->capacity - stack->size && name##Grow(stack, n) != STACK_OK)        \
+        return STACK_NO_MEMORY;                                                       \
+    memcpy(stack->array + stack->size, items, n * sizeof(T));                         \
+    stack->size += n;                                                                 \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Pops up to `n` elements into `out`, top first; returns how many. */        \
+static inline size_t name##PopN(name* stack, T* out, size_t n) {                      \
+    if (n > stack->size)                                                              \
+        n = stack->size;                                                              \
+    if (n == 0)                                                                       \
+        return 0;                                                                     \
+    T const* src = stack->array + stack->size - 1;                                    \
+    for (size_t i = 0; i < n; i++)                                                    \
+        out[i] = *(src - i);                                                          \
+    stack->size -= n;                                                                 \
+    return n;                                                                         \
+}                                                                                     \
+                                                                                      \
+/** @brief Reverses the stack in place. */                                            \
+static inline void name##Reverse(name* stack) {                                       \
+    if (stack->size < 2)                                                              \
+        return;                                                                       \
+    T* lo = stack->array;                                                             \
+    T* hi = stack->array + stack->size - 1;                                           \
+    while (lo < hi) {                                                                 \
+        T item = *lo;                                                                 \
+        *lo++ = *hi;                                                                  \
+        *hi-- = item;                                                                 \
+    }                                                                                 \
+}
+
+#endif /* STACK_GENERIC_H */
@@ -0,0 +1,568 @@
+/**
+ * @file stack_lockfree.c
+ *
+ * @brief Implementation of the lock-free stack declared in stack_lockfree.h.
+ */
+
+#include <stdlib.h>
+
+#include "stack_lockfree.h"
+#include "stack_stats.h"
+
+/**
+ * @def NO_NODE
+ * @brief Index standing for "no node"; index 0 is never handed out.
+ */
+#define NO_NODE 0
+
+/**
+ * @brief Packs a tag and a node index into one CAS-able word.
+ * @param tag The update counter.
+ * @param index The node index.
+ * @return The packed word.
+ */
+static uint64_t pack(uint32_t tag, uint32_t index)
+{
+    return ((uint64_t)tag << 32) | index;
+}
+
+/**
+ * @brief Extracts the node index from a packed word.
+ * @param word The packed word.
+ * @return The node index.
+ */
+static uint32_t indexOf(uint64_t word)
+{
+    return (uint32_t)word;
+}
+
+/**
+ * @brief Extracts the tag from a packed word.
+ * @param word The packed word.
+ * @return The tag.
+ */
+static uint32_t tagOf(uint64_t word)
+{
+    return (uint32_t)(word >> 32);
+}
+
+/**
+ * @brief Finds the node with the given index.
+ * @details The node's chunk must already be allocated.
+ * @param stack A pointer to the stack.
+ * @param index The node index.
+ * @return A pointer to the node.
+ */
+static LockFreeNode *nodeAt(LockFreeStack *stack, uint32_t index)
+{
+    LockFreeNode *chunk = atomic_load_explicit(&stack->chunks[index / LOCKFREE_CHUNK_NODES],
+                                               memory_order_acquire);
+    return &chunk[index % LOCKFREE_CHUNK_NODES];
+}
+
+/**
+ * @brief Links a node on top of a tagged list.
+ * @param stack A pointer to the stack owning the node.
+ * @param head The top word of the list.
+ * @param index The index of the node to link.
+ */
+static void linkNode(LockFreeStack *stack, _Atomic uint64_t *head, uint32_t index)
+{
+    LockFreeNode *node = nodeAt(stack, index);
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+    do
+    {
+        atomic_store_explicit(&node->next, indexOf(old), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(head, &old, pack(tagOf(old) + 1, index),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * @brief Makes a single attempt to link a node on top of a tagged list.
+ * @param stack A pointer to the stack owning the node.
+ * @param head The top word of the list.
+ * @param index The index of the node to link.
+ * @return 1 if the node was linked, 0 if another thread changed the list first.
+ */
+static int tryLinkNode(LockFreeStack *stack, _Atomic uint64_t *head, uint32_t index)
+{
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+    atomic_store_explicit(&nodeAt(stack, index)->next, indexOf(old), memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(head, &old, pack(tagOf(old) + 1, index),
+                                                   memory_order_release, memory_order_relaxed);
+}
+
+/**
+ * @brief Makes a single attempt to unlink the top node of a tagged list.
+ * @param stack A pointer to the stack owning the nodes.
+ * @param head The top word of the list.
+ * @param index Receives the unlinked node, or NO_NODE if the list was empty.
+ * @return 1 if the attempt completed, 0 if another thread changed the list first.
+ */
+static int tryUnlinkNode(LockFreeStack *stack, _Atomic uint64_t *head, uint32_t *index)
+{
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    *index = indexOf(old);
+    if (*index == NO_NODE)
+    {
+        return 1;
+    }
+    uint32_t next = atomic_load_explicit(&nodeAt(stack, *index)->next, memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(head, &old, pack(tagOf(old) + 1, next),
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+/**
+ * @brief Unlinks the top node of a tagged list.
+ * @details The node may be popped and re-pushed by another thread between reading
+ *          its `next` and the CAS; the tag changes on every update, so the CAS then
+ *          fails and the loop retries with the new top.
+ * @param stack A pointer to the stack owning the nodes.
+ * @param head The top word of the list.
+ * @return The index of the unlinked node, or NO_NODE if the list was empty.
+ */
+static uint32_t unlinkNode(LockFreeStack *stack, _Atomic uint64_t *head)
+{
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+    for (;;)
+    {
+        uint32_t index = indexOf(old);
+        if (index == NO_NODE)
+        {
+            return NO_NODE;
+        }
+        uint32_t next = atomic_load_explicit(&nodeAt(stack, index)->next, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(head, &old, pack(tagOf(old) + 1, next),
+                                                  memory_order_acquire, memory_order_acquire))
+        {
+            return index;
+        }
+    }
+}
+
+/**
+ * @brief Makes sure the chunk holding node `index` is allocated.
+ * @details The first thread to reach a new chunk allocates it; racing threads keep the winner's.
+ * @param stack A pointer to the stack.
+ * @param index A node index below the maximum.
+ * @return 1 if the chunk exists, 0 if it could not be allocated.
+ */
+static int ensureChunk(LockFreeStack *stack, uint32_t index)
+{
+    LockFreeNode *_Atomic *slot = &stack->chunks[index / LOCKFREE_CHUNK_NODES];
+    if (atomic_load_explicit(slot, memory_order_acquire) != NULL)
+    {
+        return 1;
+    }
+    LockFreeNode *chunk = malloc(LOCKFREE_CHUNK_NODES * sizeof(LockFreeNode));
+    if (chunk == NULL)
+    {
+        return 0;
+    }
+    LockFreeNode *expected = NULL;
+    if (!atomic_compare_exchange_strong_explicit(slot, &expected, chunk,
+                                                 memory_order_acq_rel, memory_order_acquire))
+    {
+        free(chunk);
+    }
+    return 1;
+}
+
+/**
+ * @brief Hands out an unused node, recycling one if possible.
+ * @details A fresh index is claimed only once its chunk exists, so a failed chunk
+ *          allocation gives nothing away and a later call can try again.
+ * @param stack A pointer to the stack.
+ * @return The index of the node, or NO_NODE if the stack is out of nodes or memory.
+ */
+static uint32_t allocNode(LockFreeStack *stack)
+{
+    uint32_t index = unlinkNode(stack, &stack->freeTop);
+    if (index != NO_NODE)
+    {
+        return index;
+    }
+
+    index = atomic_load_explicit(&stack->nextIndex, memory_order_relaxed);
+    do
+    {
+        if (index >= (uint32_t)LOCKFREE_CHUNK_NODES * LOCKFREE_MAX_CHUNKS || !ensureChunk(stack, index))
+        {
+            return NO_NODE;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&stack->nextIndex, &index, index + 1,
+                                                    memory_order_relaxed, memory_order_relaxed));
+    return index;
+}
+
+/**
+ * @brief Initializes an empty lock-free stack.
+ * @param stack A pointer to the stack to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the chunk table could not be allocated.
+ */
+StackStatus initLockFreeStack(LockFreeStack *stack)
+{
+    stack->chunks = calloc(LOCKFREE_MAX_CHUNKS, sizeof(*stack->chunks));
+    if (stack->chunks == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    atomic_init(&stack->top, pack(0, NO_NODE));
+    atomic_init(&stack->freeTop, pack(0, NO_NODE));
+    atomic_init(&stack->nextIndex, NO_NODE + 1);
+#ifdef STACK_STATS
+    stack->stats = NULL;
+#endif
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees every chunk of the stack and its chunk table.
+ * @param stack A pointer to the stack.
+ */
+void destroyLockFreeStack(LockFreeStack *stack)
+{
+    for (size_t i = 0; i < LOCKFREE_MAX_CHUNKS; i++)
+    {
+        free(atomic_load_explicit(&stack->chunks[i], memory_order_relaxed));
+    }
+    free(stack->chunks);
+    stack->chunks = NULL;
+}
+
+/**
+ * @brief Pushes an item onto the stack; safe to call from any thread.
+ * @param stack A pointer to the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus lockFreePush(LockFreeStack *stack, int data)
+{
+    STACK_STATS_BEGIN(stack->stats, STATS_PUSH, timer);
+    uint32_t index = allocNode(stack);
+    if (STACK_UNLIKELY(index == NO_NODE))
+    {
+        STACK_STATS_EVENT(stack->stats, STATS_NO_MEMORY);
+        return STACK_NO_MEMORY;
+    }
+    nodeAt(stack, index)->data = data;
+    linkNode(stack, &stack->top, index);
+    STACK_STATS_END(timer, STATS_PUSH, 1, 0);
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top element from the stack; safe to call from any thread.
+ * @details Once unlinked the node belongs to this thread alone, so its data is read
+ *          after the CAS and the node is then recycled through the free list.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus lockFreeTryPop(LockFreeStack *stack, int *out)
+{
+    STACK_STATS_BEGIN(stack->stats, STATS_POP, timer);
+    uint32_t index = unlinkNode(stack, &stack->top);
+    if (STACK_UNLIKELY(index == NO_NODE))
+    {
+        STACK_STATS_EVENT(stack->stats, STATS_UNDERFLOW);
+        return STACK_EMPTY;
+    }
+    *out = nodeAt(stack, index)->data;
+    linkNode(stack, &stack->freeTop, index);
+    STACK_STATS_END(timer, STATS_POP, 1, 0);
+    return STACK_OK;
+}
+
+/**
+ * @brief Checks if the stack is empty.
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int lockFreeIsEmpty(LockFreeStack *stack)
+{
+    return indexOf(atomic_load_explicit(&stack->top, memory_order_acquire)) == NO_NODE;
+}
+
+/* ---------------------------------------------------------------------------
+ * Elimination backoff
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @def SLOT_FREE
+ * @brief State of a slot nobody is using.
+ */
+#define SLOT_FREE 0
+
+/**
+ * @def SLOT_TAKEN
+ * @brief State left by a pop that took the value offered in the slot.
+ */
+#define SLOT_TAKEN ((uint64_t)1 << 32)
+
+/**
+ * @def SLOT_OFFER
+ * @brief Tag marking a slot holding a pending push's value in its low half.
+ */
+#define SLOT_OFFER ((uint64_t)2 << 32)
+
+/**
+ * @def MIN_SPINS
+ * @brief Shortest wait the adaptive backoff narrows a push's wait in a slot to.
+ */
+#define MIN_SPINS 8
+
+/**
+ * @struct backoff
+ * @brief How much of the elimination array a thread currently uses, and how long it waits there.
+ * @details Collisions in a slot mean the thread meets too many others there, so
+ *          both grow; an offer nobody took or a slot with nothing to take means
+ *          partners are scarce, so both shrink and the remaining ones meet more often.
+ */
+typedef struct backoff
+{
+    unsigned range; /**< Slots in use, from the start of the array; 0 until first used */
+    unsigned spins; /**< Polls a push waits in a slot */
+} Backoff;
+
+/**
+ * @brief The calling thread's backoff, shared by every elimination stack it uses.
+ */
+static _Thread_local Backoff threadBackoff;
+
+/**
+ * @brief Returns the calling thread's backoff, clamped to the bounds of a stack.
+ * @param stack A pointer to the stack.
+ * @return A pointer to the backoff.
+ */
+static Backoff *currentBackoff(EliminationStack *stack)
+{
+    Backoff *backoff = &threadBackoff;
+    unsigned minSpins = stack->spins < MIN_SPINS ? stack->spins : MIN_SPINS;
+    if (backoff->range == 0 || backoff->range > stack->width)
+    {
+        backoff->range = backoff->range == 0 ? 1 : stack->width;
+    }
+    if (backoff->spins < minSpins || backoff->spins > stack->spins)
+    {
+        backoff->spins = backoff->spins < minSpins ? minSpins : stack->spins;
+    }
+    return backoff;
+}
+
+/**
+ * @brief Doubles the range and the wait after a collision, up to the stack's width and spins.
+ * @param stack A pointer to the stack.
+ * @param backoff The backoff returned by currentBackoff().
+ */
+static void widenBackoff(EliminationStack *stack, Backoff *backoff)
+{
+    backoff->range = backoff->range * 2 < stack->width ? backoff->range * 2 : stack->width;
+    backoff->spins = backoff->spins * 2 < stack->spins ? backoff->spins * 2 : stack->spins;
+}
+
+/**
+ * @brief Halves the range and the wait after an exchange found no partner.
+ * @param stack A pointer to the stack.
+ * @param backoff The backoff returned by currentBackoff().
+ */
+static void narrowBackoff(EliminationStack *stack, Backoff *backoff)
+{
+    unsigned minSpins = stack->spins < MIN_SPINS ? stack->spins : MIN_SPINS;
+    backoff->range = backoff->range > 1 ? backoff->range / 2 : 1;
+    backoff->spins = backoff->spins / 2 > minSpins ? backoff->spins / 2 : minSpins;
+}
+
+/**
+ * @brief Picks a pseudo-random slot so that colliding threads spread over the slots in use.
+ * @param stack A pointer to the stack.
+ * @param range The number of slots in use.
+ * @return A pointer to the chosen slot.
+ */
+static EliminationSlot *randomSlot(EliminationStack *stack, unsigned range)
+{
+    static _Thread_local uint32_t seed = 0;
+    if (seed == 0)
+    {
+        seed = (uint32_t)(uintptr_t)&seed | 1; // Differs per thread
+    }
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return &stack->slots[seed % range];
+}
+
+/**
+ * @brief Offers a value in a slot and waits for a pop to take it.
+ * @param stack A pointer to the stack.
+ * @param data The value being pushed.
+ * @return 1 if a pop took the value, 0 if the push must retry on the stack.
+ */
+static int exchangePush(EliminationStack *stack, int data)
+{
+    Backoff *backoff = currentBackoff(stack);
+    EliminationSlot *slot = randomSlot(stack, backoff->range);
+    uint64_t offer = SLOT_OFFER | (uint32_t)data;
+    uint64_t expected = SLOT_FREE;
+    if (!atomic_compare_exchange_strong_explicit(&slot->state, &expected, offer,
+                                                 memory_order_relaxed, memory_order_relaxed))
+    {
+        widenBackoff(stack, backoff); // Slot in use by another pair
+        return 0;
+    }
+
+    for (unsigned i = 0; i < backoff->spins; i++)
+    {
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) == SLOT_TAKEN)
+        {
+            atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_relaxed);
+            return 1;
+        }
+    }
+
+    // Withdraw the offer, unless a pop took it in the meantime
+    if (atomic_compare_exchange_strong_explicit(&slot->state, &offer, SLOT_FREE,
+                                                memory_order_acquire, memory_order_acquire))
+    {
+        narrowBackoff(stack, backoff);
+        return 0;
+    }
+    atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_relaxed);
+    return 1;
+}
+
+/**
+ * @brief Takes the value a pending push offers in a slot, if any.
+ * @param stack A pointer to the stack.
+ * @param out Receives the value taken.
+ * @return 1 if a value was taken, 0 if the pop must retry on the stack.
+ */
+static int exchangePop(EliminationStack *stack, int *out)
+{
+    Backoff *backoff = currentBackoff(stack);
+    EliminationSlot *slot = randomSlot(stack, backoff->range);
+    uint64_t state = atomic_load_explicit(&slot->state, memory_order_relaxed);
+    if ((state & ~(uint64_t)UINT32_MAX) != SLOT_OFFER)
+    {
+        if (state == SLOT_FREE)
+        {
+            narrowBackoff(stack, backoff); // No push waiting here
+        }
+        else
+        {
+            widenBackoff(stack, backoff); // Slot in use by another pair
+        }
+        return 0;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&slot->state, &state, SLOT_TAKEN,
+                                                 memory_order_release, memory_order_relaxed))
+    {
+        widenBackoff(stack, backoff); // Another pop took it first
+        return 0;
+    }
+    *out = (int)(uint32_t)state;
+    return 1;
+}
+
+/**
+ * @brief Initializes an empty elimination-backoff stack.
+ * @param stack A pointer to the stack to initialize.
+ * @param width The number of exchange slots.
+ * @param spins The longest a push waits in a slot for a pop, in polls of the slot.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the stack could not be allocated.
+ */
+StackStatus initEliminationStack(EliminationStack *stack, unsigned width, unsigned spins)
+{
+    if (width == 0)
+    {
+        width = 1;
+    }
+    stack->slots = aligned_alloc(LOCKFREE_CACHE_LINE, width * sizeof(EliminationSlot));
+    if (stack->slots == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    if (initLockFreeStack(&stack->stack) != STACK_OK)
+    {
+        free(stack->slots);
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned i = 0; i < width; i++)
+    {
+        atomic_init(&stack->slots[i].state, SLOT_FREE);
+    }
+    stack->width = width;
+    stack->spins = spins;
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees the elimination array and the underlying stack.
+ * @param stack A pointer to the stack.
+ */
+void destroyEliminationStack(EliminationStack *stack)
+{
+    destroyLockFreeStack(&stack->stack);
+    free(stack->slots);
+    stack->slots = NULL;
+}
+
+/**
+ * @brief Pushes an item, alternating between the top of the stack and the elimination array.
+ * @details The node is allocated once up front; if the value is eliminated instead,
+ *          the node goes straight back to the free list.
+ * @param stack A pointer to the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus eliminationPush(EliminationStack *stack, int data)
+{
+    STACK_STATS_BEGIN(stack->stack.stats, STATS_PUSH, timer);
+    uint32_t index = allocNode(&stack->stack);
+    if (STACK_UNLIKELY(index == NO_NODE))
+    {
+        STACK_STATS_EVENT(stack->stack.stats, STATS_NO_MEMORY);
+        return STACK_NO_MEMORY;
+    }
+    nodeAt(&stack->stack, index)->data = data;
+
+    while (!tryLinkNode(&stack->stack, &stack->stack.top, index))
+    {
+        if (exchangePush(stack, data))
+        {
+            linkNode(&stack->stack, &stack->stack.freeTop, index);
+            break;
+        }
+    }
+    STACK_STATS_END(timer, STATS_PUSH, 1, 0);
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops an item, alternating between the top of the stack and the elimination array.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus eliminationTryPop(EliminationStack *stack, int *out)
+{
+    STACK_STATS_BEGIN(stack->stack.stats, STATS_POP, timer);
+    uint32_t index;
+    while (!tryUnlinkNode(&stack->stack, &stack->stack.top, &index))
+    {
+        if (exchangePop(stack, out))
+        {
+            STACK_STATS_END(timer, STATS_POP, 1, 0);
+            return STACK_OK;
+        }
+    }
+    if (STACK_UNLIKELY(index == NO_NODE))
+    {
+        STACK_STATS_EVENT(stack->stack.stats, STATS_UNDERFLOW);
+        return STACK_EMPTY;
+    }
+    *out = nodeAt(&stack->stack, index)->data;
+    linkNode(&stack->stack, &stack->stack.freeTop, index);
+    STACK_STATS_END(timer, STATS_POP, 1, 0);
+    return STACK_OK;
+}
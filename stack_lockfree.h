@@ -0,0 +1,187 @@
+/**
+ * @file stack_lockfree.h
+ *
+ * @brief Lock-free linked-list stack (Treiber stack) shared between threads.
+ *
+ * Any number of threads may push and pop concurrently without a mutex. The top
+ * of the stack is a single 64-bit word updated with compare-and-swap; it holds a
+ * 32-bit node index next to a 32-bit tag that changes on every update, so a
+ * thread that read the top before another thread popped and re-pushed the same
+ * node sees its CAS fail instead of corrupting the list (the ABA problem).
+ *
+ * Nodes live in chunks owned by the stack and are recycled through a second
+ * lock-free free list instead of being handed back to free(). Memory a
+ * concurrent pop may still be reading therefore stays valid until the whole
+ * stack is destroyed.
+ *
+ * Under heavy contention the single top word still serializes every thread.
+ * EliminationStack adds an elimination-backoff array in front of it: a push and
+ * a pop that both lost their CAS can meet in a random slot of the array and
+ * cancel each other out without touching the top at all. Each thread adapts
+ * how many of the slots it picks from and how long a push waits in one:
+ * colliding with another pair in a slot widens both, finding no partner
+ * narrows them, so the array behaves as a single busy slot under light load
+ * and spreads out as contention grows.
+ */
+
+#ifndef STACK_LOCKFREE_H
+#define STACK_LOCKFREE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def LOCKFREE_CHUNK_NODES
+ * @brief Number of nodes allocated together in one chunk.
+ */
+#define LOCKFREE_CHUNK_NODES 4096
+
+/**
+ * @def LOCKFREE_MAX_CHUNKS
+ * @brief Maximum number of chunks, bounding the stack to
+ *        LOCKFREE_CHUNK_NODES * LOCKFREE_MAX_CHUNKS - 1 elements.
+ */
+#define LOCKFREE_MAX_CHUNKS 65536
+
+/**
+ * @def LOCKFREE_CACHE_LINE
+ * @brief Alignment keeping independently updated words on separate cache lines.
+ */
+#define LOCKFREE_CACHE_LINE 64
+
+/**
+ * @struct lockFreeNode
+ * @brief A node of the lock-free stack, addressed by its index rather than a pointer.
+ */
+typedef struct lockFreeNode
+{
+    int data;                  /**< Integer data of the node */
+    _Atomic uint32_t next;     /**< Index of the node below, 0 for none */
+} LockFreeNode;
+
+/**
+ * @struct lockFreeStack
+ * @brief A stack that can be shared between threads without locking.
+ * @details The hot words are kept on separate cache lines so that pushes and pops
+ *          do not false-share with node allocation. Declare the stack as a variable
+ *          or allocate it with aligned_alloc(LOCKFREE_CACHE_LINE, ...).
+ */
+typedef struct lockFreeStack
+{
+    _Alignas(LOCKFREE_CACHE_LINE) _Atomic uint64_t top;     /**< Tag in the high half, top node index in the low half */
+    _Alignas(LOCKFREE_CACHE_LINE) _Atomic uint64_t freeTop; /**< Same encoding, for the list of recycled nodes */
+    _Alignas(LOCKFREE_CACHE_LINE) _Atomic uint32_t nextIndex; /**< First index never handed out yet */
+    LockFreeNode *_Atomic *chunks; /**< Table of LOCKFREE_MAX_CHUNKS lazily allocated chunks */
+#ifdef STACK_STATS
+    struct stackStats *stats;      /**< Statistics to record into, or NULL; see stack_stats.h */
+#endif
+} LockFreeStack;
+
+/**
+ * @brief Initializes an empty lock-free stack.
+ * @param stack A pointer to the stack to initialize.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the chunk table could not be allocated.
+ */
+StackStatus initLockFreeStack(LockFreeStack *stack);
+
+/**
+ * @brief Frees all memory of the stack.
+ * @details No other thread may be using the stack anymore.
+ * @param stack A pointer to the stack.
+ */
+void destroyLockFreeStack(LockFreeStack *stack);
+
+/**
+ * @brief Pushes an item onto the stack; safe to call from any thread.
+ * @param stack A pointer to the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus lockFreePush(LockFreeStack *stack, int data);
+
+/**
+ * @brief Pops the top element from the stack; safe to call from any thread.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus lockFreeTryPop(LockFreeStack *stack, int *out);
+
+/**
+ * @brief Checks if the stack is empty.
+ * @details With other threads running the answer may be stale by the time it is used.
+ * @param stack A pointer to the stack.
+ * @return 1 if the stack is empty, 0 otherwise.
+ */
+int lockFreeIsEmpty(LockFreeStack *stack);
+
+/**
+ * @def ELIMINATION_DEFAULT_WIDTH
+ * @brief Default number of slots in the elimination array; the most a thread spreads over.
+ */
+#define ELIMINATION_DEFAULT_WIDTH 8
+
+/**
+ * @def ELIMINATION_DEFAULT_SPINS
+ * @brief Default number of polls a push waits in a slot for a matching pop, at the most.
+ */
+#define ELIMINATION_DEFAULT_SPINS 128
+
+/**
+ * @struct eliminationSlot
+ * @brief One exchange slot, alone on its cache line.
+ * @details Holds 0 when free, a pending push's value tagged as an offer, or a
+ *          marker telling the pushing thread its value was taken.
+ */
+typedef struct eliminationSlot
+{
+    _Alignas(LOCKFREE_CACHE_LINE) _Atomic uint64_t state; /**< Encoded slot state */
+} EliminationSlot;
+
+/**
+ * @struct eliminationStack
+ * @brief A lock-free stack with an elimination-backoff array.
+ */
+typedef struct eliminationStack
+{
+    LockFreeStack stack;     /**< The underlying lock-free stack */
+    EliminationSlot *slots;  /**< The elimination array */
+    unsigned width;          /**< Number of slots, the widest a thread's backoff gets */
+    unsigned spins;          /**< Longest a push waits in a slot before retrying the stack, in polls */
+} EliminationStack;
+
+/**
+ * @brief Initializes an empty elimination-backoff stack.
+ * @param stack A pointer to the stack to initialize.
+ * @param width The number of exchange slots; about half the number of contending threads works well.
+ * @param spins The longest a push waits in a slot for a pop, in polls of the slot.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the stack could not be allocated.
+ */
+StackStatus initEliminationStack(EliminationStack *stack, unsigned width, unsigned spins);
+
+/**
+ * @brief Frees all memory of the stack.
+ * @details No other thread may be using the stack anymore.
+ * @param stack A pointer to the stack.
+ */
+void destroyEliminationStack(EliminationStack *stack);
+
+/**
+ * @brief Pushes an item, handing it directly to a concurrent pop when the top is contended.
+ * @param stack A pointer to the stack.
+ * @param data The integer value to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus eliminationPush(EliminationStack *stack, int data);
+
+/**
+ * @brief Pops an item, taking it from a concurrent push when the top is contended.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped value; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus eliminationTryPop(EliminationStack *stack, int *out);
+
+#endif /* STACK_LOCKFREE_H */
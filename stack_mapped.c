@@ -0,0 +1,318 @@
+/**
+ * @file stack_mapped.c
+ *
+ * @brief Implementation of the file-backed stack declared in stack_mapped.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stack_mapped.h"
+
+/**
+ * @brief Returns the file size needed for `capacity` elements.
+ * @param capacity The number of elements.
+ * @return The size in bytes.
+ */
+static size_t fileBytes(uint64_t capacity)
+{
+    return MAPPED_DATA_OFFSET + (size_t)capacity * sizeof(int);
+}
+
+/**
+ * @brief Maps the first `bytes` bytes of the stack file and points the stack at them.
+ * @param stack A pointer to the stack; `fd` must be open.
+ * @param bytes The length to map.
+ * @return 1 on success, 0 if mmap() failed.
+ */
+static int mapFile(MappedStack *stack, size_t bytes)
+{
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, stack->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        return 0;
+    }
+    stack->header = map;
+    stack->array = (int *)((char *)map + MAPPED_DATA_OFFSET);
+    stack->mappedBytes = bytes;
+    return 1;
+}
+
+/**
+ * @brief Flushes the pages covering a byte range of the mapping and waits for the write.
+ * @param stack A pointer to the stack.
+ * @param offset The first byte of the range, from the start of the mapping.
+ * @param length The length of the range.
+ * @return STACK_OK on success, STACK_IO_ERROR if msync() failed.
+ */
+static StackStatus syncRange(MappedStack *stack, size_t offset, size_t length)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset / page * page; // msync() wants a page-aligned address
+    if (msync((char *)stack->header + start, offset + length - start, MS_SYNC) != 0)
+    {
+        return STACK_IO_ERROR;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Checks that a mapped file holds a stack this code can use.
+ * @param header The header at the start of the file.
+ * @param bytes The size of the file.
+ * @return 1 if the header is valid, 0 otherwise.
+ */
+static int validHeader(const MappedHeader *header, size_t bytes)
+{
+    return header->magic == MAPPED_MAGIC &&
+           header->version == MAPPED_VERSION &&
+           header->elementSize == sizeof(int) &&
+           header->capacity > 0 && // Growth doubles the capacity, which must not stay at zero
+           header->capacity <= (bytes - MAPPED_DATA_OFFSET) / sizeof(int) &&
+           header->top >= -1 && header->top < (int64_t)header->capacity;
+}
+
+/**
+ * @brief Sizes an empty file for `capacity` elements and writes a fresh header.
+ * @param stack A pointer to the stack; `fd` must be open.
+ * @param capacity The capacity of the new stack.
+ * @return STACK_OK on success, STACK_IO_ERROR otherwise.
+ */
+static StackStatus createFile(MappedStack *stack, unsigned capacity)
+{
+    if (capacity == 0)
+    {
+        capacity = 1;
+    }
+    if (ftruncate(stack->fd, (off_t)fileBytes(capacity)) != 0 || !mapFile(stack, fileBytes(capacity)))
+    {
+        return STACK_IO_ERROR;
+    }
+    *stack->header = (MappedHeader){ MAPPED_MAGIC, MAPPED_VERSION, sizeof(int), 0, -1, capacity };
+    if (stack->policy != MAPPED_SYNC_NONE && syncRange(stack, 0, sizeof(MappedHeader)) != STACK_OK)
+    {
+        munmap(stack->header, stack->mappedBytes);
+        return STACK_IO_ERROR;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Maps a file that already holds a stack and checks its header.
+ * @param stack A pointer to the stack; `fd` must be open.
+ * @param bytes The size of the file.
+ * @return STACK_OK on success, STACK_IO_ERROR otherwise.
+ */
+static StackStatus mapExistingFile(MappedStack *stack, size_t bytes)
+{
+    if (bytes < MAPPED_DATA_OFFSET || !mapFile(stack, bytes))
+    {
+        return STACK_IO_ERROR;
+    }
+    if (!validHeader(stack->header, bytes))
+    {
+        munmap(stack->header, bytes);
+        return STACK_IO_ERROR;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Opens the stack stored in `path`, creating an empty one if the file is missing or empty.
+ * @details An existing stack is mapped and used as it is, so opening takes the
+ *          same time whatever the size of the stack.
+ * @param stack A pointer to the stack to initialize.
+ * @param path The path of the stack file.
+ * @param capacity The capacity of a newly created stack; ignored when the file already holds one.
+ * @param policy When changes are flushed to the file.
+ * @return STACK_OK on success, STACK_IO_ERROR if the file could not be opened or
+ *         mapped or does not hold a valid stack.
+ */
+StackStatus openMappedStack(MappedStack *stack, const char *path, unsigned capacity, MappedSyncPolicy policy)
+{
+    struct stat st;
+    stack->policy = policy;
+    stack->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (stack->fd < 0)
+    {
+        return STACK_IO_ERROR;
+    }
+
+    StackStatus status = STACK_IO_ERROR;
+    if (fstat(stack->fd, &st) == 0)
+    {
+        status = st.st_size == 0 ? createFile(stack, capacity) : mapExistingFile(stack, (size_t)st.st_size);
+    }
+    if (status != STACK_OK)
+    {
+        close(stack->fd);
+        stack->fd = -1;
+        stack->header = NULL;
+        stack->array = NULL;
+    }
+    return status;
+}
+
+/**
+ * @brief Flushes the stack according to its policy and closes the file.
+ * @details Closing a stack that is already closed, or failed to open, does nothing.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if the final flush failed.
+ */
+StackStatus closeMappedStack(MappedStack *stack)
+{
+    StackStatus status = STACK_OK;
+    if (stack->header == NULL)
+    {
+        return STACK_OK; // Already closed
+    }
+    if (stack->policy != MAPPED_SYNC_NONE)
+    {
+        status = mappedSync(stack);
+    }
+    munmap(stack->header, stack->mappedBytes);
+    close(stack->fd);
+    stack->fd = -1;
+    stack->header = NULL;
+    stack->array = NULL;
+    return status;
+}
+
+/**
+ * @brief Writes every change made so far to the file and waits until it is on disk.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if msync() failed.
+ */
+StackStatus mappedSync(MappedStack *stack)
+{
+    return msync(stack->header, stack->mappedBytes, MS_SYNC) == 0 ? STACK_OK : STACK_IO_ERROR;
+}
+
+/**
+ * @brief Doubles the capacity of the file, or makes room for one element, and maps it again.
+ * @details The elements are flushed before the header records the new capacity,
+ *          so a crash mid-way leaves at worst a longer file than the header
+ *          claims, which opens fine. If the longer file cannot be mapped, the
+ *          old mapping is kept and the stack stays usable at its old capacity.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the file could not grow,
+ *         STACK_IO_ERROR if a flush failed.
+ */
+static StackStatus growMappedStack(MappedStack *stack)
+{
+    uint64_t capacity = stack->header->capacity ? stack->header->capacity * 2 : 1;
+    if (capacity > INT32_MAX)
+    {
+        return STACK_NO_MEMORY;
+    }
+    if (stack->policy != MAPPED_SYNC_NONE && mappedSync(stack) != STACK_OK)
+    {
+        return STACK_IO_ERROR;
+    }
+    if (ftruncate(stack->fd, (off_t)fileBytes(capacity)) != 0)
+    {
+        return STACK_NO_MEMORY;
+    }
+    // Map the grown file before dropping the old view, so a failure leaves the stack as it was
+    MappedHeader *oldHeader = stack->header;
+    size_t oldBytes = stack->mappedBytes;
+    if (!mapFile(stack, fileBytes(capacity)))
+    {
+        return STACK_NO_MEMORY;
+    }
+    munmap(oldHeader, oldBytes);
+    stack->header->capacity = capacity;
+    if (stack->policy != MAPPED_SYNC_NONE)
+    {
+        return syncRange(stack, 0, sizeof(MappedHeader));
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Pushes an item, growing the file when the stack is full.
+ * @details Under MAPPED_SYNC_EVERY_OP the element reaches the disk before the
+ *          new top does, so after a crash the top never points at garbage.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the file could not grow,
+ *         STACK_IO_ERROR if a flush failed.
+ */
+StackStatus mappedPush(MappedStack *stack, int item)
+{
+    MappedHeader *header = stack->header;
+    if (STACK_UNLIKELY((uint64_t)(header->top + 1) == header->capacity))
+    {
+        StackStatus status = growMappedStack(stack);
+        if (status != STACK_OK)
+        {
+            return status;
+        }
+        header = stack->header;
+    }
+    int64_t top = header->top + 1;
+    stack->array[top] = item;
+    if (stack->policy == MAPPED_SYNC_EVERY_OP &&
+        syncRange(stack, MAPPED_DATA_OFFSET + (size_t)top * sizeof(int), sizeof(int)) != STACK_OK)
+    {
+        return STACK_IO_ERROR;
+    }
+    header->top = top;
+    if (stack->policy == MAPPED_SYNC_EVERY_OP)
+    {
+        return syncRange(stack, 0, sizeof(MappedHeader));
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item from the stack.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop,
+ *         STACK_IO_ERROR if a flush failed.
+ */
+StackStatus mappedTryPop(MappedStack *stack, int *out)
+{
+    MappedHeader *header = stack->header;
+    if (STACK_UNLIKELY(header->top < 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = stack->array[header->top--];
+    if (stack->policy == MAPPED_SYNC_EVERY_OP)
+    {
+        return syncRange(stack, 0, sizeof(MappedHeader));
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item of the stack.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus mappedTryPeek(MappedStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->header->top < 0))
+    {
+        return STACK_EMPTY;
+    }
+    *out = stack->array[stack->header->top];
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items on the stack.
+ */
+size_t mappedSize(MappedStack *stack)
+{
+    return (size_t)(stack->header->top + 1);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file stack_mapped.h
+ *
+ * @brief Array stack stored in a memory-mapped file, so it survives restarts.
+ *
+ * The file starts with a small header (magic, format version, element size, top
+ * index and capacity) followed by the element array. Both are mapped into memory
+ * and used in place: push and pop touch the mapping exactly like the array stack
+ * touches its heap array, and reopening an existing file is O(1) regardless of
+ * its size, since nothing is parsed or copied. A full stack grows by extending
+ * the file with ftruncate() and mapping it again.
+ *
+ * How hard the stack works to survive a crash is chosen with MappedSyncPolicy.
+ * Requires a POSIX system.
+ */
+
+#ifndef STACK_MAPPED_H
+#define STACK_MAPPED_H
+
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def MAPPED_MAGIC
+ * @brief First four bytes of every stack file ("STK1" read as a little-endian word).
+ */
+#define MAPPED_MAGIC 0x314B5453u
+
+/**
+ * @def MAPPED_VERSION
+ * @brief Version of the file layout written by this code.
+ */
+#define MAPPED_VERSION 1u
+
+/**
+ * @def MAPPED_DATA_OFFSET
+ * @brief Offset of the element array in the file; the header is padded to it.
+ */
+#define MAPPED_DATA_OFFSET 64
+
+/**
+ * @enum mappedSyncPolicy
+ * @brief When changes to the mapping are flushed to the file with msync().
+ */
+typedef enum mappedSyncPolicy
+{
+    MAPPED_SYNC_NONE = 0, /**< Leave write-back to the kernel; survives a process crash, not a power loss */
+    MAPPED_SYNC_ON_CLOSE, /**< Flush when the stack grows, on mappedSync() and on close */
+    MAPPED_SYNC_EVERY_OP  /**< Flush each element before the top index that publishes it */
+} MappedSyncPolicy;
+
+/**
+ * @struct mappedHeader
+ * @brief Header at the start of a stack file.
+ */
+typedef struct mappedHeader
+{
+    uint32_t magic;       /**< MAPPED_MAGIC */
+    uint32_t version;     /**< MAPPED_VERSION */
+    uint32_t elementSize; /**< sizeof(int) of the writer; a file is rejected on a mismatch */
+    uint32_t reserved;    /**< Zero */
+    int64_t top;          /**< Index of the top element, -1 when empty */
+    uint64_t capacity;    /**< Number of elements the file has room for */
+} MappedHeader;
+
+/**
+ * @struct mappedStack
+ * @brief An open file-backed stack.
+ */
+typedef struct mappedStack
+{
+    int fd;                  /**< Descriptor of the stack file */
+    MappedHeader *header;    /**< Start of the mapping */
+    int *array;              /**< Element array, MAPPED_DATA_OFFSET bytes into the mapping */
+    size_t mappedBytes;      /**< Length of the mapping */
+    MappedSyncPolicy policy; /**< When to msync() */
+} MappedStack;
+
+/**
+ * @brief Opens the stack stored in `path`, creating an empty one if the file is missing or empty.
+ *
+ * @param stack A pointer to the stack to initialize.
+ * @param path The path of the stack file.
+ * @param capacity The capacity of a newly created stack; ignored when the file already holds one.
+ * @param policy When changes are flushed to the file.
+ * @return STACK_OK on success, STACK_IO_ERROR if the file could not be opened or
+ *         mapped or does not hold a valid stack.
+ */
+StackStatus openMappedStack(MappedStack *stack, const char *path, unsigned capacity, MappedSyncPolicy policy);
+
+/**
+ * @brief Flushes the stack according to its policy and closes the file.
+ * @details Closing a stack that is already closed, or failed to open, does nothing.
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if the final flush failed.
+ */
+StackStatus closeMappedStack(MappedStack *stack);
+
+/**
+ * @brief Writes every change made so far to the file and waits until it is on disk.
+ *
+ * @param stack A pointer to the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if msync() failed.
+ */
+StackStatus mappedSync(MappedStack *stack);
+
+/**
+ * @brief Pushes an item, growing the file when the stack is full.
+ *
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the file could not grow,
+ *         STACK_IO_ERROR if a flush failed.
+ */
+StackStatus mappedPush(MappedStack *stack, int item);
+
+/**
+ * @brief Pops the top item from the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop,
+ *         STACK_IO_ERROR if a flush failed.
+ */
+StackStatus mappedTryPop(MappedStack *stack, int *out);
+
+/**
+ * @brief Reads the top item of the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty.
+ */
+StackStatus mappedTryPeek(MappedStack *stack, int *out);
+
+/**
+ * @brief Returns the number of items on the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @return The number of items on the stack.
+ */
+size_t mappedSize(MappedStack *stack);
+
+#endif /* STACK_MAPPED_H */
@@ -0,0 +1,452 @@
+/**
+ * @file stack_registry.c
+ *
+ * @brief Implementation of the stack registry declared in stack_registry.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack_registry.h"
+
+#define NO_SLOT UINT32_MAX       /**< End of the free list */
+#define MIN_NAME_CAPACITY 16     /**< Smallest name table */
+
+/**
+ * @brief Builds a handle from a slot index and its generation.
+ */
+static StackHandle makeHandle(uint32_t index, uint32_t generation)
+{
+    return (uint64_t)generation << 32 | index;
+}
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a name.
+ */
+static uint64_t hashName(const char *name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name != '\0'; name++)
+    {
+        hash = (hash ^ (unsigned char)*name) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the name table entry holding `name`, or the empty entry where it would go.
+ * @param registry A pointer to the registry; its name table must not be full.
+ * @param name The name to look for.
+ * @param hash The hash of the name.
+ * @return A pointer to the entry.
+ */
+static RegistryName *findEntry(StackRegistry *registry, const char *name, uint64_t hash)
+{
+    uint32_t mask = registry->nameCapacity - 1;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask)
+    {
+        RegistryName *entry = &registry->names[i];
+        if (entry->name == NULL || (entry->hash == hash && strcmp(entry->name, name) == 0))
+        {
+            return entry;
+        }
+    }
+}
+
+/**
+ * @brief Doubles the name table, or allocates it on first use.
+ * @param registry A pointer to the registry.
+ * @return 1 on success, 0 if the allocation failed.
+ */
+static int growNames(StackRegistry *registry)
+{
+    uint32_t capacity = registry->nameCapacity ? registry->nameCapacity * 2 : MIN_NAME_CAPACITY;
+    RegistryName *names = calloc(capacity, sizeof(RegistryName));
+    if (names == NULL)
+    {
+        return 0;
+    }
+    RegistryName *old = registry->names;
+    uint32_t oldCapacity = registry->nameCapacity;
+    registry->names = names;
+    registry->nameCapacity = capacity;
+    for (uint32_t i = 0; i < oldCapacity; i++)
+    {
+        if (old[i].name != NULL)
+        {
+            *findEntry(registry, old[i].name, old[i].hash) = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+/**
+ * @brief Removes an entry from the name table.
+ * @details Later entries of the same probe run are shifted back into the hole, so
+ *          lookups never need tombstones.
+ * @param registry A pointer to the registry.
+ * @param entry The entry to remove.
+ */
+static void removeEntry(StackRegistry *registry, RegistryName *entry)
+{
+    uint32_t mask = registry->nameCapacity - 1;
+    uint32_t hole = (uint32_t)(entry - registry->names);
+    for (uint32_t i = (hole + 1) & mask; registry->names[i].name != NULL; i = (i + 1) & mask)
+    {
+        uint32_t home = (uint32_t)registry->names[i].hash & mask;
+        // Move the entry back unless its home lies cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            registry->names[hole] = registry->names[i];
+            hole = i;
+        }
+    }
+    registry->names[hole].name = NULL;
+    registry->nameCount--;
+}
+
+/**
+ * @brief Doubles the number of slots.
+ * @param registry A pointer to the registry.
+ * @return 1 on success, 0 if the allocation failed.
+ */
+static int growSlots(StackRegistry *registry)
+{
+    if (registry->capacity >= NO_SLOT / 2)
+    {
+        return 0;
+    }
+    uint32_t capacity = registry->capacity ? registry->capacity * 2 : 1;
+    unsigned char *headers = realloc(registry->headers, (size_t)capacity * registry->headerSize);
+    if (headers == NULL)
+    {
+        return 0;
+    }
+    registry->headers = headers;
+    RegistrySlot *slots = realloc(registry->slots, (size_t)capacity * sizeof(RegistrySlot));
+    if (slots == NULL)
+    {
+        return 0; // The larger header array is kept; the capacity stays at the smaller size
+    }
+    registry->slots = slots;
+    registry->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Returns the header of the stack in a slot.
+ */
+static void *headerAt(StackRegistry *registry, uint32_t index)
+{
+    return registry->headers + (size_t)index * registry->headerSize;
+}
+
+/**
+ * @brief Initializes an empty stack in a slot.
+ * @param registry A pointer to the registry.
+ * @param index The slot.
+ * @param cap The initial capacity of an array stack.
+ * @param growthFactor The capacity multiplier on overflow of an array stack.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the stack could not be allocated.
+ */
+static StackStatus initHeader(StackRegistry *registry, uint32_t index, unsigned cap, double growthFactor)
+{
+    void *header = headerAt(registry, index);
+    switch (registry->backend)
+    {
+    case STACK_BACKEND_ARRAY:
+        return initStack(header, cap, growthFactor, 0);
+    case STACK_BACKEND_LIST:
+        *(Node **)header = NULL;
+        return STACK_OK;
+    default:
+        *(UnrolledStack *)header = (UnrolledStack){ NULL, NULL, 0 };
+        return STACK_OK;
+    }
+}
+
+/**
+ * @brief Frees the elements of the stack in a slot.
+ * @param registry A pointer to the registry.
+ * @param index The slot.
+ */
+static void releaseHeader(StackRegistry *registry, uint32_t index)
+{
+    void *header = headerAt(registry, index);
+    switch (registry->backend)
+    {
+    case STACK_BACKEND_ARRAY:
+        free(((struct Stack *)header)->array);
+        break;
+    case STACK_BACKEND_LIST:
+        listClear(header);
+        break;
+    default:
+        unrolledClear(header);
+        break;
+    }
+}
+
+/**
+ * @brief Initializes an empty registry of array stacks.
+ * @param registry A pointer to the registry to initialize.
+ * @param slots The number of stacks to make room for up front.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the table could not be allocated.
+ */
+StackStatus initRegistry(StackRegistry *registry, uint32_t slots)
+{
+    return initRegistryOf(registry, STACK_BACKEND_ARRAY, slots);
+}
+
+/**
+ * @brief Initializes an empty registry of stacks of the given backend.
+ * @param registry A pointer to the registry to initialize.
+ * @param backend The kind of stack the registry holds.
+ * @param slots The number of stacks to make room for up front.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the table could not be allocated.
+ */
+StackStatus initRegistryOf(StackRegistry *registry, StackBackend backend, uint32_t slots)
+{
+    static const size_t headerSizes[] = { sizeof(struct Stack), sizeof(Node *), sizeof(UnrolledStack) };
+    memset(registry, 0, sizeof(*registry));
+    registry->backend = backend;
+    registry->headerSize = headerSizes[backend];
+    registry->freeHead = NO_SLOT;
+    if (slots == 0)
+    {
+        return STACK_OK;
+    }
+    registry->headers = malloc((size_t)slots * registry->headerSize);
+    registry->slots = malloc((size_t)slots * sizeof(RegistrySlot));
+    if (registry->headers == NULL || registry->slots == NULL)
+    {
+        free(registry->headers);
+        free(registry->slots);
+        registry->headers = NULL;
+        registry->slots = NULL;
+        return STACK_NO_MEMORY;
+    }
+    registry->capacity = slots;
+    return STACK_OK;
+}
+
+/**
+ * @brief Destroys every stack of the registry and the registry itself in one pass.
+ * @param registry A pointer to the registry.
+ */
+void destroyRegistry(StackRegistry *registry)
+{
+    StackBackend backend = registry->backend;
+    size_t headerSize = registry->headerSize;
+    for (uint32_t i = 0; i < registry->used; i++)
+    {
+        if (registry->slots[i].generation & 1)
+        {
+            releaseHeader(registry, i);
+            free(registry->slots[i].name);
+        }
+    }
+    free(registry->headers);
+    free(registry->slots);
+    free(registry->names);
+    memset(registry, 0, sizeof(*registry));
+    registry->backend = backend; // Still usable, empty, as after initRegistryOf()
+    registry->headerSize = headerSize;
+    registry->freeHead = NO_SLOT;
+}
+
+/**
+ * @brief Creates a stack in the registry, reusing a freed slot when there is one.
+ * @param registry A pointer to the registry.
+ * @param name A unique name for the stack, or NULL for an anonymous stack.
+ * @param cap The initial capacity of an array stack; ignored by the other backends.
+ * @param growthFactor The capacity multiplier on overflow of an array stack; 1 or less keeps
+ *        it fixed-size. Ignored by the other backends.
+ * @param handle Receives the handle of the new stack.
+ * @return STACK_OK on success, STACK_EXISTS if the name is taken, STACK_NO_MEMORY
+ *         if the stack could not be allocated.
+ */
+StackStatus registryCreate(StackRegistry *registry, const char *name, unsigned cap, double growthFactor,
+                           StackHandle *handle)
+{
+    RegistryName *entry = NULL;
+    char *copy = NULL;
+    uint64_t hash = 0;
+    if (name != NULL)
+    {
+        // Keep the name table at most half full
+        if ((registry->nameCount + 1) * 2 > registry->nameCapacity && !growNames(registry))
+        {
+            return STACK_NO_MEMORY;
+        }
+        hash = hashName(name);
+        entry = findEntry(registry, name, hash);
+        if (entry->name != NULL)
+        {
+            return STACK_EXISTS;
+        }
+        size_t length = strlen(name) + 1;
+        copy = malloc(length);
+        if (copy == NULL)
+        {
+            return STACK_NO_MEMORY;
+        }
+        memcpy(copy, name, length);
+    }
+
+    uint32_t index = registry->freeHead;
+    if (index == NO_SLOT && registry->used == registry->capacity && !growSlots(registry))
+    {
+        free(copy);
+        return STACK_NO_MEMORY;
+    }
+    if (index == NO_SLOT)
+    {
+        index = registry->used;
+        registry->slots[index].generation = 0;
+    }
+    if (initHeader(registry, index, cap, growthFactor) != STACK_OK)
+    {
+        free(copy);
+        return STACK_NO_MEMORY;
+    }
+
+    // Only now that nothing can fail is the slot taken
+    RegistrySlot *slot = &registry->slots[index];
+    if (index == registry->freeHead)
+    {
+        registry->freeHead = slot->nextFree;
+    }
+    else
+    {
+        registry->used++;
+    }
+    slot->generation++;
+    slot->name = copy;
+    registry->count++;
+    *handle = makeHandle(index, slot->generation);
+    if (entry != NULL)
+    {
+        *entry = (RegistryName){ copy, hash, *handle };
+        registry->nameCount++;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the slot index of a live handle.
+ * @param registry A pointer to the registry.
+ * @param handle The handle.
+ * @return The slot index, or NO_SLOT if the handle is stale.
+ */
+static uint32_t slotOf(StackRegistry *registry, StackHandle handle)
+{
+    uint32_t index = (uint32_t)handle;
+    if (index >= registry->used || registry->slots[index].generation != (uint32_t)(handle >> 32) ||
+        !(registry->slots[index].generation & 1))
+    {
+        return NO_SLOT;
+    }
+    return index;
+}
+
+/**
+ * @brief Destroys one stack of the registry and puts its slot on the free list.
+ * @param registry A pointer to the registry.
+ * @param handle The handle of the stack.
+ * @return 1 if the stack was destroyed, 0 if the handle was stale.
+ */
+int registryDestroy(StackRegistry *registry, StackHandle handle)
+{
+    uint32_t index = slotOf(registry, handle);
+    if (index == NO_SLOT)
+    {
+        return 0;
+    }
+    RegistrySlot *slot = &registry->slots[index];
+    if (slot->name != NULL)
+    {
+        removeEntry(registry, findEntry(registry, slot->name, hashName(slot->name)));
+        free(slot->name);
+        slot->name = NULL;
+    }
+    releaseHeader(registry, index);
+    slot->generation++;
+    slot->nextFree = registry->freeHead;
+    registry->freeHead = index;
+    registry->count--;
+    return 1;
+}
+
+/**
+ * @brief Returns the header of the stack behind a handle.
+ * @param registry A pointer to the registry.
+ * @param handle The handle of the stack.
+ * @param backend The backend the caller expects.
+ * @return A pointer to the header, or NULL if the handle is stale or the backend differs.
+ */
+static void *headerOf(StackRegistry *registry, StackHandle handle, StackBackend backend)
+{
+    uint32_t index = slotOf(registry, handle);
+    return index == NO_SLOT || registry->backend != backend ? NULL : headerAt(registry, index);
+}
+
+/**
+ * @brief Returns the array stack behind a handle.
+ * @param registry A pointer to a registry of array stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the stack, or NULL if the handle is stale or the registry holds another backend.
+ */
+struct Stack *registryGet(StackRegistry *registry, StackHandle handle)
+{
+    return headerOf(registry, handle, STACK_BACKEND_ARRAY);
+}
+
+/**
+ * @brief Returns the top of the linked-list stack behind a handle.
+ * @param registry A pointer to a registry of list stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the top, or NULL if the handle is stale or the registry holds another backend.
+ */
+Node **registryGetList(StackRegistry *registry, StackHandle handle)
+{
+    return headerOf(registry, handle, STACK_BACKEND_LIST);
+}
+
+/**
+ * @brief Returns the unrolled stack behind a handle.
+ * @param registry A pointer to a registry of unrolled stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the stack, or NULL if the handle is stale or the registry holds another backend.
+ */
+UnrolledStack *registryGetUnrolled(StackRegistry *registry, StackHandle handle)
+{
+    return headerOf(registry, handle, STACK_BACKEND_UNROLLED);
+}
+
+/**
+ * @brief Looks a stack up by name.
+ * @param registry A pointer to the registry.
+ * @param name The name of the stack.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if no stack has that name.
+ */
+StackHandle registryFind(StackRegistry *registry, const char *name)
+{
+    if (registry->nameCount == 0)
+    {
+        return STACK_HANDLE_NONE;
+    }
+    RegistryName *entry = findEntry(registry, name, hashName(name));
+    return entry->name != NULL ? entry->handle : STACK_HANDLE_NONE;
+}
+
+/**
+ * @brief Returns the number of stacks in the registry.
+ * @param registry A pointer to the registry.
+ * @return The number of live stacks.
+ */
+uint32_t registryCount(StackRegistry *registry)
+{
+    return registry->count;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file stack_registry.h
+ *
+ * @brief A table owning any number of stacks of one backend, addressed by handle or by name.
+ *
+ * A registry holds array, linked-list or unrolled stacks, chosen when it is
+ * initialized. Their headers (a struct Stack, a Node pointer to the top, or an
+ * UnrolledStack) live side by side in one array, so walking or switching
+ * between many stacks touches consecutive memory instead of one heap block per
+ * stack. A stack is addressed by a StackHandle: its slot index plus the slot's
+ * generation, which changes whenever the slot is freed, so a handle to a
+ * destroyed stack is recognized as stale rather than silently reaching whatever
+ * stack took over the slot. Freed slots are reused through a free list, so
+ * creating, destroying and looking up a stack all take O(1) time.
+ *
+ * Stacks may also be given a name when they are created; names are kept in an
+ * open-addressing hash table and found in O(1) expected time.
+ */
+
+#ifndef STACK_REGISTRY_H
+#define STACK_REGISTRY_H
+
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @brief Identifies a stack of a registry: generation in the high half, slot index in the low half.
+ */
+typedef uint64_t StackHandle;
+
+/**
+ * @def STACK_HANDLE_NONE
+ * @brief A handle that never refers to a stack.
+ */
+#define STACK_HANDLE_NONE 0
+
+/**
+ * @enum stackBackend
+ * @brief The kind of stack a registry holds.
+ */
+typedef enum stackBackend
+{
+    STACK_BACKEND_ARRAY = 0, /**< struct Stack, reached with registryGet() */
+    STACK_BACKEND_LIST,      /**< A Node pointer to the top, reached with registryGetList() */
+    STACK_BACKEND_UNROLLED   /**< UnrolledStack, reached with registryGetUnrolled() */
+} StackBackend;
+
+/**
+ * @struct registrySlot
+ * @brief Bookkeeping of one slot of the registry, kept apart from the stack headers.
+ */
+typedef struct registrySlot
+{
+    uint32_t generation; /**< Odd while the slot holds a stack, even while it is free */
+    uint32_t nextFree;   /**< Next free slot when this one is free */
+    char *name;          /**< Name of the stack, or NULL */
+} RegistrySlot;
+
+/**
+ * @struct registryName
+ * @brief An entry of the name table.
+ */
+typedef struct registryName
+{
+    char *name;         /**< Name of the stack, shared with its slot; NULL for an empty entry */
+    uint64_t hash;      /**< Hash of the name */
+    StackHandle handle; /**< The named stack */
+} RegistryName;
+
+/**
+ * @struct stackRegistry
+ * @brief A set of stacks of one backend owned by one table.
+ */
+typedef struct stackRegistry
+{
+    unsigned char *headers; /**< Stack headers of `headerSize` bytes, indexed by slot */
+    size_t headerSize;      /**< Size of one stack header */
+    StackBackend backend;   /**< Kind of stack held */
+    RegistrySlot *slots;    /**< Slot bookkeeping, indexed by slot */
+    uint32_t capacity;      /**< Number of slots */
+    uint32_t used;          /**< Slots handed out at least once */
+    uint32_t count;         /**< Live stacks */
+    uint32_t freeHead;      /**< First free slot, or UINT32_MAX */
+    RegistryName *names;    /**< Name table, a power of two entries long */
+    uint32_t nameCapacity;  /**< Number of entries of `names` */
+    uint32_t nameCount;     /**< Names in use */
+} StackRegistry;
+
+/**
+ * @brief Initializes an empty registry of array stacks.
+ * @param registry A pointer to the registry to initialize.
+ * @param slots The number of stacks to make room for up front.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the table could not be allocated.
+ */
+StackStatus initRegistry(StackRegistry *registry, uint32_t slots);
+
+/**
+ * @brief Initializes an empty registry of stacks of the given backend.
+ * @param registry A pointer to the registry to initialize.
+ * @param backend The kind of stack the registry holds.
+ * @param slots The number of stacks to make room for up front.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the table could not be allocated.
+ */
+StackStatus initRegistryOf(StackRegistry *registry, StackBackend backend, uint32_t slots);
+
+/**
+ * @brief Destroys every stack of the registry and the registry itself in one pass.
+ * @param registry A pointer to the registry.
+ */
+void destroyRegistry(StackRegistry *registry);
+
+/**
+ * @brief Creates a stack in the registry.
+ * @param registry A pointer to the registry.
+ * @param name A unique name for the stack, or NULL for an anonymous stack.
+ * @param cap The initial capacity of an array stack; ignored by the other backends.
+ * @param growthFactor The capacity multiplier on overflow of an array stack; 1 or less keeps
+ *        it fixed-size. Ignored by the other backends.
+ * @param handle Receives the handle of the new stack.
+ * @return STACK_OK on success, STACK_EXISTS if the name is taken, STACK_NO_MEMORY
+ *         if the stack could not be allocated.
+ */
+StackStatus registryCreate(StackRegistry *registry, const char *name, unsigned cap, double growthFactor,
+                           StackHandle *handle);
+
+/**
+ * @brief Destroys one stack of the registry.
+ * @param registry A pointer to the registry.
+ * @param handle The handle of the stack.
+ * @return 1 if the stack was destroyed, 0 if the handle was stale.
+ */
+int registryDestroy(StackRegistry *registry, StackHandle handle);
+
+/**
+ * @brief Returns the array stack behind a handle.
+ * @details The pointer stays valid until the next registryCreate(), which may
+ *          move the headers; keep handles, not pointers, across creations. The
+ *          same holds for registryGetList() and registryGetUnrolled().
+ * @param registry A pointer to a registry of array stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the stack, or NULL if the handle is stale or the registry holds another backend.
+ */
+struct Stack *registryGet(StackRegistry *registry, StackHandle handle);
+
+/**
+ * @brief Returns the top of the linked-list stack behind a handle.
+ * @param registry A pointer to a registry of list stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the top, or NULL if the handle is stale or the registry holds another backend.
+ */
+Node **registryGetList(StackRegistry *registry, StackHandle handle);
+
+/**
+ * @brief Returns the unrolled stack behind a handle.
+ * @param registry A pointer to a registry of unrolled stacks.
+ * @param handle The handle of the stack.
+ * @return A pointer to the stack, or NULL if the handle is stale or the registry holds another backend.
+ */
+UnrolledStack *registryGetUnrolled(StackRegistry *registry, StackHandle handle);
+
+/**
+ * @brief Looks a stack up by name.
+ * @param registry A pointer to the registry.
+ * @param name The name of the stack.
+ * @return The handle of the stack, or STACK_HANDLE_NONE if no stack has that name.
+ */
+StackHandle registryFind(StackRegistry *registry, const char *name);
+
+/**
+ * @brief Returns the number of stacks in the registry.
+ * @param registry A pointer to the registry.
+ * @return The number of live stacks.
+ */
+uint32_t registryCount(StackRegistry *registry);
+
+#endif /* STACK_REGISTRY_H */
@@ -0,0 +1,662 @@
+/**
+ * @file stack_serial.c
+ *
+ * @brief Implementation of the stack snapshots declared in stack_serial.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stack_serial.h"
+
+#define SERIAL_MAGIC 0x424B5453u   /**< "STKB" read as a little-endian word */
+#define SERIAL_VERSION 1u          /**< Format version written by this code */
+#define HEADER_BYTES 16            /**< Size of the snapshot header */
+#define BLOCK_HEADER_BYTES 12      /**< Size of a block header */
+#define MAX_VARINT_BYTES 5         /**< Longest varint of a 32-bit value */
+#define MAX_PAYLOAD_BYTES (SERIAL_BLOCK_ITEMS * MAX_VARINT_BYTES)
+
+/* ---------------------------------------------------------------------------
+ * Encoding
+ * ------------------------------------------------------------------------- */
+
+static void put32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t get32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Computes the 32-bit FNV-1a hash of a byte range.
+ * @param data The bytes to hash.
+ * @param length The number of bytes.
+ * @return The hash.
+ */
+static uint32_t checksum(const unsigned char *data, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Encodes a block of elements.
+ * @param items The elements, top of the stack first.
+ * @param n The number of elements.
+ * @param encoding How to store them.
+ * @param out Room for at least MAX_PAYLOAD_BYTES bytes.
+ * @return The number of bytes written to `out`.
+ */
+static size_t encodeBlock(const int *items, uint32_t n, SerialEncoding encoding, unsigned char *out)
+{
+    unsigned char *p = out;
+    if (encoding == SERIAL_RAW)
+    {
+        for (uint32_t i = 0; i < n; i++, p += 4)
+        {
+            put32(p, (uint32_t)items[i]);
+        }
+        return (size_t)(p - out);
+    }
+
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t delta = (uint32_t)items[i] - previous;
+        uint32_t zigzag = delta << 1 ^ (uint32_t)-(int32_t)(delta >> 31); // Small negative deltas stay short
+        previous = (uint32_t)items[i];
+        while (zigzag >= 0x80)
+        {
+            *p++ = (unsigned char)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *p++ = (unsigned char)zigzag;
+    }
+    return (size_t)(p - out);
+}
+
+/**
+ * @brief Decodes a block of elements, checking that the payload holds exactly `n` of them.
+ * @param in The payload.
+ * @param length The length of the payload.
+ * @param n The number of elements the block header announced.
+ * @param encoding How the elements are stored.
+ * @param items Receives the elements.
+ * @return 1 on success, 0 if the payload is malformed.
+ */
+static int decodeBlock(const unsigned char *in, size_t length, uint32_t n, SerialEncoding encoding, int *items)
+{
+    if (encoding == SERIAL_RAW)
+    {
+        if (length != (size_t)n * 4)
+        {
+            return 0;
+        }
+        for (uint32_t i = 0; i < n; i++)
+        {
+            items[i] = (int)get32(in + (size_t)i * 4);
+        }
+        return 1;
+    }
+
+    const unsigned char *end = in + length;
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t zigzag = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            if (in == end || shift >= 7 * MAX_VARINT_BYTES)
+            {
+                return 0;
+            }
+            zigzag |= (uint32_t)(*in & 0x7F) << shift;
+            if (!(*in++ & 0x80))
+            {
+                break;
+            }
+        }
+        previous += zigzag >> 1 ^ (uint32_t)-(int32_t)(zigzag & 1);
+        items[i] = (int)previous;
+    }
+    return in == end;
+}
+
+/* ---------------------------------------------------------------------------
+ * Output
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct writer
+ * @brief Destination of a snapshot: a file descriptor behind a fixed buffer, or a growing memory buffer.
+ */
+typedef struct writer
+{
+    int fd;              /**< Descriptor to flush to, or -1 to collect everything in memory */
+    unsigned char *buf;  /**< Buffered output */
+    size_t used;         /**< Bytes buffered */
+    size_t capacity;     /**< Size of `buf` */
+} Writer;
+
+/**
+ * @brief Writes the buffered bytes to the descriptor.
+ * @param w A pointer to the writer.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+static StackStatus flushWriter(Writer *w)
+{
+    size_t done = 0;
+    while (done < w->used)
+    {
+        ssize_t n = write(w->fd, w->buf + done, w->used - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return STACK_IO_ERROR;
+        }
+        done += (size_t)n;
+    }
+    w->used = 0;
+    return STACK_OK;
+}
+
+/**
+ * @brief Makes room for `n` more bytes, flushing or growing the buffer as needed.
+ * @param w A pointer to the writer.
+ * @param n The number of bytes, at most SERIAL_CHUNK_BYTES.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+static StackStatus reserveOutput(Writer *w, size_t n)
+{
+    if (w->used + n <= w->capacity)
+    {
+        return STACK_OK;
+    }
+    if (w->fd >= 0)
+    {
+        return flushWriter(w);
+    }
+    size_t capacity = w->capacity * 2 > w->used + n ? w->capacity * 2 : w->used + n;
+    unsigned char *buf = realloc(w->buf, capacity);
+    if (buf == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    w->buf = buf;
+    w->capacity = capacity;
+    return STACK_OK;
+}
+
+/**
+ * @brief Writes the snapshot header.
+ * @param w A pointer to the writer.
+ * @param encoding The encoding of the blocks that follow.
+ * @param count The number of elements in the snapshot.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+static StackStatus writeHeader(Writer *w, SerialEncoding encoding, uint64_t count)
+{
+    StackStatus status = reserveOutput(w, HEADER_BYTES);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    unsigned char *p = w->buf + w->used;
+    put32(p, SERIAL_MAGIC);
+    put32(p + 4, SERIAL_VERSION | (uint32_t)encoding << 16);
+    put32(p + 8, (uint32_t)count);
+    put32(p + 12, (uint32_t)(count >> 32));
+    w->used += HEADER_BYTES;
+    return STACK_OK;
+}
+
+/**
+ * @brief Encodes one block straight into the output buffer.
+ * @param w A pointer to the writer.
+ * @param items The elements, top of the stack first.
+ * @param n The number of elements, at most SERIAL_BLOCK_ITEMS.
+ * @param encoding How to store them.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+static StackStatus writeBlock(Writer *w, const int *items, uint32_t n, SerialEncoding encoding)
+{
+    StackStatus status = reserveOutput(w, BLOCK_HEADER_BYTES + MAX_PAYLOAD_BYTES);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    unsigned char *p = w->buf + w->used;
+    size_t bytes = encodeBlock(items, n, encoding, p + BLOCK_HEADER_BYTES);
+    put32(p, n);
+    put32(p + 4, (uint32_t)bytes);
+    put32(p + 8, checksum(p + BLOCK_HEADER_BYTES, bytes));
+    w->used += BLOCK_HEADER_BYTES + bytes;
+    return STACK_OK;
+}
+
+/**
+ * @brief Writes an array stack, top first, through a writer.
+ * @param w A pointer to the writer.
+ * @param stack A pointer to the stack.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+static StackStatus writeArray(Writer *w, struct Stack* stack, SerialEncoding encoding)
+{
+    int items[SERIAL_BLOCK_ITEMS];
+    StackStatus status = writeHeader(w, encoding, stackSize(stack));
+    for (int next = stack->top; status == STACK_OK && next >= 0;)
+    {
+        uint32_t n = 0;
+        while (n < SERIAL_BLOCK_ITEMS && next >= 0)
+        {
+            items[n++] = stack->array[next--];
+        }
+        status = writeBlock(w, items, n, encoding);
+    }
+    return status;
+}
+
+/**
+ * @brief Writes a linked-list stack, top first, through a writer.
+ * @param w A pointer to the writer.
+ * @param top A pointer to the top of the stack.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR or STACK_NO_MEMORY otherwise.
+ */
+static StackStatus writeList(Writer *w, Node *top, SerialEncoding encoding)
+{
+    int items[SERIAL_BLOCK_ITEMS];
+    StackStatus status = writeHeader(w, encoding, listSize(top));
+    while (status == STACK_OK && top != NULL)
+    {
+        uint32_t n = 0;
+        for (; n < SERIAL_BLOCK_ITEMS && top != NULL; top = top->link)
+        {
+            items[n++] = top->data;
+        }
+        status = writeBlock(w, items, n, encoding);
+    }
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Input
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct reader
+ * @brief Source of a snapshot: a file descriptor behind a fixed buffer, or a memory buffer.
+ */
+typedef struct reader
+{
+    int fd;                    /**< Descriptor to refill from, or -1 when reading from memory */
+    const unsigned char *data; /**< Bytes available to read */
+    size_t length;             /**< Number of bytes in `data` */
+    size_t pos;                /**< Bytes of `data` consumed */
+    unsigned char *chunk;      /**< Refill buffer of SERIAL_CHUNK_BYTES when reading a descriptor */
+} Reader;
+
+/**
+ * @brief Copies the next `n` bytes of the snapshot.
+ * @param r A pointer to the reader.
+ * @param out Receives the bytes.
+ * @param n The number of bytes.
+ * @return STACK_OK on success, STACK_CORRUPT if the snapshot ends early,
+ *         STACK_IO_ERROR if a read failed.
+ */
+static StackStatus readBytes(Reader *r, unsigned char *out, size_t n)
+{
+    while (n > 0)
+    {
+        if (r->pos == r->length)
+        {
+            if (r->fd < 0)
+            {
+                return STACK_CORRUPT;
+            }
+            ssize_t got = read(r->fd, r->chunk, SERIAL_CHUNK_BYTES);
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (got < 0)
+            {
+                return STACK_IO_ERROR;
+            }
+            if (got == 0)
+            {
+                return STACK_CORRUPT;
+            }
+            r->data = r->chunk;
+            r->length = (size_t)got;
+            r->pos = 0;
+        }
+        size_t take = r->length - r->pos < n ? r->length - r->pos : n;
+        memcpy(out, r->data + r->pos, take);
+        r->pos += take;
+        out += take;
+        n -= take;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads and checks the snapshot header.
+ * @param r A pointer to the reader.
+ * @param encoding Receives the encoding of the blocks.
+ * @param count Receives the number of elements.
+ * @return STACK_OK on success, STACK_CORRUPT or STACK_IO_ERROR otherwise.
+ */
+static StackStatus readHeader(Reader *r, SerialEncoding *encoding, uint64_t *count)
+{
+    unsigned char p[HEADER_BYTES];
+    StackStatus status = readBytes(r, p, HEADER_BYTES);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    uint32_t format = get32(p + 4);
+    if (get32(p) != SERIAL_MAGIC || (format & 0xFFFF) != SERIAL_VERSION || format >> 16 > SERIAL_DELTA_VARINT)
+    {
+        return STACK_CORRUPT;
+    }
+    *encoding = (SerialEncoding)(format >> 16);
+    *count = get32(p + 8) | (uint64_t)get32(p + 12) << 32;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads, verifies and decodes the next block.
+ * @param r A pointer to the reader.
+ * @param encoding The encoding from the snapshot header.
+ * @param remaining The number of elements the snapshot still owes.
+ * @param items Receives up to SERIAL_BLOCK_ITEMS elements.
+ * @param n Receives the number of elements.
+ * @return STACK_OK on success, STACK_CORRUPT or STACK_IO_ERROR otherwise.
+ */
+static StackStatus readBlock(Reader *r, SerialEncoding encoding, uint64_t remaining, int *items, uint32_t *n)
+{
+    unsigned char header[BLOCK_HEADER_BYTES];
+    unsigned char payload[MAX_PAYLOAD_BYTES];
+    StackStatus status = readBytes(r, header, BLOCK_HEADER_BYTES);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    uint32_t count = get32(header);
+    uint32_t bytes = get32(header + 4);
+    if (count == 0 || count > SERIAL_BLOCK_ITEMS || count > remaining || bytes > MAX_PAYLOAD_BYTES)
+    {
+        return STACK_CORRUPT;
+    }
+    status = readBytes(r, payload, bytes);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    if (checksum(payload, bytes) != get32(header + 8) || !decodeBlock(payload, bytes, count, encoding, items))
+    {
+        return STACK_CORRUPT;
+    }
+    *n = count;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads a snapshot into an array stack, replacing its contents.
+ * @details The count in the header is not trusted for allocation: the array only
+ *          grows, geometrically, to make room for a block whose checksum has
+ *          passed, so a forged header costs no more memory than the data behind
+ *          it. Blocks arrive top first and are appended in that order, and the
+ *          array is reversed once at the end.
+ * @param r A pointer to the reader.
+ * @param stack A pointer to the stack; it is left empty on failure.
+ * @return STACK_OK on success, or the reason of the failure.
+ */
+static StackStatus readArray(Reader *r, struct Stack* stack)
+{
+    int items[SERIAL_BLOCK_ITEMS];
+    SerialEncoding encoding;
+    uint64_t count;
+    stack->top = -1;
+    StackStatus status = readHeader(r, &encoding, &count);
+    if (status != STACK_OK)
+    {
+        return status;
+    }
+    if (count > INT_MAX)
+    {
+        return STACK_CORRUPT; // More elements than an array stack can address
+    }
+
+    uint64_t done = 0;
+    while (done < count)
+    {
+        uint32_t n = 0;
+        status = readBlock(r, encoding, count - done, items, &n);
+        if (status != STACK_OK)
+        {
+            stack->top = -1;
+            return status;
+        }
+        if (done + n > stack->capacity)
+        {
+            uint64_t wanted = (uint64_t)stack->capacity * 2;
+            wanted = wanted < done + n ? done + n : wanted > count ? count : wanted;
+            if (reserveStack(stack, (unsigned)wanted) != STACK_OK)
+            {
+                stack->top = -1;
+                return STACK_NO_MEMORY;
+            }
+        }
+        memcpy(stack->array + done, items, (size_t)n * sizeof(int));
+        done += n;
+        stack->top = (int)done - 1;
+    }
+    reverseStack(stack);
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees every node of a linked-list stack.
+ * @param top_ref A double pointer to the top of the stack.
+ */
+static void clearList(Node **top_ref)
+{
+    while (*top_ref != NULL)
+    {
+        listPopUnchecked(top_ref);
+    }
+}
+
+/**
+ * @brief Reads a snapshot into a linked-list stack, replacing its contents.
+ * @details Nodes are appended below the ones already read, so the chain comes
+ *          out in stack order without a second pass.
+ * @param r A pointer to the reader.
+ * @param top_ref A double pointer to the top of the stack; it is left empty on failure.
+ * @return STACK_OK on success, or the reason of the failure.
+ */
+static StackStatus readList(Reader *r, Node **top_ref)
+{
+    int items[SERIAL_BLOCK_ITEMS];
+    SerialEncoding encoding;
+    uint64_t count;
+    clearList(top_ref);
+    StackStatus status = readHeader(r, &encoding, &count);
+
+    Node **tail = top_ref;
+    for (uint64_t done = 0; status == STACK_OK && done < count;)
+    {
+        uint32_t n = 0;
+        status = readBlock(r, encoding, count - done, items, &n);
+        for (uint32_t i = 0; status == STACK_OK && i < n; i++)
+        {
+            Node *node = createNode(items[i]);
+            if (node == NULL)
+            {
+                status = STACK_NO_MEMORY;
+                break;
+            }
+            *tail = node;
+            tail = &node->link;
+        }
+        done += n;
+    }
+    *tail = NULL;
+    if (status != STACK_OK)
+    {
+        clearList(top_ref);
+    }
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Writes a snapshot of an array stack to a file descriptor.
+ * @param stack A pointer to the stack.
+ * @param fd The descriptor to write to.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+StackStatus saveStack(struct Stack* stack, int fd, SerialEncoding encoding)
+{
+    unsigned char chunk[SERIAL_CHUNK_BYTES];
+    Writer w = { fd, chunk, 0, sizeof(chunk) };
+    StackStatus status = writeArray(&w, stack, encoding);
+    return status == STACK_OK ? flushWriter(&w) : status;
+}
+
+/**
+ * @brief Replaces the contents of an array stack with a snapshot read from a file descriptor.
+ * @param stack A pointer to the stack.
+ * @param fd The descriptor to read from.
+ * @return STACK_OK on success, STACK_IO_ERROR, STACK_CORRUPT or STACK_NO_MEMORY otherwise.
+ */
+StackStatus loadStack(struct Stack* stack, int fd)
+{
+    unsigned char chunk[SERIAL_CHUNK_BYTES];
+    Reader r = { fd, chunk, 0, 0, chunk };
+    return readArray(&r, stack);
+}
+
+/**
+ * @brief Serializes an array stack into a newly allocated buffer.
+ * @param stack A pointer to the stack.
+ * @param encoding How to store the elements.
+ * @param out Receives the buffer, to be released with free().
+ * @param length Receives the length of the buffer.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus serializeStack(struct Stack* stack, SerialEncoding encoding, unsigned char** out, size_t* length)
+{
+    Writer w = { -1, NULL, 0, 0 };
+    StackStatus status = writeArray(&w, stack, encoding);
+    if (status != STACK_OK)
+    {
+        free(w.buf);
+        return status;
+    }
+    *out = w.buf;
+    *length = w.used;
+    return STACK_OK;
+}
+
+/**
+ * @brief Replaces the contents of an array stack with a serialized snapshot.
+ * @param stack A pointer to the stack.
+ * @param data The serialized snapshot.
+ * @param length The length of the snapshot.
+ * @return STACK_OK on success, STACK_CORRUPT or STACK_NO_MEMORY otherwise.
+ */
+StackStatus deserializeStack(struct Stack* stack, const unsigned char* data, size_t length)
+{
+    Reader r = { -1, data, length, 0, NULL };
+    return readArray(&r, stack);
+}
+
+/**
+ * @brief Writes a snapshot of a linked-list stack to a file descriptor.
+ * @param top A pointer to the top of the stack.
+ * @param fd The descriptor to write to.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+StackStatus listSave(Node *top, int fd, SerialEncoding encoding)
+{
+    unsigned char chunk[SERIAL_CHUNK_BYTES];
+    Writer w = { fd, chunk, 0, sizeof(chunk) };
+    StackStatus status = writeList(&w, top, encoding);
+    return status == STACK_OK ? flushWriter(&w) : status;
+}
+
+/**
+ * @brief Replaces the contents of a linked-list stack with a snapshot read from a file descriptor.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param fd The descriptor to read from.
+ * @return STACK_OK on success, STACK_IO_ERROR, STACK_CORRUPT or STACK_NO_MEMORY otherwise.
+ */
+StackStatus listLoad(Node **top_ref, int fd)
+{
+    unsigned char chunk[SERIAL_CHUNK_BYTES];
+    Reader r = { fd, chunk, 0, 0, chunk };
+    return readList(&r, top_ref);
+}
+
+/**
+ * @brief Serializes a linked-list stack into a newly allocated buffer.
+ * @param top A pointer to the top of the stack.
+ * @param encoding How to store the elements.
+ * @param out Receives the buffer, to be released with free().
+ * @param length Receives the length of the buffer.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus listSerialize(Node *top, SerialEncoding encoding, unsigned char **out, size_t *length)
+{
+    Writer w = { -1, NULL, 0, 0 };
+    StackStatus status = writeList(&w, top, encoding);
+    if (status != STACK_OK)
+    {
+        free(w.buf);
+        return status;
+    }
+    *out = w.buf;
+    *length = w.used;
+    return STACK_OK;
+}
+
+/**
+ * @brief Replaces the contents of a linked-list stack with a serialized snapshot.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The serialized snapshot.
+ * @param length The length of the snapshot.
+ * @return STACK_OK on success, STACK_CORRUPT or STACK_NO_MEMORY otherwise.
+ */
+StackStatus listDeserialize(Node **top_ref, const unsigned char *data, size_t length)
+{
+    Reader r = { -1, data, length, 0, NULL };
+    return readList(&r, top_ref);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file stack_serial.h
+ *
+ * @brief Binary snapshots of array and linked-list stacks.
+ *
+ * Both backends write the same format, so a snapshot taken from one backend can
+ * be restored into the other. All integers are little-endian:
+ *
+ *     header   magic "STKB" (u32), version (u16), encoding (u16), element count (u64)
+ *     block*   element count (u32), payload bytes (u32), FNV-1a checksum of the payload (u32),
+ *              payload
+ *
+ * Elements are stored top of the stack first, in blocks of at most
+ * SERIAL_BLOCK_ITEMS. With SERIAL_RAW the payload is the elements as 32-bit
+ * words; with SERIAL_DELTA_VARINT each element is stored as its zigzag-encoded
+ * difference from the previous element of the block, in LEB128 varint form,
+ * which shrinks stacks of nearby values to one or two bytes per element.
+ *
+ * Saving to and loading from a file descriptor goes through a buffer of
+ * SERIAL_CHUNK_BYTES, so memory use stays bounded whatever the size of the stack.
+ */
+
+#ifndef STACK_SERIAL_H
+#define STACK_SERIAL_H
+
+#include <stddef.h>
+
+#include "stack.h"
+
+/**
+ * @def SERIAL_BLOCK_ITEMS
+ * @brief Maximum number of elements in one block.
+ */
+#define SERIAL_BLOCK_ITEMS 4096
+
+/**
+ * @def SERIAL_CHUNK_BYTES
+ * @brief Size of the buffer between a snapshot and its file descriptor.
+ */
+#define SERIAL_CHUNK_BYTES 65536
+
+/**
+ * @enum serialEncoding
+ * @brief How the elements of a block are stored.
+ */
+typedef enum serialEncoding
+{
+    SERIAL_RAW = 0,     /**< Four bytes per element */
+    SERIAL_DELTA_VARINT /**< Zigzag varint of the difference to the previous element */
+} SerialEncoding;
+
+/**
+ * @brief Writes a snapshot of an array stack to a file descriptor.
+ * @param stack A pointer to the stack.
+ * @param fd The descriptor to write to.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+StackStatus saveStack(struct Stack* stack, int fd, SerialEncoding encoding);
+
+/**
+ * @brief Replaces the contents of an array stack with a snapshot read from a file descriptor.
+ * @details The stack grows to fit the snapshot even if it has a fixed capacity.
+ *          On failure the stack is left empty.
+ * @param stack A pointer to the stack.
+ * @param fd The descriptor to read from.
+ * @return STACK_OK on success, STACK_IO_ERROR if a read failed, STACK_CORRUPT if
+ *         the data is not a valid snapshot, STACK_NO_MEMORY if the stack could not grow.
+ */
+StackStatus loadStack(struct Stack* stack, int fd);
+
+/**
+ * @brief Serializes an array stack into a newly allocated buffer.
+ * @param stack A pointer to the stack.
+ * @param encoding How to store the elements.
+ * @param out Receives the buffer, to be released with free().
+ * @param length Receives the length of the buffer.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus serializeStack(struct Stack* stack, SerialEncoding encoding, unsigned char** out, size_t* length);
+
+/**
+ * @brief Replaces the contents of an array stack with a serialized snapshot.
+ * @details On failure the stack is left empty.
+ * @param stack A pointer to the stack.
+ * @param data The serialized snapshot.
+ * @param length The length of the snapshot.
+ * @return STACK_OK on success, STACK_CORRUPT if the data is not a valid snapshot,
+ *         STACK_NO_MEMORY if the stack could not grow.
+ */
+StackStatus deserializeStack(struct Stack* stack, const unsigned char* data, size_t length);
+
+/**
+ * @brief Writes a snapshot of a linked-list stack to a file descriptor.
+ * @param top A pointer to the top of the stack.
+ * @param fd The descriptor to write to.
+ * @param encoding How to store the elements.
+ * @return STACK_OK on success, STACK_IO_ERROR if a write failed.
+ */
+StackStatus listSave(Node *top, int fd, SerialEncoding encoding);
+
+/**
+ * @brief Replaces the contents of a linked-list stack with a snapshot read from a file descriptor.
+ * @details On failure the stack is left empty.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param fd The descriptor to read from.
+ * @return STACK_OK on success, STACK_IO_ERROR if a read failed, STACK_CORRUPT if
+ *         the data is not a valid snapshot, STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listLoad(Node **top_ref, int fd);
+
+/**
+ * @brief Serializes a linked-list stack into a newly allocated buffer.
+ * @param top A pointer to the top of the stack.
+ * @param encoding How to store the elements.
+ * @param out Receives the buffer, to be released with free().
+ * @param length Receives the length of the buffer.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus listSerialize(Node *top, SerialEncoding encoding, unsigned char **out, size_t *length);
+
+/**
+ * @brief Replaces the contents of a linked-list stack with a serialized snapshot.
+ * @details On failure the stack is left empty.
+ * @param top_ref A double pointer to the top of the stack.
+ * @param data The serialized snapshot.
+ * @param length The length of the snapshot.
+ * @return STACK_OK on success, STACK_CORRUPT if the data is not a valid snapshot,
+ *         STACK_NO_MEMORY if no node could be allocated.
+ */
+StackStatus listDeserialize(Node **top_ref, const unsigned char *data, size_t length);
+
+#endif /* STACK_SERIAL_H */
@@ -0,0 +1,142 @@
+/**
+ * @file stack_small.h
+ *
+ * @brief Stacks that keep their first N elements inline and spill to the heap past that.
+ *
+ * `DEFINE_SMALL_STACK(name, T, N)` expands to a stack type with room for `N`
+ * elements inside the struct itself. Until it grows past `N` elements it needs
+ * no heap allocation at all, so it can live on the caller's stack frame or be
+ * embedded in another struct:
+ *
+ *     void visit(int root) {
+ *         SmallStack pending = {0};       // no malloc for up to 16 elements
+ *         SmallStackPush(&pending, root);
+ *         ...
+ *         SmallStackFree(&pending);       // only frees if the stack spilled
+ *     }
+ *
+ * While a stack is still inline it may be copied or moved by value; once it has
+ * spilled, copies share the heap buffer and only one of them may be freed.
+ * A ready-made `SmallStack` of ints with SMALL_STACK_INLINE_ITEMS inline slots
+ * is defined at the end of this header.
+ */
+
+#ifndef STACK_SMALL_H
+#define STACK_SMALL_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack.h"
+
+/**
+ * @def DEFINE_SMALL_STACK
+ * @brief Defines the stack type `name` with `N` inline slots for elements of type `T`.
+ *
+ * A zero-initialized `name` is an empty stack using its inline slots. Once full
+ * it moves its elements to a heap buffer of twice the capacity and keeps doubling
+ * from there, so push stays amortized O(1).
+ *
+ * @param name The name of the generated type, also the prefix of its functions.
+ * @param T The element type.
+ * @param N The number of elements stored inline.
+ */
+#define DEFINE_SMALL_STACK(name, T, N)                                                \
+                                                                                      \
+typedef struct name {                                                                 \
+    T* heap;           /**< Spilled elements, or NULL while the stack is inline */    \
+    size_t size;       /**< Number of elements on the stack */                        \
+    size_t capacity;   /**< Size of the heap buffer; unused while inline */           \
+    T items[N];        /**< Inline storage for the first N elements */                \
+} name;                                                                               \
+                                                                                      \
+/** @brief Returns the array currently holding the elements. */                       \
+static inline T* name##Data(name* stack) {                                            \
+    return stack->heap != NULL ? stack->heap : stack->items;                          \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns the number of elements the stack can hold without spilling. */     \
+static inline size_t name##Capacity(const name* stack) {                              \
+    return stack->heap != NULL ? stack->capacity : (N);                               \
+}                                                                                     \
+                                                                                      \
+/** @brief Frees the heap buffer if the stack spilled, leaving it empty and inline. */\
+static inline void name##Free(name* stack) {                                          \
+    free(stack->heap);                                                                \
+    stack->heap = NULL;                                                               \
+    stack->size = 0;                                                                  \
+    stack->capacity = 0;                                                              \
+}                                                                                     \
+                                                                                      \
+/** @brief Moves the elements to a heap buffer twice as large as the current one. */  \
+static inline StackStatus name##Spill(name* stack) {                                  \
+    size_t cap = name##Capacity(stack) * 2;                                           \
+    if (cap > (size_t)-1 / sizeof(T))                                                 \
+        return STACK_NO_MEMORY;                                                       \
+    T* heap;                                                                          \
+    if (stack->heap == NULL) {                                                        \
+        heap = malloc(cap * sizeof(T));                                               \
+        if (heap == NULL)                                                             \
+            return STACK_NO_MEMORY;                                                   \
+        memcpy(heap, stack->items, stack->size * sizeof(T));                          \
+    } else {                                                                          \
+        heap = realloc(stack->heap, cap * sizeof(T));                                 \
+        if (heap == NULL)                                                             \
+            return STACK_NO_MEMORY;                                                   \
+    }                                                                                 \
+    stack->heap = heap;                                                               \
+    stack->capacity = cap;                                                            \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns the number of elements on the stack. */                            \
+static inline size_t name##Size(const name* stack) {                                  \
+    return stack->size;                                                               \
+}                                                                                     \
+                                                                                      \
+/** @brief Returns 1 if the stack is empty, 0 otherwise. */                           \
+static inline int name##IsEmpty(const name* stack) {                                  \
+    return stack->size == 0;                                                          \
+}                                                                                     \
+                                                                                      \
+/** @brief Pushes a copy of `item`, spilling to the heap when the stack is full. */   \
+static inline StackStatus name##Push(name* stack, T item) {                           \
+    if (STACK_UNLIKELY(stack->size == name##Capacity(stack)) &&                       \
+        name##Spill(stack) != STACK_OK)                                               \
+        return STACK_NO_MEMORY;                                                       \
+    name##Data(stack)[stack->size++] = item;                                          \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Pops the top element into `*out`; STACK_EMPTY if there is none. */         \
+static inline StackStatus name##TryPop(name* stack, T* out) {                         \
+    if (STACK_UNLIKELY(stack->size == 0))                                             \
+        return STACK_EMPTY;                                                           \
+    *out = name##Data(stack)[--stack->size];                                          \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Copies the top element into `*out`; STACK_EMPTY if there is none. */       \
+static inline StackStatus name##TryPeek(name* stack, T* out) {                        \
+    if (STACK_UNLIKELY(stack->size == 0))                                             \
+        return STACK_EMPTY;                                                           \
+    *out = name##Data(stack)[stack->size - 1];                                        \
+    return STACK_OK;                                                                  \
+}                                                                                     \
+                                                                                      \
+/** @brief Pops the top element of a stack the caller knows is not empty. */          \
+static inline T name##PopUnchecked(name* stack) {                                     \
+    return name##Data(stack)[--stack->size];                                          \
+}
+
+/**
+ * @def SMALL_STACK_INLINE_ITEMS
+ * @brief Number of ints a SmallStack holds before it spills to the heap.
+ */
+#ifndef SMALL_STACK_INLINE_ITEMS
+#define SMALL_STACK_INLINE_ITEMS 16
+#endif
+
+DEFINE_SMALL_STACK(SmallStack, int, SMALL_STACK_INLINE_ITEMS)
+
+#endif /* STACK_SMALL_H */
@@ -0,0 +1,333 @@
+/**
+ * @file stack_spill.c
+ *
+ * @brief Implementation of the spill-to-disk stack declared in stack_spill.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "stack_spill.h"
+
+#define PAGE_BYTES ((size_t)SPILL_PAGE_ITEMS * sizeof(int)) /**< Bytes per page, in memory and in the file */
+
+/**
+ * @brief Reads or writes a whole page of the file, retrying short transfers.
+ * @param fd The scratch file.
+ * @param op SPILL_READ or SPILL_WRITE.
+ * @param items The frame's elements.
+ * @param page The page of the file.
+ * @return 1 on success, 0 on an I/O error.
+ */
+static int transferPage(int fd, SpillOp op, int *items, uint64_t page)
+{
+    char *buffer = (char *)items;
+    size_t done = 0;
+    while (done < PAGE_BYTES)
+    {
+        off_t offset = (off_t)(page * PAGE_BYTES + done);
+        ssize_t n = op == SPILL_WRITE ? pwrite(fd, buffer + done, PAGE_BYTES - done, offset)
+                                      : pread(fd, buffer + done, PAGE_BYTES - done, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return 0; // A read can only come up short if the page was never written
+        }
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Body of the I/O thread: runs the queued transfers in order until asked to stop.
+ * @param arg The stack.
+ * @return NULL.
+ */
+static void *ioThread(void *arg)
+{
+    SpillStack *stack = arg;
+    pthread_mutex_lock(&stack->mutex);
+    for (;;)
+    {
+        while (stack->queueCount == 0 && !stack->stopping)
+        {
+            pthread_cond_wait(&stack->work, &stack->mutex);
+        }
+        if (stack->stopping)
+        {
+            break;
+        }
+        SpillFrame *frame = &stack->frames[stack->queue[stack->queueHead]];
+        pthread_mutex_unlock(&stack->mutex);
+
+        // The frame's items and page are left alone by the stack while its op is set
+        int ok = transferPage(stack->fd, frame->op, frame->items, frame->page);
+
+        pthread_mutex_lock(&stack->mutex);
+        stack->ioError |= !ok;
+        frame->op = SPILL_IDLE;
+        stack->queueHead = (stack->queueHead + 1) % stack->frameCount;
+        stack->queueCount--;
+        pthread_cond_broadcast(&stack->done);
+    }
+    pthread_mutex_unlock(&stack->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Waits until no I/O is queued or running on a frame; the mutex must be held.
+ */
+static void waitIdle(SpillStack *stack, SpillFrame *frame)
+{
+    while (frame->op != SPILL_IDLE)
+    {
+        pthread_cond_wait(&stack->done, &stack->mutex);
+    }
+}
+
+/**
+ * @brief Queues a transfer on an idle frame; the mutex must be held.
+ */
+static void queueTransfer(SpillStack *stack, SpillFrame *frame, SpillOp op)
+{
+    frame->op = op;
+    stack->queue[(stack->queueHead + stack->queueCount) % stack->frameCount] = (unsigned)(frame - stack->frames);
+    stack->queueCount++;
+    pthread_cond_signal(&stack->work);
+}
+
+/**
+ * @brief Moves the lowest resident page to the file; the mutex must be held.
+ * @details A clean page already has an identical copy in the file and is not written.
+ */
+static void spillPage(SpillStack *stack)
+{
+    SpillFrame *frame = &stack->frames[stack->diskPages % stack->frameCount];
+    if (frame->dirty)
+    {
+        waitIdle(stack, frame);
+        queueTransfer(stack, frame, SPILL_WRITE);
+        frame->dirty = 0;
+    }
+    stack->diskPages++;
+}
+
+/**
+ * @brief Makes the highest spilled page resident again; the mutex must be held.
+ * @details A page still in its frame is taken back as it is; otherwise it is
+ *          queued for reading, and the stack waits for it only when it becomes the top page.
+ */
+static void fetchPage(SpillStack *stack)
+{
+    uint64_t page = --stack->diskPages;
+    SpillFrame *frame = &stack->frames[page % stack->frameCount];
+    if (frame->page != page)
+    {
+        waitIdle(stack, frame);
+        frame->page = page;
+        queueTransfer(stack, frame, SPILL_READ);
+    }
+}
+
+/**
+ * @brief Makes `page` the page push, pop and peek work in.
+ * @details Once the page is in its frame, pages are spilled from the bottom until
+ *          the resident ones fit in all frames but two, which keeps a frame free
+ *          for the next page and one for I/O in flight, then the pages just below
+ *          are queued for reading if the spilled part is near.
+ * @param stack A pointer to the stack.
+ * @param page The page holding the element about to be pushed, popped or peeked.
+ * @return STACK_OK on success, STACK_IO_ERROR if a read or write has failed.
+ */
+static StackStatus enterPage(SpillStack *stack, uint64_t page)
+{
+    pthread_mutex_lock(&stack->mutex);
+    while (page < stack->diskPages)
+    {
+        fetchPage(stack); // Only if the prefetching fell behind
+    }
+    SpillFrame *frame = &stack->frames[page % stack->frameCount];
+    waitIdle(stack, frame);
+    frame->page = page;
+    frame->dirty = 1; // Pushes may follow without coming back here
+    while (page + 1 - stack->diskPages > stack->frameCount - 2)
+    {
+        spillPage(stack);
+    }
+    while (stack->diskPages > 0 && page - stack->diskPages < SPILL_PREFETCH_PAGES)
+    {
+        fetchPage(stack);
+    }
+    StackStatus status = stack->ioError ? STACK_IO_ERROR : STACK_OK;
+    pthread_mutex_unlock(&stack->mutex);
+
+    if (STACK_UNLIKELY(status != STACK_OK))
+    {
+        return status;
+    }
+    stack->current = frame->items;
+    stack->currentPage = page;
+    return STACK_OK;
+}
+
+/**
+ * @brief Opens an empty stack spilling to a new scratch file.
+ * @details The file is created at `path`, truncated, and unlinked at once, so it
+ *          disappears when the stack is closed or the process dies.
+ * @param stack A pointer to the stack to initialize.
+ * @param path Where to create the scratch file, on a local file system with room for the deepest stack.
+ * @param frames Page frames to keep in memory; raised to SPILL_MIN_FRAMES if lower.
+ * @return STACK_OK on success, STACK_IO_ERROR if the file could not be created or
+ *         the thread started, STACK_NO_MEMORY if the frames could not be allocated.
+ */
+StackStatus openSpillStack(SpillStack *stack, const char *path, unsigned frames)
+{
+    *stack = (SpillStack){ .frameCount = frames < SPILL_MIN_FRAMES ? SPILL_MIN_FRAMES : frames };
+    stack->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (stack->fd < 0)
+    {
+        return STACK_IO_ERROR;
+    }
+    unlink(path);
+
+    stack->frames = calloc(stack->frameCount, sizeof(SpillFrame));
+    stack->queue = malloc(stack->frameCount * sizeof(unsigned));
+    int *items = malloc(stack->frameCount * PAGE_BYTES);
+    if (stack->frames == NULL || stack->queue == NULL || items == NULL)
+    {
+        free(items);
+        free(stack->queue);
+        free(stack->frames);
+        close(stack->fd);
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned i = 0; i < stack->frameCount; i++)
+    {
+        stack->frames[i].items = items + (size_t)i * SPILL_PAGE_ITEMS;
+        stack->frames[i].page = UINT64_MAX;
+    }
+    stack->frames[0].page = 0;
+    stack->frames[0].dirty = 1;
+    stack->current = items;
+
+    pthread_mutex_init(&stack->mutex, NULL);
+    pthread_cond_init(&stack->work, NULL);
+    pthread_cond_init(&stack->done, NULL);
+    if (pthread_create(&stack->thread, NULL, ioThread, stack) != 0)
+    {
+        pthread_cond_destroy(&stack->done);
+        pthread_cond_destroy(&stack->work);
+        pthread_mutex_destroy(&stack->mutex);
+        free(items);
+        free(stack->queue);
+        free(stack->frames);
+        close(stack->fd);
+        return STACK_IO_ERROR;
+    }
+    return STACK_OK;
+}
+
+/**
+ * @brief Stops the I/O thread, closes the scratch file and frees the frames.
+ * @details Queued transfers that have not started are dropped; the file is deleted anyway.
+ * @param stack A pointer to the stack.
+ */
+void closeSpillStack(SpillStack *stack)
+{
+    pthread_mutex_lock(&stack->mutex);
+    stack->stopping = 1;
+    pthread_cond_signal(&stack->work);
+    pthread_mutex_unlock(&stack->mutex);
+    pthread_join(stack->thread, NULL);
+
+    pthread_cond_destroy(&stack->done);
+    pthread_cond_destroy(&stack->work);
+    pthread_mutex_destroy(&stack->mutex);
+    free(stack->frames[0].items);
+    free(stack->queue);
+    free(stack->frames);
+    close(stack->fd);
+}
+
+/**
+ * @brief Pushes an item, spilling the lowest resident page if a new page needs its frame.
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillPush(SpillStack *stack, int item)
+{
+    uint64_t page = stack->size / SPILL_PAGE_ITEMS;
+    if (STACK_UNLIKELY(page != stack->currentPage))
+    {
+        StackStatus status = enterPage(stack, page);
+        if (status != STACK_OK)
+        {
+            return status;
+        }
+    }
+    stack->current[stack->size % SPILL_PAGE_ITEMS] = item;
+    stack->size++;
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the top item, waiting for its page if it is still being read back.
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop,
+ *         STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillTryPop(SpillStack *stack, int *out)
+{
+    StackStatus status = spillTryPeek(stack, out);
+    if (STACK_UNLIKELY(status != STACK_OK))
+    {
+        return status;
+    }
+    stack->size--;
+    return STACK_OK;
+}
+
+/**
+ * @brief Reads the top item, waiting for its page if it is still being read back.
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty,
+ *         STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillTryPeek(SpillStack *stack, int *out)
+{
+    if (STACK_UNLIKELY(stack->size == 0))
+    {
+        return STACK_EMPTY;
+    }
+    uint64_t page = (stack->size - 1) / SPILL_PAGE_ITEMS;
+    if (STACK_UNLIKELY(page != stack->currentPage))
+    {
+        StackStatus status = enterPage(stack, page);
+        if (status != STACK_OK)
+        {
+            return status;
+        }
+    }
+    *out = stack->current[(stack->size - 1) % SPILL_PAGE_ITEMS];
+    return STACK_OK;
+}
+
+/**
+ * @brief Returns the number of items on the stack.
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+uint64_t spillSize(SpillStack *stack)
+{
+    return stack->size;
+}
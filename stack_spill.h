@@ -0,0 +1,159 @@
+/**
+ * @file stack_spill.h
+ *
+ * @brief A stack deeper than memory: the top pages live in RAM, colder pages in a scratch file.
+ *
+ * The stack is cut into pages of SPILL_PAGE_ITEMS elements and keeps a fixed
+ * number of page frames in memory, chosen when it is opened; that is all the
+ * memory it ever uses, however deep it gets. When pushes need more pages than
+ * the frames can hold, the lowest resident page is handed to a background I/O
+ * thread, which writes it to the file while pushing goes on in the other frames.
+ * When pops get within SPILL_PREFETCH_PAGES pages of the spilled part, the pages
+ * below are queued for reading the same way, so a page is normally back in its
+ * frame before the pops reach it.
+ *
+ * Push, pop and peek touch only the current frame; the mutex shared with the I/O
+ * thread is taken once per page crossed. A spilled page whose frame has not been
+ * reused yet is taken back without reading it, and a page that was read back and
+ * never became the top again is dropped without writing it, so a stack moving
+ * up and down around the same depth does no I/O at all.
+ *
+ * A failed read or write makes the stack return STACK_IO_ERROR instead of the
+ * process running out of memory; after that only closeSpillStack() is safe.
+ * Requires a POSIX system with threads.
+ */
+
+#ifndef STACK_SPILL_H
+#define STACK_SPILL_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def SPILL_PAGE_ITEMS
+ * @brief Elements per page, the unit of every read and write (64 KiB of ints).
+ */
+#define SPILL_PAGE_ITEMS 16384
+
+/**
+ * @def SPILL_MIN_FRAMES
+ * @brief Fewest page frames a stack is opened with: the resident pages plus room for I/O in flight.
+ */
+#define SPILL_MIN_FRAMES 6
+
+/**
+ * @def SPILL_PREFETCH_PAGES
+ * @brief Pages kept resident below the top page when there are spilled pages to read back.
+ */
+#define SPILL_PREFETCH_PAGES 2
+
+/**
+ * @enum spillOp
+ * @brief The I/O queued on a frame.
+ */
+typedef enum spillOp
+{
+    SPILL_IDLE = 0, /**< Nothing queued; the frame may be used */
+    SPILL_WRITE,    /**< Write the frame to its page of the file */
+    SPILL_READ      /**< Read the frame from its page of the file */
+} SpillOp;
+
+/**
+ * @struct spillFrame
+ * @brief One page of memory and the page it holds.
+ */
+typedef struct spillFrame
+{
+    int *items;     /**< SPILL_PAGE_ITEMS elements */
+    uint64_t page;  /**< The page whose elements the frame holds or is being read with */
+    SpillOp op;     /**< The I/O queued or running on the frame; guarded by the mutex */
+    int dirty;      /**< Non-zero if the frame may differ from the file */
+} SpillFrame;
+
+/**
+ * @struct spillStack
+ * @brief An open spill-to-disk stack.
+ *
+ * Page p always lives in frame p % frameCount. Pages below `diskPages` are in
+ * the file; pages from `diskPages` up to the top page are resident.
+ */
+typedef struct spillStack
+{
+    int *current;           /**< Items of page `currentPage` */
+    uint64_t currentPage;   /**< The page push, pop and peek are working in */
+    uint64_t size;          /**< Elements on the stack */
+    uint64_t diskPages;     /**< Pages whose copy is in, or on its way to, the file */
+    SpillFrame *frames;     /**< The page frames */
+    unsigned frameCount;    /**< Number of frames */
+    int fd;                 /**< Descriptor of the scratch file */
+    pthread_t thread;       /**< The I/O thread */
+    pthread_mutex_t mutex;  /**< Guards everything below and the frames' `op` */
+    pthread_cond_t work;    /**< Signalled when I/O is queued or the thread should stop */
+    pthread_cond_t done;    /**< Signalled when I/O completes */
+    unsigned *queue;        /**< Frames with queued I/O, in order, as a ring of frameCount entries */
+    unsigned queueHead;     /**< Index of the oldest entry of `queue` */
+    unsigned queueCount;    /**< Entries in `queue` */
+    int stopping;           /**< Non-zero once the thread has been asked to exit */
+    int ioError;            /**< Non-zero once a read or write has failed */
+} SpillStack;
+
+/**
+ * @brief Opens an empty stack spilling to a new scratch file.
+ *
+ * @details The file is created at `path`, truncated, and unlinked at once, so it
+ *          disappears when the stack is closed or the process dies.
+ * @param stack A pointer to the stack to initialize.
+ * @param path Where to create the scratch file, on a local file system with room for the deepest stack.
+ * @param frames Page frames to keep in memory; raised to SPILL_MIN_FRAMES if lower.
+ * @return STACK_OK on success, STACK_IO_ERROR if the file could not be created or
+ *         the thread started, STACK_NO_MEMORY if the frames could not be allocated.
+ */
+StackStatus openSpillStack(SpillStack *stack, const char *path, unsigned frames);
+
+/**
+ * @brief Stops the I/O thread, closes the scratch file and frees the frames.
+ *
+ * @param stack A pointer to the stack.
+ */
+void closeSpillStack(SpillStack *stack);
+
+/**
+ * @brief Pushes an item, spilling the lowest resident page if a new page needs its frame.
+ *
+ * @param stack A pointer to the stack.
+ * @param item The item to be pushed onto the stack.
+ * @return STACK_OK on success, STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillPush(SpillStack *stack, int item);
+
+/**
+ * @brief Pops the top item, waiting for its page if it is still being read back.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the popped item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop,
+ *         STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillTryPop(SpillStack *stack, int *out);
+
+/**
+ * @brief Reads the top item, waiting for its page if it is still being read back.
+ *
+ * @param stack A pointer to the stack.
+ * @param out Receives the top item; left untouched if the stack is empty.
+ * @return STACK_OK on success, STACK_EMPTY if the stack is empty,
+ *         STACK_IO_ERROR if a read or write has failed.
+ */
+StackStatus spillTryPeek(SpillStack *stack, int *out);
+
+/**
+ * @brief Returns the number of items on the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @return The number of items.
+ */
+uint64_t spillSize(SpillStack *stack);
+
+#endif /* STACK_SPILL_H */
@@ -0,0 +1,258 @@
+/**
+ * @file stack_stats.c
+ *
+ * @brief Implementation of the stack statistics declared in stack_stats.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stack_stats.h"
+
+#define EXPORT_BUFFER_BYTES 32768 /**< Room for a snapshot with every bucket in use */
+
+_Thread_local unsigned statsThreadShard;
+
+static _Atomic unsigned nextShard;
+
+/**
+ * @brief Gives the calling thread its shard number, round-robin over the threads that ask.
+ * @return The shard number.
+ */
+unsigned statsAssignShard(void)
+{
+    unsigned shard = atomic_fetch_add_explicit(&nextShard, 1, memory_order_relaxed) % STATS_SHARDS;
+    statsThreadShard = shard + 1;
+    return shard;
+}
+
+/**
+ * @brief Returns the current time for the latency samples.
+ * @return Nanoseconds since an arbitrary point; never 0.
+ */
+uint64_t statsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) | 1;
+}
+
+/**
+ * @brief Returns the histogram bucket of a latency.
+ * @details Values below 4 have a bucket each; above, a value with its highest bit at
+ *          position e falls in one of four buckets for [2^e, 2^(e+1)), picked by the
+ *          two bits below the highest.
+ */
+static unsigned bucketOf(uint64_t ns)
+{
+    if (ns < 4)
+    {
+        return (unsigned)ns;
+    }
+    unsigned exponent = 63 - (unsigned)__builtin_clzll(ns);
+    if (exponent >= STATS_MAX_EXPONENT)
+    {
+        return STATS_BUCKETS - 1; // Its floor is 2^STATS_MAX_EXPONENT
+    }
+    return 4 * (exponent - 1) + (unsigned)((ns >> (exponent - 2)) & 3);
+}
+
+/**
+ * @brief Returns the smallest latency falling in a bucket.
+ */
+static uint64_t bucketFloor(unsigned bucket)
+{
+    if (bucket < 4)
+    {
+        return bucket;
+    }
+    unsigned exponent = bucket / 4 + 1;
+    return (uint64_t)(4 + bucket % 4) << (exponent - 2);
+}
+
+/**
+ * @brief Adds a sampled latency to a histogram.
+ * @param shard The shard holding the histogram.
+ * @param op STATS_PUSH or STATS_POP.
+ * @param ns The latency.
+ */
+void statsRecordLatency(StatsShard *shard, StatsOp op, uint64_t ns)
+{
+    statsAdd(&shard->latency[op][bucketOf(ns)], 1);
+}
+
+/**
+ * @brief Initializes a StackStats with every counter at zero; also resets one.
+ * @param stats A pointer to the statistics.
+ */
+void initStackStats(StackStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/**
+ * @brief Adds up the shards of a StackStats.
+ * @param stats A pointer to the statistics.
+ * @param snapshot Receives the totals.
+ */
+void takeStatsSnapshot(StackStats *stats, StatsSnapshot *snapshot)
+{
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (unsigned s = 0; s < STATS_SHARDS; s++)
+    {
+        StatsShard *shard = &stats->shards[s];
+        for (unsigned i = 0; i < STATS_OPS; i++)
+        {
+            snapshot->ops[i] += atomic_load_explicit(&shard->ops[i], memory_order_relaxed);
+        }
+        for (unsigned i = 0; i < STATS_EVENTS; i++)
+        {
+            snapshot->events[i] += atomic_load_explicit(&shard->events[i], memory_order_relaxed);
+        }
+        uint64_t depth = atomic_load_explicit(&shard->maxDepth, memory_order_relaxed);
+        if (depth > snapshot->maxDepth)
+        {
+            snapshot->maxDepth = depth;
+        }
+        for (unsigned op = 0; op < STATS_TIMED_OPS; op++)
+        {
+            for (unsigned b = 0; b < STATS_BUCKETS; b++)
+            {
+                snapshot->latency[op][b] += atomic_load_explicit(&shard->latency[op][b], memory_order_relaxed);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns a percentile of a sampled latency histogram.
+ * @param snapshot A pointer to the snapshot.
+ * @param op STATS_PUSH or STATS_POP.
+ * @param q The percentile as a fraction, e.g. 0.99.
+ * @return The lower bound in ns of the bucket holding the percentile, or 0 if nothing was sampled.
+ */
+uint64_t statsPercentile(const StatsSnapshot *snapshot, StatsOp op, double q)
+{
+    uint64_t samples = 0;
+    for (unsigned b = 0; b < STATS_BUCKETS; b++)
+    {
+        samples += snapshot->latency[op][b];
+    }
+    if (samples == 0)
+    {
+        return 0;
+    }
+    // Rank of the sample at the percentile, counting from 1
+    uint64_t rank = (uint64_t)(q * (double)samples + 0.5);
+    rank = rank < 1 ? 1 : rank > samples ? samples : rank;
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < STATS_BUCKETS; b++)
+    {
+        seen += snapshot->latency[op][b];
+        if (seen >= rank)
+        {
+            return bucketFloor(b);
+        }
+    }
+    return bucketFloor(STATS_BUCKETS - 1);
+}
+
+/**
+ * @struct exportBuffer
+ * @brief Text of an export being assembled.
+ */
+typedef struct exportBuffer
+{
+    char text[EXPORT_BUFFER_BYTES]; /**< The text so far */
+    size_t length;                  /**< Bytes used */
+} ExportBuffer;
+
+/**
+ * @brief Appends formatted text; text that does not fit is dropped (it always fits).
+ */
+static void appendf(ExportBuffer *out, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(out->text + out->length, sizeof(out->text) - out->length, format, args);
+    va_end(args);
+    if (n > 0)
+    {
+        out->length += (size_t)n < sizeof(out->text) - out->length ? (size_t)n : sizeof(out->text) - out->length - 1;
+    }
+}
+
+/**
+ * @brief Appends the summary and the non-empty buckets of one histogram.
+ */
+static void appendHistogram(ExportBuffer *out, const StatsSnapshot *snapshot, StatsOp op)
+{
+    uint64_t samples = 0;
+    for (unsigned b = 0; b < STATS_BUCKETS; b++)
+    {
+        samples += snapshot->latency[op][b];
+    }
+    appendf(out, "{\"samples\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"buckets\":[",
+            (unsigned long long)samples, (unsigned long long)statsPercentile(snapshot, op, 0.5),
+            (unsigned long long)statsPercentile(snapshot, op, 0.9),
+            (unsigned long long)statsPercentile(snapshot, op, 0.99),
+            (unsigned long long)statsPercentile(snapshot, op, 0.999));
+    const char *separator = "";
+    for (unsigned b = 0; b < STATS_BUCKETS; b++)
+    {
+        if (snapshot->latency[op][b] != 0)
+        {
+            appendf(out, "%s[%llu,%llu]", separator, (unsigned long long)bucketFloor(b),
+                    (unsigned long long)snapshot->latency[op][b]);
+            separator = ",";
+        }
+    }
+    appendf(out, "]}");
+}
+
+/**
+ * @brief Writes a snapshot as one line of JSON.
+ * @param snapshot A pointer to the snapshot.
+ * @param fd The descriptor to write to.
+ * @return STACK_OK on success, STACK_IO_ERROR if the descriptor could not be written.
+ */
+StackStatus exportStats(const StatsSnapshot *snapshot, int fd)
+{
+    static const char *const events[STATS_EVENTS] = { "full", "underflow", "no_memory", "grow", "shrink" };
+    ExportBuffer out;
+    out.length = 0;
+
+    appendf(&out, "{\"ops\":{\"push\":%llu,\"pop\":%llu,\"peek\":%llu},\"events\":{",
+            (unsigned long long)snapshot->ops[STATS_PUSH], (unsigned long long)snapshot->ops[STATS_POP],
+            (unsigned long long)snapshot->ops[STATS_PEEK]);
+    for (unsigned i = 0; i < STATS_EVENTS; i++)
+    {
+        appendf(&out, "%s\"%s\":%llu", i ? "," : "", events[i], (unsigned long long)snapshot->events[i]);
+    }
+    appendf(&out, "},\"max_depth\":%llu,\"latency_ns\":{\"push\":", (unsigned long long)snapshot->maxDepth);
+    appendHistogram(&out, snapshot, STATS_PUSH);
+    appendf(&out, ",\"pop\":");
+    appendHistogram(&out, snapshot, STATS_POP);
+    appendf(&out, "}}\n");
+
+    for (size_t done = 0; done < out.length;)
+    {
+        ssize_t n = write(fd, out.text + done, out.length - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return STACK_IO_ERROR;
+        }
+        done += (size_t)n;
+    }
+    return STACK_OK;
+}
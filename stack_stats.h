@@ -0,0 +1,324 @@
+/**
+ * @file stack_stats.h
+ *
+ * @brief Optional operation counters and latency histograms for the array and lock-free stacks.
+ *
+ * Statistics are compiled in only when STACK_STATS is defined for the whole
+ * build, since it adds a `stats` pointer to struct Stack and LockFreeStack.
+ * Without it the hooks below expand to nothing and the stacks are exactly as
+ * fast as before. With it, a stack records into the StackStats its `stats`
+ * pointer refers to, and does nothing while that pointer is NULL.
+ *
+ * A StackStats counts successful pushes, pops and peeks, rejected operations
+ * (full, empty, out of memory), array resizes and the deepest the stack has
+ * been. One push or pop in STATS_SAMPLE_PERIOD is timed into a log-linear
+ * histogram: four buckets per power of two, so a reported latency is within
+ * 25% of the measured one at any scale.
+ *
+ * Counters live in STATS_SHARDS cache-line aligned shards, and each thread
+ * updates the shard its thread number selects, so threads sharing a lock-free
+ * stack rarely contend on the counters. Thread numbers are handed out
+ * round-robin, so two threads may share a shard however few are running;
+ * counters are therefore bumped with relaxed atomic adds, which stay cheap on
+ * a shard no other thread touches, and counts are exact for any number of
+ * threads. Only the sampling countdown is a plain load and store: threads
+ * racing on it merely shift which operation gets timed. takeStatsSnapshot()
+ * adds the shards up.
+ */
+
+#ifndef STACK_STATS_H
+#define STACK_STATS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def STATS_SHARDS
+ * @brief Number of per-thread counter shards of a StackStats.
+ */
+#define STATS_SHARDS 16
+
+/**
+ * @def STATS_SAMPLE_PERIOD
+ * @brief One push or pop in this many, per shard, is timed.
+ */
+#define STATS_SAMPLE_PERIOD 1024
+
+/**
+ * @def STATS_MAX_EXPONENT
+ * @brief Latencies of 2^STATS_MAX_EXPONENT ns (about a minute) or more share the last bucket.
+ */
+#define STATS_MAX_EXPONENT 36
+
+/**
+ * @def STATS_BUCKETS
+ * @brief Buckets of a latency histogram: 0-3 ns one by one, four per power of two up
+ *        to 2^STATS_MAX_EXPONENT ns, and a last one for anything longer.
+ */
+#define STATS_BUCKETS (4 * (STATS_MAX_EXPONENT - 1) + 1)
+
+/**
+ * @enum statsOp
+ * @brief Operations counted by a StackStats.
+ */
+typedef enum statsOp
+{
+    STATS_PUSH = 0, /**< Successful pushes; timed */
+    STATS_POP,      /**< Successful pops; timed */
+    STATS_PEEK,     /**< Successful peeks */
+    STATS_OPS       /**< Number of operations */
+} StatsOp;
+
+/**
+ * @def STATS_TIMED_OPS
+ * @brief Operations with a latency histogram: the push and the pop.
+ */
+#define STATS_TIMED_OPS 2
+
+/**
+ * @enum statsEvent
+ * @brief Events counted by a StackStats.
+ */
+typedef enum statsEvent
+{
+    STATS_FULL = 0,  /**< Pushes rejected by a full fixed-capacity stack */
+    STATS_UNDERFLOW, /**< Pops and peeks that found the stack empty */
+    STATS_NO_MEMORY, /**< Operations that failed to allocate memory */
+    STATS_GROW,      /**< Times the array grew */
+    STATS_SHRINK,    /**< Times the array shrank */
+    STATS_EVENTS     /**< Number of events */
+} StatsEvent;
+
+/**
+ * @struct statsShard
+ * @brief The counters updated by the threads mapped to one shard.
+ */
+typedef struct statsShard
+{
+    _Alignas(64) _Atomic uint64_t ops[STATS_OPS];                 /**< Count of each StatsOp */
+    _Atomic uint64_t events[STATS_EVENTS];                        /**< Count of each StatsEvent */
+    _Atomic uint64_t maxDepth;                                    /**< Deepest stack seen after a push */
+    _Atomic uint32_t countdown[STATS_TIMED_OPS];                  /**< Operations of each kind left before the next sample */
+    _Atomic uint64_t latency[STATS_TIMED_OPS][STATS_BUCKETS];     /**< Sampled latency histograms */
+} StatsShard;
+
+/**
+ * @struct stackStats
+ * @brief Statistics of one stack, or of several stacks pointing to the same StackStats.
+ */
+typedef struct stackStats
+{
+    StatsShard shards[STATS_SHARDS]; /**< Per-thread counters */
+} StackStats;
+
+/**
+ * @struct statsSnapshot
+ * @brief The counters of a StackStats added up over all shards.
+ */
+typedef struct statsSnapshot
+{
+    uint64_t ops[STATS_OPS];                           /**< Count of each StatsOp */
+    uint64_t events[STATS_EVENTS];                     /**< Count of each StatsEvent */
+    uint64_t maxDepth;                                 /**< Deepest stack seen; 0 for lock-free stacks */
+    uint64_t latency[STATS_TIMED_OPS][STATS_BUCKETS];  /**< Sampled latency histograms */
+} StatsSnapshot;
+
+/**
+ * @brief Initializes a StackStats with every counter at zero; also resets one.
+ * @param stats A pointer to the statistics.
+ */
+void initStackStats(StackStats *stats);
+
+/**
+ * @brief Adds up the shards of a StackStats.
+ * @details May run while other threads update the statistics; each counter is
+ *          then read at some point during the call.
+ * @param stats A pointer to the statistics.
+ * @param snapshot Receives the totals.
+ */
+void takeStatsSnapshot(StackStats *stats, StatsSnapshot *snapshot);
+
+/**
+ * @brief Returns a percentile of a sampled latency histogram.
+ * @param snapshot A pointer to the snapshot.
+ * @param op STATS_PUSH or STATS_POP.
+ * @param q The percentile as a fraction, e.g. 0.99.
+ * @return The lower bound in ns of the bucket holding the percentile, or 0 if nothing was sampled.
+ */
+uint64_t statsPercentile(const StatsSnapshot *snapshot, StatsOp op, double q);
+
+/**
+ * @brief Writes a snapshot as one line of JSON.
+ * @details The histograms list their non-empty buckets as `[lower bound in ns, count]` pairs.
+ * @param snapshot A pointer to the snapshot.
+ * @param fd The descriptor to write to.
+ * @return STACK_OK on success, STACK_IO_ERROR if the descriptor could not be written.
+ */
+StackStatus exportStats(const StatsSnapshot *snapshot, int fd);
+
+/* ---------------------------------------------------------------------------
+ * Hooks used by the stacks
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct statsTimer
+ * @brief The shard an operation records into, and its start time if it is sampled.
+ */
+typedef struct statsTimer
+{
+    StatsShard *shard; /**< NULL when the stack has no statistics attached */
+    uint64_t start;    /**< Start time in ns, or 0 when the operation is not timed */
+} StatsTimer;
+
+/**
+ * @brief Shard number of the calling thread plus one, 0 until statsAssignShard() has run.
+ */
+extern _Thread_local unsigned statsThreadShard;
+
+/**
+ * @brief Gives the calling thread its shard number, round-robin over the threads that ask.
+ * @return The shard number.
+ */
+unsigned statsAssignShard(void);
+
+/**
+ * @brief Returns the current time for the latency samples.
+ * @return Nanoseconds since an arbitrary point; never 0.
+ */
+uint64_t statsNow(void);
+
+/**
+ * @brief Adds a sampled latency to a histogram.
+ * @param shard The shard holding the histogram.
+ * @param op STATS_PUSH or STATS_POP.
+ * @param ns The latency.
+ */
+void statsRecordLatency(StatsShard *shard, StatsOp op, uint64_t ns);
+
+/**
+ * @brief Returns the shard of the calling thread.
+ * @param stats A pointer to the statistics.
+ * @return A pointer to the shard.
+ */
+static inline StatsShard *statsShard(StackStats *stats)
+{
+    unsigned shard = statsThreadShard;
+    return &stats->shards[shard ? shard - 1 : statsAssignShard()];
+}
+
+/**
+ * @brief Adds to a counter of the calling thread's shard.
+ */
+static inline void statsAdd(_Atomic uint64_t *counter, uint64_t n)
+{
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+/**
+ * @brief Raises a shard's maximum depth to `depth` if it is deeper.
+ */
+static inline void statsRaiseDepth(StatsShard *shard, uint64_t depth)
+{
+    uint64_t seen = atomic_load_explicit(&shard->maxDepth, memory_order_relaxed);
+    while (depth > seen &&
+           !atomic_compare_exchange_weak_explicit(&shard->maxDepth, &seen, depth, memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+        // A failed exchange has reloaded `seen`
+    }
+}
+
+/**
+ * @brief Starts recording a push or a pop.
+ * @details Pushes and pops are sampled separately, so strictly alternating
+ *          operations cannot leave one of them never timed.
+ * @param stats The statistics of the stack, or NULL.
+ * @param op STATS_PUSH or STATS_POP.
+ * @return The timer to pass to statsEnd().
+ */
+static inline StatsTimer statsBegin(StackStats *stats, StatsOp op)
+{
+    StatsTimer timer = { NULL, 0 };
+    if (stats == NULL)
+    {
+        return timer;
+    }
+    timer.shard = statsShard(stats);
+    uint32_t countdown = atomic_load_explicit(&timer.shard->countdown[op], memory_order_relaxed);
+    if (STACK_UNLIKELY(countdown == 0))
+    {
+        countdown = STATS_SAMPLE_PERIOD;
+        timer.start = statsNow();
+    }
+    atomic_store_explicit(&timer.shard->countdown[op], countdown - 1, memory_order_relaxed);
+    return timer;
+}
+
+/**
+ * @brief Records `n` successful operations into a shard, and the latency of a sampled one.
+ * @param timer The timer returned by statsBegin(), or one without a start time.
+ * @param op The operation.
+ * @param n The number of operations.
+ * @param depth The size of the stack afterwards, or 0 if unknown.
+ */
+static inline void statsEnd(StatsTimer timer, StatsOp op, uint64_t n, uint64_t depth)
+{
+    if (timer.shard == NULL)
+    {
+        return;
+    }
+    statsAdd(&timer.shard->ops[op], n);
+    statsRaiseDepth(timer.shard, depth);
+    if (STACK_UNLIKELY(timer.start != 0))
+    {
+        statsRecordLatency(timer.shard, op, statsNow() - timer.start);
+    }
+}
+
+/**
+ * @brief Records `n` successful operations without timing them.
+ * @param stats The statistics of the stack, or NULL.
+ * @param op The operation.
+ * @param n The number of operations.
+ * @param depth The size of the stack afterwards, or 0 if unknown.
+ */
+static inline void statsCount(StackStats *stats, StatsOp op, uint64_t n, uint64_t depth)
+{
+    if (stats != NULL)
+    {
+        statsEnd((StatsTimer){ statsShard(stats), 0 }, op, n, depth);
+    }
+}
+
+/**
+ * @brief Records an event.
+ * @param stats The statistics of the stack, or NULL.
+ * @param event The event.
+ */
+static inline void statsEvent(StackStats *stats, StatsEvent event)
+{
+    if (stats != NULL)
+    {
+        statsAdd(&statsShard(stats)->events[event], 1);
+    }
+}
+
+/*
+ * The stacks call the hooks through these macros, which compile to nothing
+ * unless STACK_STATS is defined.
+ */
+#ifdef STACK_STATS
+#define STACK_STATS_BEGIN(stats, op, timer) StatsTimer timer = statsBegin(stats, op)
+#define STACK_STATS_END(timer, op, n, depth) statsEnd(timer, op, n, depth)
+#define STACK_STATS_COUNT(stats, op, n, depth) statsCount(stats, op, n, depth)
+#define STACK_STATS_EVENT(stats, event) statsEvent(stats, event)
+#else
+#define STACK_STATS_BEGIN(stats, op, timer) ((void)0)
+#define STACK_STATS_END(timer, op, n, depth) ((void)0)
+#define STACK_STATS_COUNT(stats, op, n, depth) ((void)0)
+#define STACK_STATS_EVENT(stats, event) ((void)0)
+#endif
+
+#endif /* STACK_STATS_H */
@@ -0,0 +1,310 @@
+/**
+ * @file stack_steal.c
+ *
+ * @brief Implementation of the work-stealing deques declared in stack_steal.h.
+ *
+ * The memory orderings follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ */
+
+#include <stdlib.h>
+
+#include "stack_steal.h"
+
+/**
+ * @brief Allocates a circular buffer.
+ * @param capacity The number of slots, a power of two.
+ * @return A pointer to the buffer, or NULL if it could not be allocated.
+ */
+static DequeBuffer *newBuffer(int64_t capacity)
+{
+    DequeBuffer *buffer = malloc(sizeof(DequeBuffer) + (size_t)capacity * sizeof(_Atomic int));
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->capacity = capacity;
+    buffer->retired = NULL;
+    return buffer;
+}
+
+/**
+ * @brief Returns the slot holding the element with the given index.
+ * @param buffer A pointer to the buffer.
+ * @param index The element index.
+ * @return A pointer to the slot.
+ */
+static _Atomic int *slotAt(DequeBuffer *buffer, int64_t index)
+{
+    return &buffer->items[index & (buffer->capacity - 1)];
+}
+
+/**
+ * @brief Moves the elements into a buffer twice as large.
+ * @details Thieves may still be reading the old buffer, so it is only retired here
+ *          and freed together with the deque.
+ * @param deque A pointer to the deque.
+ * @param old The current buffer.
+ * @param bottom The index of the oldest element.
+ * @param top The index one past the newest element.
+ * @return The new buffer, or NULL if it could not be allocated.
+ */
+static DequeBuffer *growBuffer(WorkDeque *deque, DequeBuffer *old, int64_t bottom, int64_t top)
+{
+    DequeBuffer *buffer = newBuffer(old->capacity * 2);
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    for (int64_t i = bottom; i < top; i++)
+    {
+        atomic_store_explicit(slotAt(buffer, i),
+                              atomic_load_explicit(slotAt(old, i), memory_order_relaxed),
+                              memory_order_relaxed);
+    }
+    buffer->retired = old;
+    atomic_store_explicit(&deque->buffer, buffer, memory_order_release);
+    return buffer;
+}
+
+/**
+ * @brief Initializes an empty deque.
+ * @param deque A pointer to the deque to initialize.
+ * @param capacity The initial capacity, rounded up to a power of two.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus initWorkDeque(WorkDeque *deque, unsigned capacity)
+{
+    int64_t size = 1;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+    DequeBuffer *buffer = newBuffer(size);
+    if (buffer == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->buffer, buffer);
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees the current buffer and every buffer it replaced.
+ * @param deque A pointer to the deque.
+ */
+void destroyWorkDeque(WorkDeque *deque)
+{
+    DequeBuffer *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    while (buffer != NULL)
+    {
+        DequeBuffer *retired = buffer->retired;
+        free(buffer);
+        buffer = retired;
+    }
+    atomic_store_explicit(&deque->buffer, NULL, memory_order_relaxed);
+}
+
+/**
+ * @brief Pushes an item at the owner's end, growing the buffer when it is full.
+ * @param deque A pointer to the deque.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a full deque could not grow.
+ */
+StackStatus workDequePush(WorkDeque *deque, int item)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    DequeBuffer *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    if (STACK_UNLIKELY(top - bottom >= buffer->capacity))
+    {
+        buffer = growBuffer(deque, buffer, bottom, top);
+        if (buffer == NULL)
+        {
+            return STACK_NO_MEMORY;
+        }
+    }
+    atomic_store_explicit(slotAt(buffer, top), item, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->top, top + 1, memory_order_relaxed);
+    return STACK_OK;
+}
+
+/**
+ * @brief Pops the newest item at the owner's end.
+ * @details The owner claims the slot by lowering `top` first; only when that
+ *          leaves a single element does it have to CAS `bottom` against thieves.
+ * @param deque A pointer to the deque.
+ * @param out Receives the popped item; left untouched if the deque is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus workDequePop(WorkDeque *deque, int *out)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed) - 1;
+    DequeBuffer *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    atomic_store_explicit(&deque->top, top, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+
+    if (STACK_UNLIKELY(bottom > top))
+    {
+        // Already empty: undo the claim
+        atomic_store_explicit(&deque->top, top + 1, memory_order_relaxed);
+        return STACK_EMPTY;
+    }
+
+    int item = atomic_load_explicit(slotAt(buffer, top), memory_order_relaxed);
+    if (bottom == top)
+    {
+        // Last element: race the thieves for it
+        int won = atomic_compare_exchange_strong_explicit(&deque->bottom, &bottom, bottom + 1,
+                                                          memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->top, top + 1, memory_order_relaxed);
+        if (!won)
+        {
+            return STACK_EMPTY;
+        }
+    }
+    *out = item;
+    return STACK_OK;
+}
+
+/**
+ * @brief Steals the oldest item from the thieves' end.
+ * @details A lost CAS means another thread took that element, so the steal
+ *          retries until it succeeds or finds the deque empty.
+ * @param deque A pointer to the deque.
+ * @param out Receives the stolen item; left untouched if the deque is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to steal.
+ */
+StackStatus workDequeSteal(WorkDeque *deque, int *out)
+{
+    for (;;)
+    {
+        int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+        if (bottom >= top)
+        {
+            return STACK_EMPTY;
+        }
+
+        DequeBuffer *buffer = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+        int item = atomic_load_explicit(slotAt(buffer, bottom), memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&deque->bottom, &bottom, bottom + 1,
+                                                    memory_order_seq_cst, memory_order_relaxed))
+        {
+            *out = item;
+            return STACK_OK;
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of items in the deque.
+ * @param deque A pointer to the deque.
+ * @return The number of items.
+ */
+size_t workDequeSize(WorkDeque *deque)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    return top > bottom ? (size_t)(top - bottom) : 0;
+}
+
+/**
+ * @brief Initializes a pool of empty deques.
+ * @param pool A pointer to the pool to initialize.
+ * @param workers The number of worker threads.
+ * @param capacity The initial capacity of each deque.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the deques could not be allocated.
+ */
+StackStatus initStealPool(StealPool *pool, unsigned workers, unsigned capacity)
+{
+    if (workers == 0)
+    {
+        workers = 1;
+    }
+    pool->deques = aligned_alloc(STEAL_CACHE_LINE, workers * sizeof(WorkDeque));
+    if (pool->deques == NULL)
+    {
+        return STACK_NO_MEMORY;
+    }
+    for (unsigned i = 0; i < workers; i++)
+    {
+        if (initWorkDeque(&pool->deques[i], capacity) != STACK_OK)
+        {
+            pool->workers = i;
+            destroyStealPool(pool);
+            return STACK_NO_MEMORY;
+        }
+    }
+    pool->workers = workers;
+    return STACK_OK;
+}
+
+/**
+ * @brief Frees every deque of the pool.
+ * @param pool A pointer to the pool.
+ */
+void destroyStealPool(StealPool *pool)
+{
+    for (unsigned i = 0; i < pool->workers; i++)
+    {
+        destroyWorkDeque(&pool->deques[i]);
+    }
+    free(pool->deques);
+    pool->deques = NULL;
+    pool->workers = 0;
+}
+
+/**
+ * @brief Pushes an item onto the calling worker's own deque.
+ * @param pool A pointer to the pool.
+ * @param worker The calling worker's number.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the deque could not grow.
+ */
+StackStatus stealPoolPush(StealPool *pool, unsigned worker, int item)
+{
+    return workDequePush(&pool->deques[worker], item);
+}
+
+/**
+ * @brief Pops from the calling worker's own deque, stealing if it is empty.
+ * @details Victims are visited round-robin from a random starting point, so
+ *          idle workers do not all pile onto the same victim.
+ * @param pool A pointer to the pool.
+ * @param worker The calling worker's number.
+ * @param out Receives the item.
+ * @return STACK_OK on success, STACK_EMPTY if every deque was found empty.
+ */
+StackStatus stealPoolPop(StealPool *pool, unsigned worker, int *out)
+{
+    if (workDequePop(&pool->deques[worker], out) == STACK_OK)
+    {
+        return STACK_OK;
+    }
+
+    static _Thread_local uint32_t seed = 0;
+    if (seed == 0)
+    {
+        seed = (uint32_t)(uintptr_t)&seed | 1; // Differs per thread
+    }
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    unsigned start = seed % pool->workers;
+    for (unsigned i = 0; i < pool->workers; i++)
+    {
+        unsigned victim = (start + i) % pool->workers;
+        if (victim != worker && workDequeSteal(&pool->deques[victim], out) == STACK_OK)
+        {
+            return STACK_OK;
+        }
+    }
+    return STACK_EMPTY;
+}
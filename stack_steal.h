@@ -0,0 +1,146 @@
+/**
+ * @file stack_steal.h
+ *
+ * @brief Per-thread work stacks with work stealing, for use as scheduler run queues.
+ *
+ * A WorkDeque is the array stack turned into a Chase-Lev deque: its owner thread
+ * pushes and pops at the top end exactly like a LIFO stack, with plain loads
+ * and stores and no CAS except when it races a thief for the very last element.
+ * Other threads may steal the oldest element from the bottom end with a CAS. The
+ * owner therefore keeps the cache locality of a thread-private stack, while idle
+ * threads can still take work from busy ones.
+ *
+ * A StealPool manages one deque per worker thread: each worker pushes and pops
+ * its own deque and, once that runs dry, steals from the others, starting at a
+ * randomly chosen victim.
+ */
+
+#ifndef STACK_STEAL_H
+#define STACK_STEAL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "stack.h"
+
+/**
+ * @def STEAL_CACHE_LINE
+ * @brief Alignment keeping the owner's and the thieves' indices on separate cache lines.
+ */
+#define STEAL_CACHE_LINE 64
+
+/**
+ * @struct dequeBuffer
+ * @brief Circular array of a deque; its capacity is a power of two.
+ */
+typedef struct dequeBuffer
+{
+    int64_t capacity;           /**< Number of slots */
+    struct dequeBuffer *retired; /**< Smaller buffer this one replaced, freed with the deque */
+    _Atomic int items[];        /**< Slots, indexed modulo capacity */
+} DequeBuffer;
+
+/**
+ * @struct workDeque
+ * @brief A stack owned by one thread that other threads can steal from.
+ * @details Elements live at indices `bottom .. top - 1` of the buffer. The owner
+ *          works at `top`, thieves at `bottom`.
+ */
+typedef struct workDeque
+{
+    _Alignas(STEAL_CACHE_LINE) _Atomic int64_t top;    /**< Index one past the newest element, moved only by the owner */
+    _Alignas(STEAL_CACHE_LINE) _Atomic int64_t bottom; /**< Index of the oldest element, advanced by thieves */
+    _Atomic(DequeBuffer *) buffer;                     /**< Current circular array */
+} WorkDeque;
+
+/**
+ * @brief Initializes an empty deque.
+ * @param deque A pointer to the deque to initialize.
+ * @param capacity The initial capacity, rounded up to a power of two.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the buffer could not be allocated.
+ */
+StackStatus initWorkDeque(WorkDeque *deque, unsigned capacity);
+
+/**
+ * @brief Frees the deque's buffers.
+ * @details No other thread may be using the deque anymore.
+ * @param deque A pointer to the deque.
+ */
+void destroyWorkDeque(WorkDeque *deque);
+
+/**
+ * @brief Pushes an item at the owner's end; only the owner thread may call this.
+ * @param deque A pointer to the deque.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if a full deque could not grow.
+ */
+StackStatus workDequePush(WorkDeque *deque, int item);
+
+/**
+ * @brief Pops the newest item at the owner's end; only the owner thread may call this.
+ * @param deque A pointer to the deque.
+ * @param out Receives the popped item; left untouched if the deque is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to pop.
+ */
+StackStatus workDequePop(WorkDeque *deque, int *out);
+
+/**
+ * @brief Steals the oldest item from the thieves' end; any thread may call this.
+ * @param deque A pointer to the deque.
+ * @param out Receives the stolen item; left untouched if the deque is empty.
+ * @return STACK_OK on success, STACK_EMPTY if there was nothing to steal.
+ */
+StackStatus workDequeSteal(WorkDeque *deque, int *out);
+
+/**
+ * @brief Returns the number of items in the deque.
+ * @details With other threads running the answer may be stale by the time it is used.
+ * @param deque A pointer to the deque.
+ * @return The number of items.
+ */
+size_t workDequeSize(WorkDeque *deque);
+
+/**
+ * @struct stealPool
+ * @brief One work deque per worker thread, with stealing between them.
+ */
+typedef struct stealPool
+{
+    WorkDeque *deques;  /**< Deque of each worker, indexed by worker number */
+    unsigned workers;   /**< Number of workers */
+} StealPool;
+
+/**
+ * @brief Initializes a pool of empty deques.
+ * @param pool A pointer to the pool to initialize.
+ * @param workers The number of worker threads.
+ * @param capacity The initial capacity of each deque.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the deques could not be allocated.
+ */
+StackStatus initStealPool(StealPool *pool, unsigned workers, unsigned capacity);
+
+/**
+ * @brief Frees every deque of the pool.
+ * @param pool A pointer to the pool.
+ */
+void destroyStealPool(StealPool *pool);
+
+/**
+ * @brief Pushes an item onto the calling worker's own deque.
+ * @param pool A pointer to the pool.
+ * @param worker The calling worker's number.
+ * @param item The item to be pushed.
+ * @return STACK_OK on success, STACK_NO_MEMORY if the deque could not grow.
+ */
+StackStatus stealPoolPush(StealPool *pool, unsigned worker, int item);
+
+/**
+ * @brief Pops from the calling worker's own deque, stealing from another worker if it is empty.
+ * @param pool A pointer to the pool.
+ * @param worker The calling worker's number.
+ * @param out Receives the item.
+ * @return STACK_OK on success, STACK_EMPTY if every deque was found empty.
+ */
+StackStatus stealPoolPop(StealPool *pool, unsigned worker, int *out);
+
+#endif /* STACK_STEAL_H */
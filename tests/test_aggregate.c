@@ -0,0 +1,76 @@
+/**
+ * @file test_aggregate.c
+ *
+ * @brief Minimum, maximum and sum of the aggregate stack against a brute-force scan.
+ */
+
+#include <stdlib.h>
+
+#include "stack_aggregate.h"
+#include "test_util.h"
+
+#define OPS 20000 /**< Random operations */
+
+static void testEmpty(void)
+{
+    AggregateStack stack;
+    CHECK(initAggregateStack(&stack, 4, 2.0) == STACK_OK);
+    int out = 42;
+    CHECK(aggregateMin(&stack, &out) == STACK_EMPTY && aggregateMax(&stack, &out) == STACK_EMPTY && out == 42);
+    CHECK(aggregateSum(&stack) == 0);
+    CHECK(aggregateTryPop(&stack, &out) == STACK_EMPTY);
+    destroyAggregateStack(&stack);
+}
+
+static void testAgainstScan(void)
+{
+    AggregateStack stack;
+    CHECK(initAggregateStack(&stack, 4, 2.0) == STACK_OK);
+    int *reference = malloc(OPS * sizeof(int));
+    unsigned size = 0;
+    srand(7);
+    for (int op = 0; op < OPS; op++)
+    {
+        if (size == 0 || rand() % 5 < 3)
+        {
+            int item = rand() % 2001 - 1000;
+            if (rand() % 50 == 0)
+            {
+                item = rand() % 2 ? 2000000000 : -2000000000; // The sum must not overflow an int
+            }
+            CHECK(aggregatePush(&stack, item) == STACK_OK);
+            reference[size++] = item;
+        }
+        else
+        {
+            int out;
+            CHECK(aggregateTryPop(&stack, &out) == STACK_OK && out == reference[--size]);
+        }
+
+        if (size == 0)
+        {
+            continue;
+        }
+        int min = reference[0], max = reference[0];
+        int64_t sum = 0;
+        for (unsigned i = 0; i < size; i++)
+        {
+            min = reference[i] < min ? reference[i] : min;
+            max = reference[i] > max ? reference[i] : max;
+            sum += reference[i];
+        }
+        int gotMin, gotMax;
+        CHECK(aggregateMin(&stack, &gotMin) == STACK_OK && gotMin == min);
+        CHECK(aggregateMax(&stack, &gotMax) == STACK_OK && gotMax == max);
+        CHECK(aggregateSum(&stack) == sum && aggregateSize(&stack) == size);
+    }
+    free(reference);
+    destroyAggregateStack(&stack);
+}
+
+int main(void)
+{
+    testEmpty();
+    testAgainstScan();
+    return testResult("test_aggregate");
+}
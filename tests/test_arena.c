@@ -0,0 +1,76 @@
+/**
+ * @file test_arena.c
+ *
+ * @brief The twin stack and the multi-stack report full and empty at the right moments.
+ */
+
+#include <stdlib.h>
+
+#include "stack_arena.h"
+#include "test_util.h"
+
+static void testTwinStack(void)
+{
+    TwinStack *twin = createTwinStack(5);
+    CHECK(twin != NULL);
+    int out = 42;
+    CHECK(twinTryPop(twin, 0, &out) == STACK_EMPTY && twinTryPeek(twin, 1, &out) == STACK_EMPTY && out == 42);
+
+    // The two stacks share the capacity, whichever one takes it
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(twinPush(twin, 0, i) == STACK_OK);
+    }
+    CHECK(twinPush(twin, 1, 10) == STACK_OK && twinPush(twin, 1, 11) == STACK_OK);
+    CHECK(twinPush(twin, 0, 3) == STACK_FULL && twinPush(twin, 1, 12) == STACK_FULL);
+    CHECK(twinSize(twin, 0) == 3 && twinSize(twin, 1) == 2);
+
+    CHECK(twinTryPop(twin, 1, &out) == STACK_OK && out == 11);
+    CHECK(twinPush(twin, 0, 3) == STACK_OK); // Stack 0 takes the freed slot
+    CHECK(twinTryPeek(twin, 0, &out) == STACK_OK && out == 3);
+    CHECK(twinTryPop(twin, 1, &out) == STACK_OK && out == 10);
+    CHECK(twinTryPop(twin, 1, &out) == STACK_EMPTY && out == 10);
+    for (int i = 3; i >= 0; i--)
+    {
+        CHECK(twinTryPop(twin, 0, &out) == STACK_OK && out == i);
+    }
+    CHECK(twinSize(twin, 0) == 0 && twinSize(twin, 1) == 0);
+    free(twin);
+}
+
+static void testMultiStack(void)
+{
+    MultiStack *multi = createMultiStack(3, 6);
+    CHECK(multi != NULL);
+    for (unsigned i = 0; i < 6; i++)
+    {
+        CHECK(multiPush(multi, i % 3, (int)i) == STACK_OK);
+    }
+    CHECK(multiPush(multi, 0, 99) == STACK_FULL);
+    CHECK(multiSize(multi, 0) == 2 && multiSize(multi, 1) == 2 && multiSize(multi, 2) == 2);
+
+    int out = -1;
+    CHECK(multiTryPop(multi, 1, &out) == STACK_OK && out == 4);
+    CHECK(multiTryPop(multi, 1, &out) == STACK_OK && out == 1);
+    CHECK(multiTryPop(multi, 1, &out) == STACK_EMPTY && out == 1);
+
+    // The freed slots go to whichever stack pushes next
+    CHECK(multiPush(multi, 2, 20) == STACK_OK && multiPush(multi, 2, 21) == STACK_OK);
+    CHECK(multiPush(multi, 2, 22) == STACK_FULL);
+    CHECK(multiTryPeek(multi, 2, &out) == STACK_OK && out == 21);
+    CHECK(multiSize(multi, 2) == 4);
+    int expected[] = { 21, 20, 5, 2 };
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(multiTryPop(multi, 2, &out) == STACK_OK && out == expected[i]);
+    }
+    CHECK(multiTryPeek(multi, 2, &out) == STACK_EMPTY);
+    free(multi);
+}
+
+int main(void)
+{
+    testTwinStack();
+    testMultiStack();
+    return testResult("test_arena");
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_array.c
+ *
+ * @brief Push, pop, growth and shrinking of the array stack, and the list backends' basic contract.
+ */
+
+#include <limits.h>
+
+#include "stack.h"
+#include "test_util.h"
+
+static void testFixedCapacity(void)
+{
+    struct Stack *stack = initializeStack(3);
+    CHECK(stack != NULL && isEmpty(stack));
+    for (int i = 1; i <= 3; i++)
+    {
+        CHECK(push(stack, i) == STACK_OK);
+    }
+    CHECK(isFull(stack));
+    CHECK(push(stack, 4) == STACK_FULL);
+    CHECK(stackSize(stack) == 3 && stack->capacity == 3);
+
+    int out = 0;
+    CHECK(tryPeek(stack, &out) == STACK_OK && out == 3);
+    CHECK(pop(stack) == 3 && pop(stack) == 2 && peek(stack) == 1);
+    CHECK(tryPop(stack, &out) == STACK_OK && out == 1);
+    out = 42;
+    CHECK(tryPop(stack, &out) == STACK_EMPTY && out == 42);
+    CHECK(tryPeek(stack, &out) == STACK_EMPTY && out == 42);
+    CHECK(pop(stack) == INT_MIN && peek(stack) == INT_MIN);
+    freeStack(stack);
+}
+
+static void testGrowAndShrink(void)
+{
+    struct Stack *stack = initializeGrowableStack(4, 2.0, 1);
+    CHECK(stack != NULL);
+    for (int i = 0; i < 1000; i++)
+    {
+        CHECK(push(stack, i) == STACK_OK);
+    }
+    CHECK(stackSize(stack) == 1000 && stack->capacity >= 1000);
+    unsigned grown = stack->capacity;
+
+    for (int i = 999; i >= 100; i--)
+    {
+        CHECK(pop(stack) == i);
+    }
+    CHECK(stack->capacity < grown && stack->capacity >= stackSize(stack));
+    while (!isEmpty(stack))
+    {
+        popUnchecked(stack);
+    }
+    CHECK(stack->capacity == 4); // Never below the initial capacity
+    freeStack(stack);
+}
+
+static void testReserveAndShrinkToFit(void)
+{
+    struct Stack stack;
+    CHECK(initStack(&stack, 2, 1.0, 0) == STACK_OK);
+    CHECK(reserveStack(&stack, 100) == STACK_OK && stack.capacity == 100);
+    CHECK(reserveStack(&stack, 10) == STACK_OK && stack.capacity == 100);
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(push(&stack, i) == STACK_OK);
+    }
+    shrinkToFit(&stack);
+    CHECK(stack.capacity == 10 && peekUnchecked(&stack) == 9);
+    destroyStack(&stack);
+}
+
+static void testBulkAndReverse(void)
+{
+    struct Stack stack;
+    CHECK(initStack(&stack, 4, 2.0, 0) == STACK_OK);
+    reverseStack(&stack); // Empty: nothing to do
+    int items[20], out[20];
+    for (int i = 0; i < 20; i++)
+    {
+        items[i] = i * 10;
+    }
+    CHECK(pushN(&stack, items, 20) == 20);
+    CHECK(peekN(&stack, out, 3) == 3 && out[0] == 190 && out[2] == 170);
+
+    reverseStack(&stack);
+    CHECK(peekUnchecked(&stack) == 0);
+    CHECK(popN(&stack, out, 25) == 20);
+    for (int i = 0; i < 20; i++)
+    {
+        CHECK(out[i] == i * 10);
+    }
+    CHECK(popN(&stack, out, 5) == 0);
+
+    push(&stack, 7);
+    reverseStack(&stack); // One element: nothing to do
+    CHECK(peekUnchecked(&stack) == 7);
+    destroyStack(&stack);
+    reverseStack(&stack); // Destroyed: must not form a pointer before the array
+}
+
+static void testListBackends(void)
+{
+    Node *top = NULL;
+    UnrolledStack unrolled = { 0 };
+    for (int i = 0; i < 5000; i++)
+    {
+        CHECK(listPush(&top, i) == STACK_OK);
+        CHECK(unrolledPush(&unrolled, i) == STACK_OK);
+    }
+    CHECK(listSize(top) == 5000 && unrolledSize(&unrolled) == 5000);
+    listReverse(&top);
+    unrolledReverse(&unrolled);
+    for (int i = 0; i < 5000; i++)
+    {
+        int a = -1, b = -1;
+        CHECK(listTryPop(&top, &a) == STACK_OK && a == i);
+        CHECK(unrolledTryPop(&unrolled, &b) == STACK_OK && b == i);
+    }
+    int out;
+    CHECK(listTryPop(&top, &out) == STACK_EMPTY && listPop(&top) == INT_MIN);
+    CHECK(unrolledTryPop(&unrolled, &out) == STACK_EMPTY && unrolledPop(&unrolled) == INT_MIN);
+    unrolledClear(&unrolled);
+}
+
+int main(void)
+{
+    testFixedCapacity();
+    testGrowAndShrink();
+    testReserveAndShrinkToFit();
+    testBulkAndReverse();
+    testListBackends();
+    return testResult("test_array");
+}
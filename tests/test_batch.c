@@ -0,0 +1,581 @@
+/**
+ * @file test_batch.c
+ *
+ * @brief Text and binary command streams, well-formed, malformed and truncated, and
+ *        their results and error reports.
+ *
+ * The streams run against a small executor with the drivers' semantics over
+ * STACKS fixed-capacity stacks, with standard output and standard error
+ * captured. Paths to driver programs given on the command line also replay a
+ * script in batch mode, to check that the drivers agree on the results.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "stack_batch.h"
+#include "stack_dump.h"
+#include "test_util.h"
+
+#define STACKS 3                   /**< Stacks of the executor, numbered from 1 */
+#define CAPACITY 4                 /**< Capacity of each stack, so a fifth push is rejected */
+#define LONG_ITEMS 200000          /**< Pushes of the long streams, enough to refill both buffers often */
+#define SCRIPT "test_batch.script" /**< Script the driver programs replay */
+
+/**
+ * @struct executor
+ * @brief The stacks a stream runs against.
+ */
+typedef struct executor
+{
+    struct Stack stacks[STACKS]; /**< The stacks */
+    unsigned current;            /**< Number of the selected stack */
+} Executor;
+
+/**
+ * @struct outcome
+ * @brief What a run printed, and how it ended.
+ */
+typedef struct outcome
+{
+    char *out;     /**< Standard output, NUL-terminated */
+    size_t length; /**< Bytes of `out` */
+    char *err;     /**< Standard error, NUL-terminated */
+    int exitCode;  /**< closeBatch()'s result */
+} Outcome;
+
+/**
+ * @brief Opens an empty temporary file whose name is already unlinked.
+ */
+static int tempFd(void)
+{
+    char path[] = "test_batch.XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+/**
+ * @brief Reads back everything written to a descriptor, NUL-terminated, and closes it.
+ */
+static char *readBack(int fd, size_t *length)
+{
+    off_t end = lseek(fd, 0, SEEK_END);
+    char *bytes = malloc(end > 0 ? (size_t)end + 1 : 1);
+    CHECK(end >= 0 && bytes != NULL && pread(fd, bytes, (size_t)end, 0) == end);
+    bytes[end > 0 ? end : 0] = '\0';
+    if (length != NULL)
+    {
+        *length = end > 0 ? (size_t)end : 0;
+    }
+    close(fd);
+    return bytes;
+}
+
+/**
+ * @brief Writes a whole buffer to a file.
+ */
+static void writeFile(const char *path, const void *bytes, size_t length)
+{
+    FILE *file = fopen(path, "wb");
+    CHECK(file != NULL);
+    if (file != NULL)
+    {
+        CHECK(fwrite(bytes, 1, length, file) == length);
+        fclose(file);
+    }
+}
+
+static void initExecutor(Executor *executor, unsigned capacity, double growthFactor)
+{
+    for (int i = 0; i < STACKS; i++)
+    {
+        CHECK(initStack(&executor->stacks[i], capacity, growthFactor, 0) == STACK_OK);
+    }
+    executor->current = 1;
+}
+
+static void destroyExecutor(Executor *executor)
+{
+    for (int i = 0; i < STACKS; i++)
+    {
+        destroyStack(&executor->stacks[i]);
+    }
+}
+
+/**
+ * @brief Runs the commands of an open stream the way the drivers do.
+ * @return The status that ended the stream.
+ */
+static StackStatus execute(BatchRun *run, Executor *executor)
+{
+    BatchCommand command;
+    StackStatus status;
+    int item;
+    while ((status = nextBatchCommand(run, &command)) == STACK_OK && command.op != BATCH_EXIT)
+    {
+        struct Stack *stack = &executor->stacks[executor->current - 1];
+        switch (command.op)
+        {
+        case BATCH_PUSH:
+            if (push(stack, command.value) != STACK_OK)
+            {
+                batchPrintText(run, "full\n");
+            }
+            break;
+        case BATCH_POP:
+        case BATCH_PEEK:
+            if ((command.op == BATCH_POP ? tryPop(stack, &item) : tryPeek(stack, &item)) == STACK_OK)
+            {
+                batchPrintInt(run, item);
+            }
+            else
+            {
+                batchPrintText(run, "empty\n");
+            }
+            break;
+        case BATCH_DISPLAY:
+            flushBatch(run);
+            dumpStack(stack, NULL);
+            break;
+        case BATCH_SWITCH:
+            if (command.value == 0)
+            {
+                executor->current = executor->current % STACKS + 1;
+            }
+            else if (command.value <= STACKS)
+            {
+                executor->current = (unsigned)command.value;
+            }
+            else
+            {
+                batchPrintText(run, "nostack\n");
+            }
+            break;
+        case BATCH_REVERSE:
+            reverseStack(stack);
+            break;
+        default:
+            break;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Runs a stream from a file, or from standard input, capturing what it prints.
+ * @param bytes The stream.
+ * @param length Bytes of the stream.
+ * @param fromStdin Non-zero to feed the stream through a pipe on standard input.
+ * @param executor The stacks to run it against.
+ * @param outcome Receives the output and the exit code; free its strings.
+ */
+static void runStream(const void *bytes, size_t length, int fromStdin, Executor *executor, Outcome *outcome)
+{
+    char path[] = "test_batch.XXXXXX";
+    int savedIn = -1;
+    if (fromStdin)
+    {
+        int fds[2];
+        CHECK(length < 4096 && pipe(fds) == 0); // Fits the pipe, so nothing blocks
+        CHECK(write(fds[1], bytes, length) == (ssize_t)length);
+        close(fds[1]);
+        savedIn = dup(STDIN_FILENO);
+        dup2(fds[0], STDIN_FILENO);
+        close(fds[0]);
+    }
+    else
+    {
+        int fd = mkstemp(path);
+        CHECK(fd >= 0);
+        close(fd);
+        writeFile(path, bytes, length);
+    }
+
+    fflush(stdout);
+    int out = tempFd(), err = tempFd();
+    int savedOut = dup(STDOUT_FILENO), savedErr = dup(STDERR_FILENO);
+    dup2(out, STDOUT_FILENO);
+    dup2(err, STDERR_FILENO);
+
+    BatchRun run;
+    StackStatus status = openBatch(&run, fromStdin ? NULL : path);
+    if (status == STACK_OK)
+    {
+        outcome->exitCode = closeBatch(&run, execute(&run, executor));
+    }
+    else
+    {
+        outcome->exitCode = -1;
+    }
+
+    fflush(stderr);
+    dup2(savedOut, STDOUT_FILENO);
+    dup2(savedErr, STDERR_FILENO);
+    close(savedOut);
+    close(savedErr);
+    if (fromStdin)
+    {
+        dup2(savedIn, STDIN_FILENO);
+        close(savedIn);
+    }
+    else
+    {
+        unlink(path);
+    }
+    CHECK(status == STACK_OK);
+    outcome->out = readBack(out, &outcome->length);
+    outcome->err = readBack(err, NULL);
+}
+
+static void freeOutcome(Outcome *outcome)
+{
+    free(outcome->out);
+    free(outcome->err);
+}
+
+/**
+ * @brief Returns 1 if a stack holds exactly `items`, bottom first.
+ */
+static int holds(struct Stack *stack, const int *items, unsigned count)
+{
+    return stackSize(stack) == count && (count == 0 || memcmp(stack->array, items, count * sizeof(int)) == 0);
+}
+
+/**
+ * @brief Returns 1 if `text` starts with `prefix`.
+ */
+static int startsWith(const char *text, const char *prefix)
+{
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+/**
+ * @struct encoder
+ * @brief A binary stream under construction.
+ */
+typedef struct encoder
+{
+    unsigned char *bytes; /**< The stream */
+    size_t length;        /**< Bytes in use */
+} Encoder;
+
+/**
+ * @brief Appends a command to a binary stream; `value` is written for push and switch.
+ */
+static void encode(Encoder *encoder, BatchOp op, int value)
+{
+    unsigned char *p = encoder->bytes + encoder->length;
+    *p++ = (unsigned char)op;
+    if (op == BATCH_PUSH || op == BATCH_SWITCH)
+    {
+        unsigned u = (unsigned)value;
+        *p++ = (unsigned char)u;
+        *p++ = (unsigned char)(u >> 8);
+        *p++ = (unsigned char)(u >> 16);
+        *p++ = (unsigned char)(u >> 24);
+    }
+    encoder->length = (size_t)(p - encoder->bytes);
+}
+
+/**
+ * @brief A script touching every command, operand form and result, in text.
+ */
+static const char script[] =
+    "# Blank lines and comments are skipped\n"
+    "\n"
+    "push 1\n"
+    "1 2\n"
+    "  push\t-2147483648   \n"
+    "push 2147483647\r\n"
+    "peek\n"
+    "push 5\n"
+    "pop\n"
+    "display\n"
+    "switch\n"
+    "pop\n"
+    "5 3\n"
+    "push +7\n"
+    "3\n"
+    "switch 4\n"
+    "switch 0\n"
+    "reverse\n"
+    "pop\n"
+    "7\n"
+    "push 99\n";
+
+/**
+ * @brief What the script prints: a full push, a display, an empty pop and a missing stack.
+ */
+static const char scriptOutput[] = "2147483647\nfull\n2147483647\n-2147483648\n2\n1\nempty\n7\nnostack\n1\n";
+
+/**
+ * @brief Checks the stacks and the report left by the script, however it was encoded.
+ */
+static void checkScriptRun(Executor *executor, Outcome *outcome)
+{
+    static const int first[] = { INT_MIN, 2 }, third[] = { 7 };
+    CHECK(outcome->exitCode == 0);
+    CHECK(strcmp(outcome->out, scriptOutput) == 0);
+    CHECK(startsWith(outcome->err, "18 commands in "));
+    CHECK(holds(&executor->stacks[0], first, 2));
+    CHECK(holds(&executor->stacks[1], NULL, 0));
+    CHECK(holds(&executor->stacks[2], third, 1));
+}
+
+static void testTextStream(void)
+{
+    Executor executor;
+    Outcome outcome;
+    for (int fromStdin = 0; fromStdin <= 1; fromStdin++)
+    {
+        initExecutor(&executor, CAPACITY, 1.0);
+        runStream(script, sizeof(script) - 1, fromStdin, &executor, &outcome);
+        checkScriptRun(&executor, &outcome);
+        freeOutcome(&outcome);
+        destroyExecutor(&executor);
+    }
+}
+
+static void testBinaryStream(void)
+{
+    unsigned char bytes[256];
+    Encoder encoder = { bytes, 0 };
+    memcpy(bytes, BATCH_MAGIC, 4);
+    encoder.length = 4;
+    encode(&encoder, BATCH_PUSH, 1);
+    encode(&encoder, BATCH_PUSH, 2);
+    encode(&encoder, BATCH_PUSH, INT_MIN);
+    encode(&encoder, BATCH_PUSH, INT_MAX);
+    encode(&encoder, BATCH_PEEK, 0);
+    encode(&encoder, BATCH_PUSH, 5);
+    encode(&encoder, BATCH_POP, 0);
+    encode(&encoder, BATCH_DISPLAY, 0);
+    encode(&encoder, BATCH_SWITCH, 0);
+    encode(&encoder, BATCH_POP, 0);
+    encode(&encoder, BATCH_SWITCH, 3);
+    encode(&encoder, BATCH_PUSH, 7);
+    encode(&encoder, BATCH_PEEK, 0);
+    encode(&encoder, BATCH_SWITCH, 4);
+    encode(&encoder, BATCH_SWITCH, 0);
+    encode(&encoder, BATCH_REVERSE, 0);
+    encode(&encoder, BATCH_POP, 0);
+    encode(&encoder, BATCH_EXIT, 0);
+    encode(&encoder, BATCH_PUSH, 99);
+
+    Executor executor;
+    Outcome outcome;
+    initExecutor(&executor, CAPACITY, 1.0);
+    runStream(bytes, encoder.length, 0, &executor, &outcome);
+    checkScriptRun(&executor, &outcome);
+    freeOutcome(&outcome);
+    destroyExecutor(&executor);
+}
+
+static void testMalformedText(void)
+{
+    static const char *const lines[] = {
+        "push", "push x", "push 2147483648", "push -2147483649", "push +2147483648", "push 12abc",
+        "push 1 2", "push --1", "pop 1", "peek x", "jump", "pushpop", "-1", "0", "8", "99999999999",
+        "switch -1", "5 -1", "switch 1 2", "switch x",
+    };
+    static const int kept[] = { 1, 2 };
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        char text[64];
+        int length = snprintf(text, sizeof(text), "push 1\n# two good lines\npush 2\n%s\npush 3\n", lines[i]);
+        Executor executor;
+        Outcome outcome;
+        initExecutor(&executor, CAPACITY, 1.0);
+        runStream(text, (size_t)length, 0, &executor, &outcome);
+        CHECK(outcome.exitCode == 1);
+        CHECK(outcome.length == 0);
+        CHECK(startsWith(outcome.err, "Malformed command on line 4\n2 commands in "));
+        CHECK(holds(&executor.stacks[0], kept, 2)); // Nothing after the bad line ran
+        freeOutcome(&outcome);
+        destroyExecutor(&executor);
+    }
+}
+
+static void testMalformedBinary(void)
+{
+    static const unsigned char tails[][5] = {
+        { 0 },                                    // Below the first op
+        { BATCH_EXIT + 1 },                       // Past the last op
+        { 0xFF },
+        { BATCH_SWITCH, 0xFF, 0xFF, 0xFF, 0xFF }, // Stack -1
+        { BATCH_PUSH, 1, 2 },                     // Operand cut off by the end of the stream
+        { BATCH_SWITCH },
+    };
+    static const size_t tailLengths[] = { 1, 1, 1, 5, 3, 1 };
+    static const size_t complete = 4; // Tails before this one are whole commands
+    static const int kept[] = { 1, 2 };
+    for (size_t i = 0; i < sizeof(tailLengths) / sizeof(tailLengths[0]); i++)
+    {
+        unsigned char bytes[32];
+        Encoder encoder = { bytes, 4 };
+        memcpy(bytes, BATCH_MAGIC, 4);
+        encode(&encoder, BATCH_PUSH, 1);
+        encode(&encoder, BATCH_PUSH, 2);
+        memcpy(bytes + encoder.length, tails[i], tailLengths[i]);
+        encoder.length += tailLengths[i];
+        if (i < complete)
+        {
+            encode(&encoder, BATCH_PUSH, 3); // Would run if the bad command were skipped
+        }
+
+        Executor executor;
+        Outcome outcome;
+        initExecutor(&executor, CAPACITY, 1.0);
+        runStream(bytes, encoder.length, 0, &executor, &outcome);
+        CHECK(outcome.exitCode == 1);
+        CHECK(startsWith(outcome.err, "Malformed command after 2 commands\n"));
+        CHECK(holds(&executor.stacks[0], kept, 2));
+        freeOutcome(&outcome);
+        destroyExecutor(&executor);
+    }
+}
+
+static void testShortStreams(void)
+{
+    Executor executor;
+    Outcome outcome;
+
+    // Nothing at all, and a bare binary header, are empty runs
+    static const char *const empty[] = { "", BATCH_MAGIC, "\n\n# nothing\n" };
+    for (int i = 0; i < 3; i++)
+    {
+        initExecutor(&executor, CAPACITY, 1.0);
+        runStream(empty[i], strlen(empty[i]), 0, &executor, &outcome);
+        CHECK(outcome.exitCode == 0 && outcome.length == 0);
+        CHECK(startsWith(outcome.err, "0 commands in "));
+        freeOutcome(&outcome);
+        destroyExecutor(&executor);
+    }
+
+    // Shorter than the magic number: read as text
+    initExecutor(&executor, CAPACITY, 1.0);
+    runStream("STK", 3, 0, &executor, &outcome);
+    CHECK(outcome.exitCode == 1 && startsWith(outcome.err, "Malformed command on line 1\n"));
+    freeOutcome(&outcome);
+    destroyExecutor(&executor);
+
+    // A last line without its newline still runs
+    initExecutor(&executor, CAPACITY, 1.0);
+    runStream("push 4\npeek", 11, 0, &executor, &outcome);
+    CHECK(outcome.exitCode == 0 && strcmp(outcome.out, "4\n") == 0);
+    freeOutcome(&outcome);
+    destroyExecutor(&executor);
+
+    // A line longer than the input buffer is rejected, at its own line number
+    size_t length = BATCH_BUFFER_BYTES + 100;
+    char *text = malloc(length);
+    CHECK(text != NULL);
+    memcpy(text, "pop\n#", 5);
+    memset(text + 5, 'x', length - 6);
+    text[length - 1] = '\n';
+    initExecutor(&executor, CAPACITY, 1.0);
+    runStream(text, length, 0, &executor, &outcome);
+    CHECK(outcome.exitCode == 1 && strcmp(outcome.out, "empty\n") == 0);
+    CHECK(startsWith(outcome.err, "Malformed command on line 2\n"));
+    freeOutcome(&outcome);
+    destroyExecutor(&executor);
+    free(text);
+}
+
+static void testLongStreams(void)
+{
+    // LONG_ITEMS pushes then as many pops, so both buffers are refilled and flushed many times
+    char *text = malloc((size_t)LONG_ITEMS * 20);
+    unsigned char *bytes = malloc((size_t)LONG_ITEMS * 6 + 4);
+    char *expected = malloc((size_t)LONG_ITEMS * 12 + 1);
+    CHECK(text != NULL && bytes != NULL && expected != NULL);
+    size_t textLength = 0, expectedLength = 0;
+    Encoder encoder = { bytes, 4 };
+    memcpy(bytes, BATCH_MAGIC, 4);
+    for (int i = 0; i < LONG_ITEMS; i++)
+    {
+        int value = i % 2 ? -i : i * 1000;
+        textLength += (size_t)sprintf(text + textLength, "push %d\n", value);
+        encode(&encoder, BATCH_PUSH, value);
+    }
+    for (int i = LONG_ITEMS - 1; i >= 0; i--)
+    {
+        memcpy(text + textLength, "pop\n", 4);
+        textLength += 4;
+        encode(&encoder, BATCH_POP, 0);
+        expectedLength += (size_t)sprintf(expected + expectedLength, "%d\n", i % 2 ? -i : i * 1000);
+    }
+
+    for (int binary = 0; binary <= 1; binary++)
+    {
+        Executor executor;
+        Outcome outcome;
+        initExecutor(&executor, CAPACITY, 2.0);
+        runStream(binary ? (void *)bytes : (void *)text, binary ? encoder.length : textLength, 0, &executor,
+                  &outcome);
+        CHECK(outcome.exitCode == 0);
+        CHECK(outcome.length == expectedLength && memcmp(outcome.out, expected, expectedLength) == 0);
+        CHECK(startsWith(outcome.err, "400000 commands in "));
+        CHECK(isEmpty(&executor.stacks[0]));
+        freeOutcome(&outcome);
+        destroyExecutor(&executor);
+    }
+    free(expected);
+    free(bytes);
+    free(text);
+}
+
+/**
+ * @brief Replays one script through each driver program named on the command line.
+ * @details Every driver starts with two stacks, creates the next one on demand and
+ *          refuses a ninth, so they all print the same results, and stop with status 1
+ *          at the bad command.
+ */
+static void testDrivers(int argc, char *argv[])
+{
+    static const char driverScript[] =
+        "push 1\npush 2\nswitch\npush 3\npop\nswitch 0\npop\nswitch 9\nswitch 3\npush 5\nswitch 0\nswitch 3\npop\n"
+        "switch 1\ndisplay\nreverse\npeek\nbogus\npush 4\n";
+    writeFile(SCRIPT, driverScript, sizeof(driverScript) - 1);
+    for (int i = 1; i < argc; i++)
+    {
+        char command[4096];
+        snprintf(command, sizeof(command), "'%s' -b " SCRIPT " 2>/dev/null", argv[i]);
+        FILE *driver = popen(command, "r");
+        CHECK(driver != NULL);
+        if (driver == NULL)
+        {
+            continue;
+        }
+        char out[256];
+        size_t length = fread(out, 1, sizeof(out) - 1, driver);
+        out[length] = '\0';
+        int status = pclose(driver);
+        if (strcmp(out, "3\n2\nnostack\n5\n1\n1\n") != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 1)
+        {
+            fprintf(stderr, "%s printed \"%s\" and exited with %d\n", argv[i], out, status);
+            testFailures++;
+        }
+    }
+    unlink(SCRIPT);
+}
+
+int main(int argc, char *argv[])
+{
+    testTextStream();
+    testBinaryStream();
+    testMalformedText();
+    testMalformedBinary();
+    testShortStreams();
+    testLongStreams();
+    testDrivers(argc, argv);
+    return testResult("test_batch");
+}
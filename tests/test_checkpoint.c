@@ -0,0 +1,118 @@
+/**
+ * @file test_checkpoint.c
+ *
+ * @brief Random pushes, pops, marks, rollbacks and commits checked against saved copies of the stack.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stack_checkpoint.h"
+#include "test_util.h"
+
+#define MAX_ITEMS 4000 /**< Deepest stack */
+#define MAX_MARKS 200 /**< Deepest nesting of checkpoints */
+#define STEPS 2000000 /**< Random operations */
+
+/**
+ * @struct snapshot
+ * @brief A copy of the expected stack contents.
+ */
+typedef struct snapshot
+{
+    int items[MAX_ITEMS]; /**< Elements, bottom first */
+    unsigned size;        /**< Elements in use */
+} Snapshot;
+
+static Snapshot expected;         /**< What the stack should hold now */
+static Snapshot saved[MAX_MARKS]; /**< What it held at each active checkpoint */
+
+static void testNoCheckpoint(void)
+{
+    CheckpointStack stack;
+    CHECK(initCheckpointStack(&stack, 4, 2.0) == STACK_OK);
+    CHECK(checkpointRollback(&stack, 0) == STACK_EMPTY);
+    CHECK(checkpointCommit(&stack) == STACK_EMPTY);
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(checkpointPush(&stack, i) == STACK_OK);
+    }
+    CHECK(stack.logCount == 0); // Nothing to undo, nothing logged
+    destroyCheckpointStack(&stack);
+}
+
+static void testRandomized(void)
+{
+    CheckpointStack stack;
+    CHECK(initCheckpointStack(&stack, 4, 2.0) == STACK_OK);
+    unsigned marks = 0;
+    int failed = 0;
+    srand(7);
+    for (long step = 0; step < STEPS && !failed; step++)
+    {
+        int r = rand() % 1000;
+        int out;
+        if (r < 480 && expected.size < MAX_ITEMS)
+        {
+            expected.items[expected.size] = rand();
+            failed |= checkpointPush(&stack, expected.items[expected.size++]) != STACK_OK;
+        }
+        else if (r < 960)
+        {
+            StackStatus status = checkpointTryPop(&stack, &out);
+            failed |= expected.size == 0 ? status != STACK_EMPTY
+                                         : status != STACK_OK || out != expected.items[--expected.size];
+        }
+        else if (r < 975 && marks < MAX_MARKS)
+        {
+            unsigned mark;
+            failed |= checkpointMark(&stack, &mark) != STACK_OK || mark != marks;
+            memcpy(&saved[marks++], &expected, sizeof(expected));
+        }
+        else if (r < 990)
+        {
+            if (marks == 0)
+            {
+                failed |= checkpointRollback(&stack, 0) != STACK_EMPTY;
+                continue;
+            }
+            unsigned mark = (unsigned)rand() % marks; // Often an outer one, dropping those inside it
+            failed |= checkpointRollback(&stack, mark) != STACK_OK;
+            memcpy(&expected, &saved[mark], sizeof(expected));
+            marks = mark + 1;
+        }
+        else
+        {
+            failed |= checkpointCommit(&stack) != (marks ? STACK_OK : STACK_EMPTY);
+            marks -= marks > 0;
+        }
+
+        failed |= checkpointSize(&stack) != expected.size;
+        if (step % 1000 == 0)
+        {
+            failed |= memcmp(stack.items.array, expected.items, expected.size * sizeof(int)) != 0;
+        }
+        if (failed)
+        {
+            fprintf(stderr, "test_checkpoint: mismatch at step %ld\n", step);
+        }
+    }
+    CHECK(!failed);
+
+    // Committing every checkpoint keeps the current contents and empties the log
+    while (marks > 0)
+    {
+        CHECK(checkpointCommit(&stack) == STACK_OK);
+        marks--;
+    }
+    CHECK(stack.logCount == 0 && checkpointSize(&stack) == expected.size);
+    CHECK(memcmp(stack.items.array, expected.items, expected.size * sizeof(int)) == 0);
+    destroyCheckpointStack(&stack);
+}
+
+int main(void)
+{
+    testNoCheckpoint();
+    testRandomized();
+    return testResult("test_checkpoint");
+}
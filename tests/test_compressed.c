@@ -0,0 +1,90 @@
+/**
+ * @file test_compressed.c
+ *
+ * @brief The compressed stack returns what was pushed across block boundaries, and packs runs.
+ */
+
+#include <stdlib.h>
+
+#include "stack_compressed.h"
+#include "test_util.h"
+
+#define ITEMS (5 * COMPRESSED_BLOCK_ITEMS + 17) /**< Several sealed blocks and a partial one */
+
+/**
+ * @brief Returns the i-th test value: a run of small deltas, a run of near-constant values, then noise.
+ */
+static int value(int i)
+{
+    if (i < 2 * COMPRESSED_BLOCK_ITEMS)
+    {
+        return 1000000 + i * 3;
+    }
+    if (i < 4 * COMPRESSED_BLOCK_ITEMS)
+    {
+        return 7 + (i & 3);
+    }
+    return (int)((unsigned)rand() << 16 ^ (unsigned)rand());
+}
+
+static void testRoundTrip(void)
+{
+    CompressedStack stack;
+    CHECK(initCompressedStack(&stack) == STACK_OK);
+    int *reference = malloc(ITEMS * sizeof(int));
+    srand(3);
+    for (int i = 0; i < ITEMS; i++)
+    {
+        reference[i] = value(i);
+        CHECK(compressedPush(&stack, reference[i]) == STACK_OK);
+    }
+    CHECK(compressedSize(&stack) == ITEMS);
+    CHECK(compressedBytes(&stack) < (size_t)ITEMS * sizeof(int)); // The regular runs pack
+
+    // Pop into the sealed blocks and push back, twice, to cross the boundaries both ways
+    int out = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = ITEMS - 1; i >= ITEMS - 2 * COMPRESSED_BLOCK_ITEMS; i--)
+        {
+            CHECK(compressedTryPop(&stack, &out) == STACK_OK && out == reference[i]);
+        }
+        for (int i = ITEMS - 2 * COMPRESSED_BLOCK_ITEMS; i < ITEMS; i++)
+        {
+            CHECK(compressedPush(&stack, reference[i]) == STACK_OK);
+        }
+    }
+    CHECK(compressedTryPeek(&stack, &out) == STACK_OK && out == reference[ITEMS - 1]);
+    for (int i = ITEMS - 1; i >= 0; i--)
+    {
+        CHECK(compressedTryPop(&stack, &out) == STACK_OK && out == reference[i]);
+    }
+    out = 42;
+    CHECK(compressedTryPop(&stack, &out) == STACK_EMPTY && compressedTryPeek(&stack, &out) == STACK_EMPTY);
+    CHECK(out == 42 && compressedSize(&stack) == 0);
+    free(reference);
+    destroyCompressedStack(&stack);
+}
+
+static void testExtremes(void)
+{
+    CompressedStack stack;
+    CHECK(initCompressedStack(&stack) == STACK_OK);
+    for (int i = 0; i < 3 * COMPRESSED_BLOCK_ITEMS; i++)
+    {
+        CHECK(compressedPush(&stack, i % 2 ? INT32_MAX : INT32_MIN) == STACK_OK);
+    }
+    int out;
+    for (int i = 3 * COMPRESSED_BLOCK_ITEMS - 1; i >= 0; i--)
+    {
+        CHECK(compressedTryPop(&stack, &out) == STACK_OK && out == (i % 2 ? INT32_MAX : INT32_MIN));
+    }
+    destroyCompressedStack(&stack);
+}
+
+int main(void)
+{
+    testRoundTrip();
+    testExtremes();
+    return testResult("test_compressed");
+}
@@ -0,0 +1,223 @@
+/**
+ * @file test_concurrent.c
+ *
+ * @brief Stress runs of the lock-free, elimination and work-stealing stacks.
+ *
+ * Every item pushed must be popped exactly once, whichever thread gets it. The
+ * runs are short enough for every build, and meant to be run under the tsan
+ * preset as well.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "stack_lockfree.h"
+#include "stack_steal.h"
+#include "test_util.h"
+
+#define THREADS 4              /**< Threads per run */
+#define ITEMS_PER_THREAD 20000 /**< Items each thread pushes */
+#define ITEMS (THREADS * ITEMS_PER_THREAD) /**< Items pushed per run */
+
+static _Atomic unsigned char seen[ITEMS]; /**< Times each item was popped */
+
+/**
+ * @brief Records a popped item.
+ */
+static void see(int item)
+{
+    CHECK(item >= 0 && item < ITEMS);
+    if (item >= 0 && item < ITEMS)
+    {
+        atomic_fetch_add(&seen[item], 1);
+    }
+}
+
+/**
+ * @brief Checks that every item was popped exactly once, and clears the record.
+ */
+static void checkSeenOnce(const char *run)
+{
+    int missing = 0, repeated = 0;
+    for (int i = 0; i < ITEMS; i++)
+    {
+        unsigned char times = atomic_exchange(&seen[i], 0);
+        missing += times == 0;
+        repeated += times > 1;
+    }
+    if (missing || repeated)
+    {
+        fprintf(stderr, "%s: %d missing, %d popped more than once\n", run, missing, repeated);
+    }
+    CHECK(missing == 0 && repeated == 0);
+}
+
+/* ---------------------------------------------------------------------------
+ * Lock-free and elimination stacks
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct worker
+ * @brief What one thread of a run works on.
+ */
+typedef struct worker
+{
+    LockFreeStack *lockFree;       /**< The stack, or NULL to use `elimination` */
+    EliminationStack *elimination; /**< The stack when `lockFree` is NULL */
+    int first;                     /**< First of the items this thread pushes */
+} Worker;
+
+static StackStatus workerPush(Worker *worker, int item)
+{
+    return worker->lockFree ? lockFreePush(worker->lockFree, item) : eliminationPush(worker->elimination, item);
+}
+
+static StackStatus workerPop(Worker *worker, int *out)
+{
+    return worker->lockFree ? lockFreeTryPop(worker->lockFree, out) : eliminationTryPop(worker->elimination, out);
+}
+
+/**
+ * @brief Pushes the thread's items two at a time, popping one after each pair.
+ */
+static void *pushPop(void *arg)
+{
+    Worker *worker = arg;
+    for (int i = 0; i < ITEMS_PER_THREAD; i++)
+    {
+        CHECK(workerPush(worker, worker->first + i) == STACK_OK);
+        int out;
+        if (i % 2 && workerPop(worker, &out) == STACK_OK)
+        {
+            see(out);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs pushPop() on every thread, then drains the stack from this one.
+ */
+static void runPushPop(Worker workers[THREADS], const char *run)
+{
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++)
+    {
+        workers[t].first = t * ITEMS_PER_THREAD;
+        CHECK(pthread_create(&threads[t], NULL, pushPop, &workers[t]) == 0);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    int out;
+    while (workerPop(&workers[0], &out) == STACK_OK)
+    {
+        see(out);
+    }
+    checkSeenOnce(run);
+}
+
+static void testLockFree(void)
+{
+    LockFreeStack *stack = aligned_alloc(LOCKFREE_CACHE_LINE, sizeof(LockFreeStack));
+    CHECK(stack != NULL && initLockFreeStack(stack) == STACK_OK);
+    Worker workers[THREADS];
+    for (int t = 0; t < THREADS; t++)
+    {
+        workers[t] = (Worker){ .lockFree = stack };
+    }
+    runPushPop(workers, "lock-free");
+    CHECK(lockFreeIsEmpty(stack));
+    destroyLockFreeStack(stack);
+    free(stack);
+}
+
+static void testElimination(void)
+{
+    EliminationStack *stack = aligned_alloc(LOCKFREE_CACHE_LINE, sizeof(EliminationStack));
+    CHECK(stack != NULL);
+    CHECK(initEliminationStack(stack, ELIMINATION_DEFAULT_WIDTH, ELIMINATION_DEFAULT_SPINS) == STACK_OK);
+    Worker workers[THREADS];
+    for (int t = 0; t < THREADS; t++)
+    {
+        workers[t] = (Worker){ .elimination = stack };
+    }
+    runPushPop(workers, "elimination");
+    destroyEliminationStack(stack);
+    free(stack);
+}
+
+/* ---------------------------------------------------------------------------
+ * Work stealing
+ * ------------------------------------------------------------------------- */
+
+static StealPool pool;           /**< The pool of the stealing run */
+static atomic_int producersLeft;   /**< Workers still pushing */
+
+/**
+ * @brief Pushes the worker's items, popping some of them back, then pops and steals until all work is gone.
+ */
+static void *pushAndSteal(void *arg)
+{
+    unsigned worker = (unsigned)(uintptr_t)arg;
+    int first = (int)worker * ITEMS_PER_THREAD;
+    int out;
+    for (int i = 0; i < ITEMS_PER_THREAD; i++)
+    {
+        CHECK(stealPoolPush(&pool, worker, first + i) == STACK_OK);
+        if (i % 3 == 0 && stealPoolPop(&pool, worker, &out) == STACK_OK)
+        {
+            see(out);
+        }
+    }
+    atomic_fetch_sub(&producersLeft, 1);
+    for (;;)
+    {
+        int left = atomic_load(&producersLeft); // Read before popping, so an empty pool then means no more work
+        if (stealPoolPop(&pool, worker, &out) == STACK_OK)
+        {
+            see(out);
+        }
+        else if (left == 0)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void testStealPool(void)
+{
+    CHECK(initStealPool(&pool, THREADS, 64) == STACK_OK); // Small, so the deques grow under the thieves
+    atomic_store(&producersLeft, THREADS);
+    pthread_t threads[THREADS];
+    for (unsigned t = 0; t < THREADS; t++)
+    {
+        CHECK(pthread_create(&threads[t], NULL, pushAndSteal, (void *)(uintptr_t)t) == 0);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    int out;
+    for (unsigned t = 0; t < THREADS; t++)
+    {
+        while (workDequeSteal(&pool.deques[t], &out) == STACK_OK) // A lost race may leave items behind
+        {
+            see(out);
+        }
+    }
+    checkSeenOnce("steal");
+    destroyStealPool(&pool);
+}
+
+int main(void)
+{
+    testLockFree();
+    testElimination();
+    testStealPool();
+    return testResult("test_concurrent");
+}
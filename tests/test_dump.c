@@ -0,0 +1,334 @@
+/**
+ * @file test_dump.c
+ *
+ * @brief The dumps' digit-pair formatter and every dump layout, byte for byte against snprintf().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stack_dump.h"
+#include "test_util.h"
+
+#define PATH "test_dump.out" /**< File written by the file-output case */
+#define BIG_ITEMS 300000      /**< Enough INT_MIN elements to fill the output buffer several times */
+
+/**
+ * @brief Values around every change in the number of digits, and the ends of the int range.
+ */
+static const int boundaries[] = {
+    0, 1, -1, 9, -9, 10, -10, 99, -99, 100, -100, 101, 999, 1000, 9999, 10000, 99999, 100000,
+    999999, 1000000, 9999999, 10000000, 99999999, 100000000, 999999999, 1000000000, -999999999,
+    -1000000000, 123456789, -123456789, INT_MAX, INT_MAX - 1, INT_MIN, INT_MIN + 1,
+};
+
+#define BOUNDARIES (sizeof(boundaries) / sizeof(boundaries[0]))
+
+/**
+ * @struct text
+ * @brief A growable string the expected output is built in.
+ */
+typedef struct text
+{
+    char *bytes;     /**< The characters, not terminated */
+    size_t length;   /**< Characters in use */
+    size_t capacity; /**< Characters allocated */
+} Text;
+
+/**
+ * @brief Appends printf-formatted text.
+ */
+static void appendf(Text *text, const char *format, ...)
+{
+    char piece[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(piece, sizeof(piece), format, args);
+    va_end(args);
+    if (text->length + (size_t)length > text->capacity)
+    {
+        text->capacity = (text->length + (size_t)length) * 2;
+        text->bytes = realloc(text->bytes, text->capacity);
+    }
+    memcpy(text->bytes + text->length, piece, (size_t)length);
+    text->length += (size_t)length;
+}
+
+/**
+ * @brief Builds with snprintf() what a dump of `items`, top first, should write.
+ * @param items The elements, top of the stack first.
+ * @param size The number of elements on the stack.
+ * @param format The layout.
+ * @param limit The element cap, 0 for none.
+ * @param text Receives the expected output; must start empty.
+ */
+static void expectDump(const int *items, size_t size, DumpFormat format, size_t limit, Text *text)
+{
+    size_t shown = limit != 0 && limit < size ? limit : size;
+    if (format == DUMP_CSV)
+    {
+        appendf(text, "position,value\n");
+    }
+    else if (format == DUMP_JSON)
+    {
+        appendf(text, "{\"size\":%zu,\"items\":[", size);
+    }
+    for (size_t i = 0; i < shown; i++)
+    {
+        if (format == DUMP_CSV)
+        {
+            appendf(text, "%zu,%d\n", i, items[i]);
+        }
+        else if (format == DUMP_JSON)
+        {
+            appendf(text, i ? ",%d" : "%d", items[i]);
+        }
+        else
+        {
+            appendf(text, "%d\n", items[i]);
+        }
+    }
+    if (format == DUMP_JSON)
+    {
+        appendf(text, "],\"truncated\":%s}\n", shown < size ? "true" : "false");
+    }
+    else if (format == DUMP_LINES && shown < size)
+    {
+        appendf(text, "... %zu more\n", size - shown);
+    }
+}
+
+/**
+ * @brief Opens an anonymous temporary file to dump into.
+ * @return The descriptor, positioned at the start of an empty file.
+ */
+static int tempFd(void)
+{
+    char path[] = "test_dump.XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+/**
+ * @brief Reads back everything written to a descriptor and closes it.
+ * @param fd The descriptor.
+ * @param length Receives the number of bytes read.
+ * @return The bytes, to free().
+ */
+static char *readBack(int fd, size_t *length)
+{
+    off_t end = lseek(fd, 0, SEEK_END);
+    char *bytes = malloc(end > 0 ? (size_t)end : 1);
+    *length = 0;
+    CHECK(end >= 0 && bytes != NULL && pread(fd, bytes, (size_t)end, 0) == end);
+    *length = end > 0 ? (size_t)end : 0;
+    close(fd);
+    return bytes;
+}
+
+/**
+ * @brief Returns 1 if a dump's output equals the expected text.
+ */
+static int sameBytes(const char *bytes, size_t length, const Text *expected)
+{
+    return length == expected->length && (length == 0 || memcmp(bytes, expected->bytes, length) == 0);
+}
+
+/**
+ * @brief Dumps an array stack holding `items` (top first) and checks the bytes written.
+ */
+static void checkArrayDump(struct Stack *stack, const int *items, DumpFormat format, size_t limit)
+{
+    Text expected = { NULL, 0, 0 };
+    expectDump(items, stackSize(stack), format, limit, &expected);
+    int fd = tempFd();
+    DumpOptions options = { format, limit, fd, NULL };
+    CHECK(dumpStack(stack, &options) == STACK_OK);
+    size_t length;
+    char *bytes = readBack(fd, &length);
+    CHECK(sameBytes(bytes, length, &expected));
+    free(bytes);
+    free(expected.bytes);
+}
+
+static void testFormatInt(void)
+{
+    char got[16], want[16];
+    for (size_t i = 0; i < BOUNDARIES; i++)
+    {
+        size_t length = dumpFormatInt(got, boundaries[i]);
+        CHECK(length == (size_t)snprintf(want, sizeof(want), "%d", boundaries[i]));
+        CHECK(memcmp(got, want, length) == 0);
+    }
+    int ok = 1;
+    for (int value = -100000; value <= 100000 && ok; value++)
+    {
+        size_t length = dumpFormatInt(got, value);
+        ok = length == (size_t)snprintf(want, sizeof(want), "%d", value) && memcmp(got, want, length) == 0;
+    }
+    CHECK(ok);
+}
+
+static void testFormats(void)
+{
+    struct Stack stack;
+    CHECK(initStack(&stack, 4, 2.0, 0) == STACK_OK);
+    int items[BOUNDARIES];
+    for (size_t i = 0; i < BOUNDARIES; i++)
+    {
+        CHECK(push(&stack, boundaries[i]) == STACK_OK);
+        items[BOUNDARIES - 1 - i] = boundaries[i]; // Top first
+    }
+
+    for (int format = DUMP_LINES; format <= DUMP_JSON; format++)
+    {
+        checkArrayDump(&stack, items, (DumpFormat)format, 0);
+        checkArrayDump(&stack, items, (DumpFormat)format, 5); // Truncated
+        checkArrayDump(&stack, items, (DumpFormat)format, 1);
+        checkArrayDump(&stack, items, (DumpFormat)format, BOUNDARIES); // Exactly all: not truncated
+        checkArrayDump(&stack, items, (DumpFormat)format, BOUNDARIES + 7);
+    }
+
+    // An empty stack still writes the CSV header and the JSON frame
+    struct Stack empty;
+    CHECK(initStack(&empty, 1, 2.0, 0) == STACK_OK);
+    for (int format = DUMP_LINES; format <= DUMP_JSON; format++)
+    {
+        checkArrayDump(&empty, NULL, (DumpFormat)format, 0);
+    }
+    destroyStack(&empty);
+    destroyStack(&stack);
+}
+
+static void testBackendsAgree(void)
+{
+    struct Stack stack;
+    Node *top = NULL;
+    UnrolledStack unrolled = { 0 };
+    CHECK(initStack(&stack, 4, 2.0, 0) == STACK_OK);
+    for (int i = 0; i < 1000; i++)
+    {
+        int value = i % 3 ? i * 7919 : -i;
+        CHECK(push(&stack, value) == STACK_OK);
+        CHECK(listPush(&top, value) == STACK_OK);
+        CHECK(unrolledPush(&unrolled, value) == STACK_OK);
+    }
+
+    for (int format = DUMP_LINES; format <= DUMP_JSON; format++)
+    {
+        size_t limits[] = { 0, 37 };
+        for (size_t l = 0; l < 2; l++)
+        {
+            int fds[3] = { tempFd(), tempFd(), tempFd() };
+            DumpOptions options[3] = {
+                { (DumpFormat)format, limits[l], fds[0], NULL },
+                { (DumpFormat)format, limits[l], fds[1], NULL },
+                { (DumpFormat)format, limits[l], fds[2], NULL },
+            };
+            CHECK(dumpStack(&stack, &options[0]) == STACK_OK);
+            CHECK(listDump(top, &options[1]) == STACK_OK);
+            CHECK(unrolledDump(&unrolled, &options[2]) == STACK_OK);
+            size_t lengths[3];
+            char *bytes[3];
+            for (int b = 0; b < 3; b++)
+            {
+                bytes[b] = readBack(fds[b], &lengths[b]);
+            }
+            CHECK(lengths[0] == lengths[1] && memcmp(bytes[0], bytes[1], lengths[0]) == 0);
+            CHECK(lengths[0] == lengths[2] && memcmp(bytes[0], bytes[2], lengths[0]) == 0);
+            for (int b = 0; b < 3; b++)
+            {
+                free(bytes[b]);
+            }
+        }
+    }
+
+    while (top != NULL)
+    {
+        listPopUnchecked(&top);
+    }
+    unrolledClear(&unrolled);
+    destroyStack(&stack);
+}
+
+static void testLargerThanBuffer(void)
+{
+    // Each element takes 12 bytes, so the dump crosses the buffer boundary several times
+    struct Stack stack;
+    CHECK(initStack(&stack, BIG_ITEMS, 1.0, 0) == STACK_OK);
+    int *items = malloc(BIG_ITEMS * sizeof(int));
+    CHECK(items != NULL);
+    for (int i = 0; i < BIG_ITEMS; i++)
+    {
+        CHECK(push(&stack, i % 2 ? INT_MIN : INT_MAX) == STACK_OK);
+        items[BIG_ITEMS - 1 - i] = i % 2 ? INT_MIN : INT_MAX;
+    }
+    for (int format = DUMP_LINES; format <= DUMP_JSON; format++)
+    {
+        checkArrayDump(&stack, items, (DumpFormat)format, 0);
+    }
+    free(items);
+    destroyStack(&stack);
+}
+
+static void testFileOutput(void)
+{
+    struct Stack stack;
+    CHECK(initStack(&stack, 4, 2.0, 0) == STACK_OK);
+    int items[10];
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(push(&stack, -i) == STACK_OK);
+        items[9 - i] = -i;
+    }
+
+    // The file is created, then truncated by the next dump
+    DumpOptions options = { DUMP_JSON, 0, -1, PATH };
+    CHECK(dumpStack(&stack, &options) == STACK_OK);
+    options.format = DUMP_CSV;
+    options.limit = 4;
+    CHECK(dumpStack(&stack, &options) == STACK_OK);
+
+    Text expected = { NULL, 0, 0 };
+    expectDump(items, 10, DUMP_CSV, 4, &expected);
+    FILE *file = fopen(PATH, "rb");
+    CHECK(file != NULL);
+    char bytes[256];
+    size_t length = file != NULL ? fread(bytes, 1, sizeof(bytes), file) : 0;
+    CHECK(sameBytes(bytes, length, &expected));
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    free(expected.bytes);
+    unlink(PATH);
+
+    // Unopenable files and unwritable descriptors are reported
+    options.path = "no-such-directory/" PATH;
+    CHECK(dumpStack(&stack, &options) == STACK_IO_ERROR);
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    options = (DumpOptions){ DUMP_LINES, 0, fds[0], NULL }; // The read end cannot be written
+    CHECK(dumpStack(&stack, &options) == STACK_IO_ERROR);
+    close(fds[0]);
+    close(fds[1]);
+    destroyStack(&stack);
+}
+
+int main(void)
+{
+    testFormatInt();
+    testFormats();
+    testBackendsAgree();
+    testLargerThanBuffer();
+    testFileOutput();
+    return testResult("test_dump");
+}
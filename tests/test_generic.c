@@ -0,0 +1,128 @@
+/**
+ * @file test_generic.c
+ *
+ * @brief DEFINE_STACK instantiated for integer, floating-point, struct and pointer element types.
+ */
+
+#include <stdint.h>
+
+#include "stack_generic.h"
+#include "test_util.h"
+
+/**
+ * @struct point
+ * @brief A small struct element with padding-free fields of two sizes.
+ */
+typedef struct point
+{
+    double x;  /**< Abscissa */
+    int32_t y; /**< Ordinate */
+    int32_t z; /**< Height */
+} Point;
+
+DEFINE_STACK(IdStack, uint64_t)
+DEFINE_STACK(RealStack, double)
+DEFINE_STACK(PointStack, Point)
+DEFINE_STACK(NameStack, char *)
+
+static void testIds(void)
+{
+    IdStack ids = { 0 };
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        CHECK(IdStackPush(&ids, i << 40 | i) == STACK_OK);
+    }
+    CHECK(IdStackSize(&ids) == 1000 && ids.capacity >= 1000);
+    uint64_t out = 0;
+    CHECK(IdStackTryPeek(&ids, &out) == STACK_OK && out == ((uint64_t)999 << 40 | 999));
+    for (uint64_t i = 1000; i-- > 0;)
+    {
+        CHECK(IdStackTryPop(&ids, &out) == STACK_OK && out == (i << 40 | i));
+    }
+    CHECK(IdStackTryPop(&ids, &out) == STACK_EMPTY && IdStackTop(&ids) == NULL && IdStackIsEmpty(&ids));
+    IdStackFree(&ids);
+    IdStackFree(&ids); // Freeing twice leaves it empty both times
+}
+
+static void testReals(void)
+{
+    RealStack reals;
+    CHECK(RealStackInit(&reals, 0) == STACK_OK && reals.array == NULL);
+    double items[50], out[60];
+    for (int i = 0; i < 50; i++)
+    {
+        items[i] = i * 0.5;
+    }
+    CHECK(RealStackPushN(&reals, items, 0) == STACK_OK && reals.array == NULL);
+    CHECK(RealStackPushN(&reals, items, 50) == STACK_OK && RealStackSize(&reals) == 50);
+    RealStackReverse(&reals);
+    CHECK(*RealStackTop(&reals) == 0.0);
+    CHECK(RealStackPopN(&reals, out, 60) == 50);
+    for (int i = 0; i < 50; i++)
+    {
+        CHECK(out[i] == items[i]);
+    }
+    CHECK(RealStackPopN(&reals, out, 1) == 0);
+    RealStackFree(&reals);
+}
+
+static void testPoints(void)
+{
+    PointStack points;
+    CHECK(PointStackInit(&points, 2) == STACK_OK && points.capacity == 2);
+    for (int32_t i = 0; i < 100; i++)
+    {
+        CHECK(PointStackPush(&points, (Point){ i / 4.0, i, -i }) == STACK_OK);
+    }
+    PointStackTop(&points)->z = 1234; // Elements are stored by value and can be updated in place
+    Point p = PointStackPopUnchecked(&points);
+    CHECK(p.x == 99 / 4.0 && p.y == 99 && p.z == 1234);
+    CHECK(PointStackReserve(&points, 500) == STACK_OK && points.capacity == 500);
+    CHECK(PointStackTryPeek(&points, &p) == STACK_OK && p.y == 98 && p.z == -98);
+    PointStackFree(&points);
+}
+
+static void testPointers(void)
+{
+    // Qualifiers must bind to the element, not to what it points to
+    NameStack names = { 0 };
+    char a[] = "a", b[] = "b", c[] = "c";
+    char *items[] = { a, b, c }, *out[3];
+    CHECK(NameStackPushN(&names, items, 3) == STACK_OK);
+    CHECK(NameStackPopN(&names, out, 3) == 3 && out[0] == items[2] && out[2] == items[0]);
+    NameStackFree(&names);
+}
+
+static void testOverflow(void)
+{
+    IdStack ids = { 0 };
+    CHECK(IdStackPush(&ids, 1) == STACK_OK);
+    uint64_t item = 0;
+
+    // Sizes that would wrap size_t are refused before any arithmetic or allocation
+    volatile size_t huge = SIZE_MAX; // Opaque to the compiler, which would flag the memcpy bound
+    CHECK(IdStackPushN(&ids, &item, huge) == STACK_NO_MEMORY);
+    CHECK(IdStackGrow(&ids, SIZE_MAX) == STACK_NO_MEMORY);
+    CHECK(IdStackReserve(&ids, SIZE_MAX / sizeof(uint64_t) + 1) == STACK_NO_MEMORY);
+    CHECK(IdStackSize(&ids) == 1 && IdStackTryPeek(&ids, &item) == STACK_OK && item == 1);
+
+    // So is doubling a capacity already past half the address space
+    size_t capacity = ids.capacity;
+    ids.capacity = SIZE_MAX / 2 / sizeof(uint64_t) + 1;
+    CHECK(IdStackGrow(&ids, 1) == STACK_NO_MEMORY);
+    ids.capacity = capacity;
+
+    IdStack unallocated;
+    CHECK(IdStackInit(&unallocated, SIZE_MAX / 4) == STACK_NO_MEMORY && unallocated.array == NULL);
+    IdStackFree(&ids);
+}
+
+int main(void)
+{
+    testIds();
+    testReals();
+    testPoints();
+    testPointers();
+    testOverflow();
+    return testResult("test_generic");
+}
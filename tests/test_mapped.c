@@ -0,0 +1,130 @@
+/**
+ * @file test_mapped.c
+ *
+ * @brief A mapped stack keeps its contents across close and reopen, grows its file,
+ *        and stays usable when growing fails.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "stack_mapped.h"
+#include "test_util.h"
+
+#define PATH "test_mapped.stack" /**< Created in the test's working directory */
+
+static void testReopen(void)
+{
+    unlink(PATH);
+    MappedStack stack;
+    CHECK(openMappedStack(&stack, PATH, 4, MAPPED_SYNC_ON_CLOSE) == STACK_OK);
+    CHECK(mappedSize(&stack) == 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        CHECK(mappedPush(&stack, i) == STACK_OK); // Grows the file well past 4
+    }
+    int out = -1;
+    CHECK(mappedTryPop(&stack, &out) == STACK_OK && out == 999);
+    CHECK(closeMappedStack(&stack) == STACK_OK);
+
+    // The capacity argument only applies to a new file
+    CHECK(openMappedStack(&stack, PATH, 1, MAPPED_SYNC_EVERY_OP) == STACK_OK);
+    CHECK(mappedSize(&stack) == 999);
+    CHECK(mappedTryPeek(&stack, &out) == STACK_OK && out == 998);
+    for (int i = 998; i >= 0; i--)
+    {
+        CHECK(mappedTryPop(&stack, &out) == STACK_OK && out == i);
+    }
+    out = 42;
+    CHECK(mappedTryPop(&stack, &out) == STACK_EMPTY && out == 42);
+    CHECK(closeMappedStack(&stack) == STACK_OK);
+
+    CHECK(openMappedStack(&stack, PATH, 1, MAPPED_SYNC_NONE) == STACK_OK);
+    CHECK(mappedSize(&stack) == 0);
+    CHECK(closeMappedStack(&stack) == STACK_OK);
+    unlink(PATH);
+}
+
+/**
+ * @brief Fills a stack to its capacity, then pushes with no address space left to map into.
+ * @details Runs in a child process, since the address-space limit cannot be raised
+ *          again; the exit status is the number of failed checks.
+ */
+static int pushWithoutAddressSpace(void)
+{
+    MappedStack stack;
+    if (openMappedStack(&stack, PATH, 1024, MAPPED_SYNC_ON_CLOSE) != STACK_OK)
+    {
+        return 1;
+    }
+    for (int i = 0; i < 1024; i++)
+    {
+        CHECK(mappedPush(&stack, i) == STACK_OK);
+    }
+    struct rlimit limit = { 0, RLIM_INFINITY };
+    getrlimit(RLIMIT_AS, &limit);
+    limit.rlim_cur = 0; // Every new mapping now fails
+    CHECK(setrlimit(RLIMIT_AS, &limit) == 0);
+
+    int out = -1;
+    CHECK(mappedPush(&stack, 1024) == STACK_NO_MEMORY);
+    CHECK(mappedPush(&stack, 1024) == STACK_NO_MEMORY); // Still mapped, still full
+    CHECK(mappedSize(&stack) == 1024);
+    CHECK(mappedTryPeek(&stack, &out) == STACK_OK && out == 1023);
+    CHECK(mappedTryPop(&stack, &out) == STACK_OK && out == 1023);
+    CHECK(mappedPush(&stack, -1) == STACK_OK); // A free slot needs no new mapping
+    CHECK(closeMappedStack(&stack) == STACK_OK);
+    CHECK(closeMappedStack(&stack) == STACK_OK); // A second close does nothing
+    return testFailures;
+}
+
+static void testFailedGrow(void)
+{
+    unlink(PATH);
+    fflush(stderr);
+    pid_t child = fork();
+    CHECK(child >= 0);
+    if (child == 0)
+    {
+        _exit(pushWithoutAddressSpace());
+    }
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // What the child left in the file is intact
+    MappedStack stack;
+    int out = 0;
+    CHECK(openMappedStack(&stack, PATH, 1, MAPPED_SYNC_NONE) == STACK_OK);
+    CHECK(mappedSize(&stack) == 1024);
+    CHECK(mappedTryPop(&stack, &out) == STACK_OK && out == -1);
+    CHECK(mappedTryPop(&stack, &out) == STACK_OK && out == 1022);
+    CHECK(closeMappedStack(&stack) == STACK_OK);
+    unlink(PATH);
+}
+
+static void testRejectsForeignFile(void)
+{
+    int fd = open(PATH, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    CHECK(fd >= 0);
+    const char junk[64] = "not a stack file";
+    CHECK(write(fd, junk, sizeof(junk)) == (ssize_t)sizeof(junk));
+    close(fd);
+
+    MappedStack stack;
+    CHECK(openMappedStack(&stack, PATH, 4, MAPPED_SYNC_NONE) == STACK_IO_ERROR);
+    CHECK(closeMappedStack(&stack) == STACK_OK); // Nothing to close after a failed open
+    unlink(PATH);
+}
+
+int main(void)
+{
+    testReopen();
+    testFailedGrow();
+    testRejectsForeignFile();
+    return testResult("test_mapped");
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test_pool.c
+ *
+ * @brief List nodes freed on another thread than the one that allocated them, and pools
+ *        outliving their thread until their nodes are freed.
+ */
+
+#include <pthread.h>
+
+#include "stack.h"
+#include "test_util.h"
+
+#define ITEMS 100000 /**< Nodes handed from thread to thread; tens of slabs */
+#define ROUNDS 8     /**< Producer and consumer pairs in the stress run */
+
+static Node *shared;                                           /**< The list passed between threads */
+static pthread_mutex_t sharedLock = PTHREAD_MUTEX_INITIALIZER; /**< Protects `shared` */
+
+/**
+ * @brief Pushes ITEMS nodes from the thread's own pool onto `shared`, then exits with them still live.
+ */
+static void *produce(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < ITEMS; i++)
+    {
+        pthread_mutex_lock(&sharedLock);
+        CHECK(listPush(&shared, i) == STACK_OK);
+        pthread_mutex_unlock(&sharedLock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Takes the nodes on `shared` in batches and frees them outside the lock, ITEMS in all.
+ * @details The producer keeps allocating from the same slabs meanwhile.
+ */
+static void *consume(void *arg)
+{
+    (void)arg;
+    for (int popped = 0; popped < ITEMS;)
+    {
+        pthread_mutex_lock(&sharedLock);
+        Node *batch = shared;
+        shared = NULL;
+        pthread_mutex_unlock(&sharedLock);
+        while (batch != NULL)
+        {
+            listPopUnchecked(&batch);
+            popped++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Cycles the thread's pool and reports how many slabs a trim gives back.
+ */
+static void *recycle(void *arg)
+{
+    size_t *released = arg;
+    CHECK(threadNodePool()->slabs != NULL); // Adopted, not created
+    Node *top = NULL;
+    for (int i = 0; i < ITEMS; i++)
+    {
+        CHECK(listPush(&top, i) == STACK_OK);
+    }
+    while (top != NULL)
+    {
+        listPopUnchecked(&top);
+    }
+    *released = trimNodePool(threadNodePool());
+    return NULL;
+}
+
+static void testPoolOutlivesThread(void)
+{
+    CHECK(threadNodePool() != NULL); // Give this thread its own pool before any is left to adopt
+
+    // The producer exits while every one of its nodes is still on the list
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, produce, NULL) == 0);
+    pthread_join(thread, NULL);
+    CHECK(listSize(shared) == ITEMS);
+
+    // Popping here hands the nodes back to the exited thread's pool; the bottom one stays live
+    for (int i = ITEMS - 1; i >= 1; i--)
+    {
+        CHECK(listPop(&shared) == i);
+    }
+
+    // So the next thread takes that pool over, reuses its nodes, then releases every other slab
+    size_t released = 0;
+    CHECK(pthread_create(&thread, NULL, recycle, &released) == 0);
+    pthread_join(thread, NULL);
+    CHECK(released >= (size_t)ITEMS * sizeof(Node) / 65536);
+    CHECK(listPop(&shared) == 0);
+    CHECK(shared == NULL);
+}
+
+/**
+ * @brief Reports whether the thread started without adopting a pool.
+ */
+static void *startFresh(void *arg)
+{
+    int *fresh = arg;
+    *fresh = threadNodePool()->slabs == NULL;
+    return NULL;
+}
+
+static void testOrphanReclaimed(void)
+{
+    // The last node of the previous test was freed after its thread exited, so its pool is released, not adopted
+    int fresh = 0;
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, startFresh, &fresh) == 0);
+    pthread_join(thread, NULL);
+    CHECK(fresh);
+}
+
+static void testConcurrentHandOff(void)
+{
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        pthread_t producer, consumer;
+        CHECK(pthread_create(&producer, NULL, produce, NULL) == 0);
+        CHECK(pthread_create(&consumer, NULL, consume, NULL) == 0);
+        pthread_join(producer, NULL);
+        pthread_join(consumer, NULL);
+        CHECK(shared == NULL);
+    }
+}
+
+int main(void)
+{
+    testPoolOutlivesThread();
+    testOrphanReclaimed();
+    testConcurrentHandOff();
+    return testResult("test_pool");
+}
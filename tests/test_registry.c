@@ -0,0 +1,136 @@
+/**
+ * @file test_registry.c
+ *
+ * @brief Registry handles go stale when their stack is destroyed, names stay unique, and
+ *        list and unrolled registries own their stacks like array ones.
+ */
+
+#include "stack_registry.h"
+#include "test_util.h"
+
+static void testStaleHandles(void)
+{
+    StackRegistry registry;
+    CHECK(initRegistry(&registry, 2) == STACK_OK);
+    StackHandle a, b;
+    CHECK(registryCreate(&registry, NULL, 4, 2.0, &a) == STACK_OK);
+    CHECK(registryCreate(&registry, NULL, 4, 2.0, &b) == STACK_OK);
+    CHECK(a != b && a != STACK_HANDLE_NONE && b != STACK_HANDLE_NONE);
+    CHECK(push(registryGet(&registry, a), 1) == STACK_OK);
+
+    CHECK(registryDestroy(&registry, a) == 1);
+    CHECK(registryGet(&registry, a) == NULL);
+    CHECK(registryDestroy(&registry, a) == 0);
+    CHECK(registryGet(&registry, STACK_HANDLE_NONE) == NULL);
+    CHECK(registryCount(&registry) == 1);
+
+    // The freed slot is reused under a new generation; the old handle stays stale
+    StackHandle c;
+    CHECK(registryCreate(&registry, NULL, 4, 2.0, &c) == STACK_OK);
+    CHECK(c != a && registryGet(&registry, a) == NULL);
+    CHECK(registryGet(&registry, c) != NULL && isEmpty(registryGet(&registry, c)));
+
+    // Growing past the initial slots keeps every handle valid
+    StackHandle handles[100];
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(registryCreate(&registry, NULL, 1, 2.0, &handles[i]) == STACK_OK);
+        CHECK(push(registryGet(&registry, handles[i]), i) == STACK_OK);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        struct Stack *stack = registryGet(&registry, handles[i]);
+        CHECK(stack != NULL && peek(stack) == i);
+    }
+    CHECK(registryCount(&registry) == 102);
+    destroyRegistry(&registry);
+}
+
+static void testNames(void)
+{
+    StackRegistry registry;
+    CHECK(initRegistry(&registry, 1) == STACK_OK);
+    StackHandle ops, undo, dup = STACK_HANDLE_NONE;
+    CHECK(registryCreate(&registry, "operands", 8, 2.0, &ops) == STACK_OK);
+    CHECK(registryCreate(&registry, "undo", 8, 2.0, &undo) == STACK_OK);
+    CHECK(registryCreate(&registry, "undo", 8, 2.0, &dup) == STACK_EXISTS);
+    CHECK(registryCount(&registry) == 2);
+
+    CHECK(registryFind(&registry, "operands") == ops);
+    CHECK(registryFind(&registry, "undo") == undo);
+    CHECK(registryFind(&registry, "redo") == STACK_HANDLE_NONE);
+
+    // A destroyed stack frees its name
+    CHECK(registryDestroy(&registry, undo) == 1);
+    CHECK(registryFind(&registry, "undo") == STACK_HANDLE_NONE);
+    CHECK(registryCreate(&registry, "undo", 8, 2.0, &dup) == STACK_OK);
+    CHECK(registryFind(&registry, "undo") == dup && dup != undo);
+    destroyRegistry(&registry);
+}
+
+static void testListStacks(void)
+{
+    StackRegistry registry;
+    CHECK(initRegistryOf(&registry, STACK_BACKEND_LIST, 1) == STACK_OK);
+    StackHandle handles[50];
+    for (int i = 0; i < 50; i++)
+    {
+        CHECK(registryCreate(&registry, NULL, 0, 0, &handles[i]) == STACK_OK);
+        Node **top = registryGetList(&registry, handles[i]);
+        CHECK(top != NULL && listIsEmpty(*top));
+        for (int j = 0; j <= i; j++)
+        {
+            CHECK(listPush(registryGetList(&registry, handles[i]), j) == STACK_OK);
+        }
+    }
+    for (int i = 0; i < 50; i++)
+    {
+        Node **top = registryGetList(&registry, handles[i]);
+        CHECK(top != NULL && listSize(*top) == (size_t)i + 1 && listPeek(*top) == i);
+    }
+
+    // Other backends' accessors refuse the handles
+    CHECK(registryGet(&registry, handles[0]) == NULL);
+    CHECK(registryGetUnrolled(&registry, handles[0]) == NULL);
+
+    // Destroying a stack frees its nodes; the slot comes back empty
+    CHECK(registryDestroy(&registry, handles[49]) == 1);
+    CHECK(registryGetList(&registry, handles[49]) == NULL);
+    StackHandle reused;
+    CHECK(registryCreate(&registry, "reused", 0, 0, &reused) == STACK_OK);
+    CHECK(listIsEmpty(*registryGetList(&registry, reused)));
+    destroyRegistry(&registry);
+    CHECK(trimNodePool(threadNodePool()) > 0); // Every node went back to the pool
+}
+
+static void testUnrolledStacks(void)
+{
+    StackRegistry registry;
+    CHECK(initRegistryOf(&registry, STACK_BACKEND_UNROLLED, 0) == STACK_OK);
+    StackHandle a, b;
+    CHECK(registryCreate(&registry, "a", 0, 0, &a) == STACK_OK);
+    CHECK(registryCreate(&registry, "b", 0, 0, &b) == STACK_OK);
+    for (int i = 0; i < 3 * (int)BLOCK_ITEMS; i++)
+    {
+        CHECK(unrolledPush(registryGetUnrolled(&registry, a), i) == STACK_OK);
+    }
+    CHECK(unrolledPush(registryGetUnrolled(&registry, b), -1) == STACK_OK);
+    CHECK(unrolledSize(registryGetUnrolled(&registry, a)) == 3 * BLOCK_ITEMS);
+    CHECK(unrolledPeek(registryGetUnrolled(&registry, b)) == -1);
+    CHECK(registryGet(&registry, a) == NULL && registryGetList(&registry, a) == NULL);
+
+    CHECK(registryDestroy(&registry, a) == 1);
+    CHECK(registryFind(&registry, "a") == STACK_HANDLE_NONE);
+    CHECK(registryGetUnrolled(&registry, a) == NULL);
+    CHECK(registryCount(&registry) == 1);
+    destroyRegistry(&registry);
+}
+
+int main(void)
+{
+    testStaleHandles();
+    testNames();
+    testListStacks();
+    testUnrolledStacks();
+    return testResult("test_registry");
+}
@@ -0,0 +1,158 @@
+/**
+ * @file test_serial.c
+ *
+ * @brief Snapshot round trips, and the rejection of corrupt, truncated and forged snapshots.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stack_serial.h"
+#include "test_util.h"
+
+#define ITEMS 10000 /**< More than two blocks */
+
+/**
+ * @brief Fills a stack with values that exercise both small and large deltas.
+ */
+static void fill(struct Stack *stack)
+{
+    for (int i = 0; i < ITEMS; i++)
+    {
+        push(stack, i % 7 == 0 ? (int)(i * 2654435761u) : i - 5000);
+    }
+}
+
+/**
+ * @brief Returns 1 if two array stacks hold the same elements in the same order.
+ */
+static int sameStack(struct Stack *a, struct Stack *b)
+{
+    return stackSize(a) == stackSize(b) && memcmp(a->array, b->array, stackSize(a) * sizeof(int)) == 0;
+}
+
+static void testRoundTrip(void)
+{
+    struct Stack stack, copy;
+    initStack(&stack, 16, 2.0, 0);
+    initStack(&copy, 1, 2.0, 0);
+    fill(&stack);
+
+    for (int encoding = SERIAL_RAW; encoding <= SERIAL_DELTA_VARINT; encoding++)
+    {
+        unsigned char *data = NULL;
+        size_t length = 0;
+        CHECK(serializeStack(&stack, (SerialEncoding)encoding, &data, &length) == STACK_OK);
+        CHECK(deserializeStack(&copy, data, length) == STACK_OK);
+        CHECK(sameStack(&stack, &copy));
+        free(data);
+    }
+
+    // Through a file descriptor, and an empty stack
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    struct Stack empty;
+    initStack(&empty, 1, 2.0, 0);
+    CHECK(saveStack(&empty, fds[1], SERIAL_DELTA_VARINT) == STACK_OK);
+    close(fds[1]);
+    CHECK(loadStack(&copy, fds[0]) == STACK_OK && stackSize(&copy) == 0);
+    close(fds[0]);
+
+    destroyStack(&empty);
+    destroyStack(&copy);
+    destroyStack(&stack);
+}
+
+static void testListRoundTrip(void)
+{
+    Node *top = NULL, *copy = NULL;
+    for (int i = 0; i < ITEMS; i++)
+    {
+        listPush(&top, i * 3);
+    }
+    unsigned char *data = NULL;
+    size_t length = 0;
+    CHECK(listSerialize(top, SERIAL_DELTA_VARINT, &data, &length) == STACK_OK);
+    CHECK(listDeserialize(&copy, data, length) == STACK_OK);
+    int ok = 1;
+    for (Node *a = top, *b = copy; a != NULL || b != NULL; a = a->link, b = b->link)
+    {
+        if (a == NULL || b == NULL || a->data != b->data)
+        {
+            ok = 0;
+            break;
+        }
+    }
+    CHECK(ok);
+    free(data);
+    while (top != NULL)
+    {
+        listPopUnchecked(&top);
+    }
+    while (copy != NULL)
+    {
+        listPopUnchecked(&copy);
+    }
+}
+
+static void testCorruptAndTruncated(void)
+{
+    struct Stack stack, copy;
+    initStack(&stack, 16, 2.0, 0);
+    initStack(&copy, 1, 2.0, 0);
+    fill(&stack);
+    unsigned char *data = NULL;
+    size_t length = 0;
+    CHECK(serializeStack(&stack, SERIAL_DELTA_VARINT, &data, &length) == STACK_OK);
+
+    // Every truncation is rejected and leaves the stack empty
+    size_t cuts[] = { 0, 3, 16, 20, length / 2, length - 1 };
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++)
+    {
+        CHECK(deserializeStack(&copy, data, cuts[i]) == STACK_CORRUPT);
+        CHECK(stackSize(&copy) == 0);
+    }
+
+    // A flipped payload bit fails the block checksum
+    data[length - 10] ^= 0x04;
+    CHECK(deserializeStack(&copy, data, length) == STACK_CORRUPT && stackSize(&copy) == 0);
+    data[length - 10] ^= 0x04;
+
+    // So does a bad magic number
+    data[0] ^= 0xFF;
+    CHECK(deserializeStack(&copy, data, length) == STACK_CORRUPT);
+    data[0] ^= 0xFF;
+    CHECK(deserializeStack(&copy, data, length) == STACK_OK && sameStack(&stack, &copy));
+
+    free(data);
+    destroyStack(&copy);
+    destroyStack(&stack);
+}
+
+static void testForgedCount(void)
+{
+    // A bare header claiming 0x7fffffff elements must not reserve them up front
+    unsigned char header[16] = { 0x53, 0x54, 0x4B, 0x42, 1, 0, 1, 0, 0xFF, 0xFF, 0xFF, 0x7F, 0, 0, 0, 0 };
+    struct Stack stack;
+    initStack(&stack, 1, 2.0, 0);
+    CHECK(deserializeStack(&stack, header, sizeof(header)) == STACK_CORRUPT);
+    CHECK(stack.capacity == 1);
+
+    // A count the array stack cannot address is corrupt, not out of memory
+    header[11] = 0xFF;
+    header[12] = 1;
+    CHECK(deserializeStack(&stack, header, sizeof(header)) == STACK_CORRUPT);
+    destroyStack(&stack);
+}
+
+int main(void)
+{
+    testRoundTrip();
+    testListRoundTrip();
+    testCorruptAndTruncated();
+    testForgedCount();
+    return testResult("test_serial");
+}
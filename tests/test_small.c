@@ -0,0 +1,98 @@
+/**
+ * @file test_small.c
+ *
+ * @brief DEFINE_SMALL_STACK across the spill from inline storage to the heap and back down.
+ */
+
+#include "stack_small.h"
+#include "test_util.h"
+
+/**
+ * @struct pair
+ * @brief A struct element, to check elements are copied whole when spilling.
+ */
+typedef struct pair
+{
+    int key;   /**< First field */
+    int value; /**< Second field */
+} Pair;
+
+DEFINE_SMALL_STACK(PairStack, Pair, 4)
+
+static void testSpillAndPopBack(void)
+{
+    PairStack stack = { 0 };
+    CHECK(PairStackCapacity(&stack) == 4 && PairStackData(&stack) == stack.items);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(PairStackPush(&stack, (Pair){ i, -i }) == STACK_OK);
+    }
+    CHECK(stack.heap == NULL); // Full but still inline
+
+    for (int i = 4; i < 100; i++)
+    {
+        CHECK(PairStackPush(&stack, (Pair){ i, -i }) == STACK_OK);
+    }
+    CHECK(stack.heap != NULL && PairStackData(&stack) == stack.heap);
+    CHECK(PairStackSize(&stack) == 100 && PairStackCapacity(&stack) >= 100);
+
+    // Popping back below N reads the spilled copies of the first elements
+    Pair out = { 0, 0 };
+    for (int i = 99; i >= 2; i--)
+    {
+        CHECK(PairStackTryPop(&stack, &out) == STACK_OK && out.key == i && out.value == -i);
+    }
+    CHECK(PairStackTryPeek(&stack, &out) == STACK_OK && out.key == 1);
+    CHECK(PairStackPush(&stack, (Pair){ 7, 7 }) == STACK_OK && PairStackPopUnchecked(&stack).key == 7);
+    CHECK(PairStackPopUnchecked(&stack).key == 1 && PairStackPopUnchecked(&stack).key == 0);
+    CHECK(PairStackIsEmpty(&stack) && PairStackTryPop(&stack, &out) == STACK_EMPTY);
+
+    // Free returns the stack to its inline slots, ready for reuse
+    PairStackFree(&stack);
+    CHECK(stack.heap == NULL && PairStackCapacity(&stack) == 4 && PairStackSize(&stack) == 0);
+    CHECK(PairStackPush(&stack, (Pair){ 5, 5 }) == STACK_OK && stack.heap == NULL);
+    PairStackFree(&stack);
+}
+
+/**
+ * @brief Returns a stack by value, so it is moved to a new address while inline.
+ */
+static SmallStack makeInline(int n)
+{
+    SmallStack stack = { 0 };
+    for (int i = 0; i < n; i++)
+    {
+        SmallStackPush(&stack, i * 11);
+    }
+    return stack;
+}
+
+static void testMoveWhileInline(void)
+{
+    SmallStack moved = makeInline(SMALL_STACK_INLINE_ITEMS);
+    CHECK(moved.heap == NULL && SmallStackSize(&moved) == SMALL_STACK_INLINE_ITEMS);
+    CHECK(SmallStackData(&moved) == moved.items); // Refers to its own slots, not the old frame's
+
+    SmallStack copy = moved;
+    copy.items[0] = -1; // The copy owns separate inline slots
+    CHECK(moved.items[0] == 0 && SmallStackData(&copy) == copy.items);
+
+    // Spilling the moved stack starts from its own inline elements
+    CHECK(SmallStackPush(&moved, 1000) == STACK_OK && moved.heap != NULL);
+    int out;
+    CHECK(SmallStackTryPop(&moved, &out) == STACK_OK && out == 1000);
+    for (int i = SMALL_STACK_INLINE_ITEMS - 1; i >= 0; i--)
+    {
+        CHECK(SmallStackTryPop(&moved, &out) == STACK_OK && out == i * 11);
+    }
+    SmallStackFree(&moved);
+    SmallStackFree(&copy); // Never spilled: frees nothing
+    CHECK(copy.heap == NULL && SmallStackIsEmpty(&copy));
+}
+
+int main(void)
+{
+    testSpillAndPopBack();
+    testMoveWhileInline();
+    return testResult("test_small");
+}
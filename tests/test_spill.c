@@ -0,0 +1,105 @@
+/**
+ * @file test_spill.c
+ *
+ * @brief The spill stack against an in-memory reference, and its report of a failed write.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "stack_spill.h"
+#include "test_util.h"
+
+#define PATH "test_spill.scratch"        /**< Created in the test's working directory, unlinked at once */
+#define MAX_ITEMS (40 * SPILL_PAGE_ITEMS) /**< Deepest stack: many times the resident frames */
+#define PHASES 40                         /**< Alternating runs biased toward pushing or popping */
+
+/**
+ * @brief Random pushes and pops in runs that climb and fall across many pages.
+ */
+static void testAgainstReference(void)
+{
+    SpillStack stack;
+    CHECK(openSpillStack(&stack, PATH, 0) == STACK_OK); // SPILL_MIN_FRAMES frames
+    int *reference = malloc(MAX_ITEMS * sizeof(int));
+    uint64_t size = 0;
+    int failed = 0;
+    srand(1);
+    for (int phase = 0; phase < PHASES && !failed; phase++)
+    {
+        int pushBias = phase % 2 ? 30 : 70;
+        int length = rand() % (MAX_ITEMS / 4);
+        for (int i = 0; i < length && !failed; i++)
+        {
+            int out;
+            if (rand() % 100 < pushBias && size < MAX_ITEMS)
+            {
+                reference[size] = rand();
+                failed |= spillPush(&stack, reference[size++]) != STACK_OK;
+            }
+            else if (size == 0)
+            {
+                failed |= spillTryPop(&stack, &out) != STACK_EMPTY;
+            }
+            else
+            {
+                failed |= spillTryPop(&stack, &out) != STACK_OK || out != reference[--size];
+            }
+            failed |= spillSize(&stack) != size;
+        }
+    }
+    CHECK(!failed);
+
+    // Fill to the deepest point, then drain with a peek before every pop
+    while (size < MAX_ITEMS && !failed)
+    {
+        reference[size] = (int)size;
+        failed |= spillPush(&stack, reference[size++]) != STACK_OK;
+    }
+    while (size > 0 && !failed)
+    {
+        int top, out;
+        failed |= spillTryPeek(&stack, &top) != STACK_OK || top != reference[size - 1];
+        failed |= spillTryPop(&stack, &out) != STACK_OK || out != top;
+        size--;
+    }
+    CHECK(!failed);
+    int out = 42;
+    CHECK(spillTryPop(&stack, &out) == STACK_EMPTY && spillTryPeek(&stack, &out) == STACK_EMPTY && out == 42);
+    closeSpillStack(&stack);
+    free(reference);
+}
+
+/**
+ * @brief A write the file system refuses surfaces as STACK_IO_ERROR from a later push.
+ * @details Caps the file size of the whole process, so it runs last.
+ */
+static void testWriteFailure(void)
+{
+    signal(SIGXFSZ, SIG_IGN); // Fail the write with EFBIG instead of killing the process
+    struct rlimit limit = { 1 << 20, 1 << 20 };
+    CHECK(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+
+    SpillStack stack;
+    CHECK(openSpillStack(&stack, PATH, SPILL_MIN_FRAMES) == STACK_OK);
+    StackStatus status = STACK_OK;
+    uint64_t pushes = 0;
+    while (status == STACK_OK && pushes < 4 * MAX_ITEMS)
+    {
+        status = spillPush(&stack, 1);
+        pushes++;
+    }
+    CHECK(status == STACK_IO_ERROR);
+    CHECK(pushes * sizeof(int) > (1 << 20)); // Not before the file reached the limit
+    closeSpillStack(&stack);
+}
+
+int main(void)
+{
+    testAgainstReference();
+    testWriteFailure();
+    return testResult("test_spill");
+}
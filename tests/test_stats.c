@@ -0,0 +1,151 @@
+/**
+ * @file test_stats.c
+ *
+ * @brief Operation and event counters of an array stack, their exact totals under
+ *        more threads than shards, and their JSON export.
+ *
+ * Built against a copy of the library compiled with STACK_STATS.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stack_stats.h"
+#include "test_util.h"
+
+#define THREADS (2 * STATS_SHARDS + 3) /**< Enough that several threads share each shard */
+#define THREAD_OPS 1000000             /**< Pushes, and as many pops, per thread */
+#define THREAD_DEPTH 64                /**< Items pushed before a thread pops them all */
+
+static StackStats sharedStats;
+static pthread_barrier_t start;
+
+static void testCounters(void)
+{
+    static StackStats stats;
+    initStackStats(&stats);
+    struct Stack growable, fixed;
+    CHECK(initStack(&growable, 4, 2.0, 1) == STACK_OK);
+    CHECK(initStack(&fixed, 2, 1.0, 0) == STACK_OK);
+    growable.stats = fixed.stats = &stats;
+
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(push(&growable, i) == STACK_OK);
+    }
+    CHECK(peek(&growable) == 99);
+    for (int i = 0; i < 100; i++)
+    {
+        popUnchecked(&growable);
+    }
+    int out;
+    CHECK(tryPop(&growable, &out) == STACK_EMPTY);
+    CHECK(push(&fixed, 1) == STACK_OK && push(&fixed, 2) == STACK_OK && push(&fixed, 3) == STACK_FULL);
+
+    StatsSnapshot snapshot;
+    takeStatsSnapshot(&stats, &snapshot);
+    CHECK(snapshot.ops[STATS_PUSH] == 102);
+    CHECK(snapshot.ops[STATS_POP] == 100);
+    CHECK(snapshot.ops[STATS_PEEK] == 1);
+    CHECK(snapshot.events[STATS_FULL] == 1);
+    CHECK(snapshot.events[STATS_UNDERFLOW] == 1);
+    CHECK(snapshot.events[STATS_NO_MEMORY] == 0);
+    CHECK(snapshot.events[STATS_GROW] == 5); // 4 -> 8 -> 16 -> 32 -> 64 -> 128
+    CHECK(snapshot.events[STATS_SHRINK] > 0);
+    CHECK(snapshot.maxDepth == 100);
+
+    // Resetting clears everything
+    initStackStats(&stats);
+    takeStatsSnapshot(&stats, &snapshot);
+    CHECK(snapshot.ops[STATS_PUSH] == 0 && snapshot.maxDepth == 0);
+    destroyStack(&fixed);
+    destroyStack(&growable);
+}
+
+/**
+ * @brief Pushes and pops THREAD_OPS items, THREAD_DEPTH at a time, on a stack of its
+ *        own recording into sharedStats.
+ */
+static void *pushPop(void *arg)
+{
+    (void)arg;
+    struct Stack stack;
+    CHECK(initStack(&stack, 16, 2.0, 0) == STACK_OK);
+    stack.stats = &sharedStats;
+    pthread_barrier_wait(&start); // Run all at once, so threads sharing a shard overlap
+    for (int round = 0; round < THREAD_OPS / THREAD_DEPTH; round++)
+    {
+        for (int i = 0; i < THREAD_DEPTH; i++)
+        {
+            push(&stack, i);
+        }
+        for (int i = 0; i < THREAD_DEPTH; i++)
+        {
+            popUnchecked(&stack);
+        }
+    }
+    destroyStack(&stack);
+    return NULL;
+}
+
+static void testManyThreads(void)
+{
+    initStackStats(&sharedStats);
+    CHECK(pthread_barrier_init(&start, NULL, THREADS) == 0);
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++)
+    {
+        CHECK(pthread_create(&threads[t], NULL, pushPop, NULL) == 0);
+    }
+    for (int t = 0; t < THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&start);
+
+    StatsSnapshot snapshot;
+    takeStatsSnapshot(&sharedStats, &snapshot);
+    uint64_t expected = (uint64_t)THREADS * (THREAD_OPS / THREAD_DEPTH * THREAD_DEPTH);
+    CHECK(snapshot.ops[STATS_PUSH] == expected);
+    CHECK(snapshot.ops[STATS_POP] == expected);
+    CHECK(snapshot.maxDepth == THREAD_DEPTH);
+}
+
+static void testExport(void)
+{
+    StatsSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.ops[STATS_PUSH] = 12;
+    snapshot.ops[STATS_POP] = 7;
+    snapshot.ops[STATS_PEEK] = 3;
+    snapshot.events[STATS_UNDERFLOW] = 2;
+    snapshot.events[STATS_GROW] = 4;
+    snapshot.maxDepth = 9;
+
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    CHECK(exportStats(&snapshot, fds[1]) == STACK_OK);
+    close(fds[1]);
+    char line[4096];
+    ssize_t length = read(fds[0], line, sizeof(line) - 1);
+    close(fds[0]);
+    CHECK(length > 0);
+    line[length > 0 ? length : 0] = '\0';
+
+    const char *expected = "{\"ops\":{\"push\":12,\"pop\":7,\"peek\":3},"
+                           "\"events\":{\"full\":0,\"underflow\":2,\"no_memory\":0,\"grow\":4,\"shrink\":0},"
+                           "\"max_depth\":9,\"latency_ns\":{\"push\":";
+    CHECK((size_t)length > strlen(expected) && memcmp(line, expected, strlen(expected)) == 0);
+    CHECK(length > 0 && line[length - 1] == '\n' && strchr(line, '\n') == line + length - 1);
+}
+
+int main(void)
+{
+    testCounters();
+    testManyThreads();
+    testExport();
+    return testResult("test_stats");
+}
@@ -0,0 +1,49 @@
+/**
+ * @file test_util.h
+ *
+ * @brief The few macros the tests share.
+ *
+ * A failed CHECK prints its location and condition and the test carries on, so
+ * one run reports every failure; testResult() turns the count into the exit
+ * status ctest looks at.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+/**
+ * @brief Number of failed checks so far in this test program.
+ */
+static int testFailures;
+
+/**
+ * @def CHECK
+ * @brief Reports `cond` as a failure if it is false.
+ */
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                        \
+        }                                                                          \
+    } while (0)
+
+/**
+ * @brief Prints the outcome of a test program and returns its exit status.
+ * @param name The name of the test program.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+static inline int testResult(const char *name)
+{
+    if (testFailures)
+    {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif /* TEST_UTIL_H */